@@ -0,0 +1,286 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2021 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:AnalysisScheduler.cpp
+
+		Implementation of AnalysisScheduler.h
+
+*************************************************************************************/
+
+#include "AnalysisScheduler.h"
+#include <cpl/Common.h>
+#include <deque>
+#include <thread>
+
+namespace Signalizer
+{
+	/// <summary>
+	/// Above the message and rendering threads, but below the audio threads of the host.
+	/// </summary>
+	constexpr int WorkerPriority = 8;
+
+	class AnalysisScheduler::Worker : public juce::Thread
+	{
+	public:
+
+		Worker(AnalysisScheduler& scheduler, std::size_t index)
+			: juce::Thread("Signalizer analysis " + juce::String(static_cast<int>(index)))
+			, scheduler(scheduler)
+			, index(index)
+		{
+		}
+
+		void run() override
+		{
+			scheduler.workerLoop(index);
+		}
+
+		std::mutex queueMutex;
+		std::deque<Job*> queue;
+
+	private:
+
+		AnalysisScheduler& scheduler;
+		const std::size_t index;
+	};
+
+	static std::mutex poolMutex;
+	static std::weak_ptr<AnalysisScheduler> pool;
+	static std::atomic<AnalysisScheduler*> current { nullptr };
+
+	std::shared_ptr<AnalysisScheduler> AnalysisScheduler::acquire()
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		auto shared = pool.lock();
+
+		if (!shared)
+		{
+			shared.reset(new AnalysisScheduler());
+			pool = shared;
+			current.store(shared.get(), std::memory_order_release);
+		}
+
+		return shared;
+	}
+
+	AnalysisScheduler& AnalysisScheduler::instance() noexcept
+	{
+		if (auto pool = current.load(std::memory_order_acquire))
+			return *pool;
+
+		CPL_RUNTIME_ASSERTION(false && "Analysis scheduled while nothing holds the pool");
+
+		// without workers, jobs just run on the calling thread
+		static AnalysisScheduler serial(1);
+		return serial;
+	}
+
+	AnalysisScheduler::AnalysisScheduler()
+		: AnalysisScheduler(std::max(1u, std::thread::hardware_concurrency()))
+	{
+	}
+
+	AnalysisScheduler::AnalysisScheduler(std::size_t cores)
+	{
+		maxConcurrency = cores;
+
+		// the calling threads are the last core
+		for (std::size_t i = 0; i + 1 < cores; ++i)
+			workers.emplace_back(std::make_unique<Worker>(*this, i));
+
+		for (auto& w : workers)
+			w->startThread(WorkerPriority);
+	}
+
+	AnalysisScheduler::~AnalysisScheduler()
+	{
+		quit.store(true, std::memory_order_release);
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+
+		wakeUp.notify_all();
+
+		for (auto& w : workers)
+			w->stopThread(-1);
+
+		// a new pool may have been acquired in the meantime
+		auto self = this;
+		current.compare_exchange_strong(self, nullptr);
+	}
+
+	void AnalysisScheduler::setMaxConcurrency(std::size_t threads) noexcept
+	{
+		maxConcurrency.store(std::clamp<std::size_t>(threads, 1, getHardwareConcurrency()), std::memory_order_relaxed);
+
+		// workers that became active may have queued work
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+
+		wakeUp.notify_all();
+	}
+
+	std::size_t AnalysisScheduler::activeWorkers() const noexcept
+	{
+		return std::min(workers.size(), getMaxConcurrency() - 1);
+	}
+
+	bool AnalysisScheduler::run(Job& job)
+	{
+		if (job.count == 0)
+			return true;
+
+		const auto chunks = (job.count + job.grain - 1) / job.grain;
+		const auto active = activeWorkers();
+		const auto helpers = std::min(chunks - 1, active);
+
+		if (helpers > 0)
+		{
+			queued.fetch_add(helpers, std::memory_order_relaxed);
+
+			// spread over the queues, idle workers steal the rest
+			for (std::size_t h = 0; h < helpers; ++h)
+			{
+				auto& worker = *workers[nextQueue.fetch_add(1, std::memory_order_relaxed) % active];
+				std::lock_guard<std::mutex> lock(worker.queueMutex);
+				worker.queue.push_back(&job);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+			}
+
+			wakeUp.notify_all();
+		}
+
+		work(job);
+
+		if (helpers > 0)
+		{
+			// whatever wasn't taken yet is retracted, after this only the workers that took the job can touch it
+			for (auto& w : workers)
+			{
+				std::lock_guard<std::mutex> lock(w->queueMutex);
+				const auto before = w->queue.size();
+				w->queue.erase(std::remove(w->queue.begin(), w->queue.end(), &job), w->queue.end());
+				queued.fetch_sub(before - w->queue.size(), std::memory_order_relaxed);
+			}
+
+			// they can only be finishing their last indices
+			while (job.helpers.load(std::memory_order_acquire) != 0)
+				std::this_thread::yield();
+		}
+
+		return !job.wasDropped.load(std::memory_order_relaxed);
+	}
+
+	void AnalysisScheduler::work(Job& job)
+	{
+		const bool hasDeadline = job.deadline != Clock::time_point::max();
+
+		for (;;)
+		{
+			const auto start = job.next.fetch_add(job.grain, std::memory_order_relaxed);
+
+			if (start >= job.count)
+				return;
+
+			if (hasDeadline && Clock::now() > job.deadline)
+			{
+				// too late: nothing more is started
+				job.wasDropped.store(true, std::memory_order_relaxed);
+				job.next.store(job.count, std::memory_order_relaxed);
+				return;
+			}
+
+			const auto end = std::min(job.count, start + job.grain);
+
+			for (auto i = start; i < end; ++i)
+				job.invoke(job.function, i);
+		}
+	}
+
+	AnalysisScheduler::Job* AnalysisScheduler::take(std::size_t index)
+	{
+		auto pop = [this](Worker& w, bool newest) -> Job*
+		{
+			std::lock_guard<std::mutex> lock(w.queueMutex);
+
+			if (w.queue.empty())
+				return nullptr;
+
+			Job* job = newest ? w.queue.back() : w.queue.front();
+
+			if (newest)
+				w.queue.pop_back();
+			else
+				w.queue.pop_front();
+
+			// under the lock, so the caller either retracts the entry or waits for this worker
+			job->helpers.fetch_add(1, std::memory_order_relaxed);
+			queued.fetch_sub(1, std::memory_order_relaxed);
+
+			return job;
+		};
+
+		// the newest job of its own queue is the most likely to be in cache
+		if (auto job = pop(*workers[index], true))
+			return job;
+
+		// steal the oldest job of another worker, including inactive ones
+		for (std::size_t i = 1; i < workers.size(); ++i)
+		{
+			if (auto job = pop(*workers[(index + i) % workers.size()], false))
+				return job;
+		}
+
+		return nullptr;
+	}
+
+	void AnalysisScheduler::workerLoop(std::size_t index)
+	{
+		while (!quit.load(std::memory_order_acquire))
+		{
+			if (index < activeWorkers())
+			{
+				if (auto job = take(index))
+				{
+					work(*job);
+					// the last access, the caller may return from here on
+					job->helpers.fetch_sub(1, std::memory_order_release);
+					continue;
+				}
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+
+			wakeUp.wait(
+				lock,
+				[&] { return quit.load(std::memory_order_acquire) || (queued.load(std::memory_order_relaxed) > 0 && index < activeWorkers()); }
+			);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2021 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:AnalysisScheduler.h
+
+		A pool of analysis workers shared by every instance in the process.
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_ANALYSISSCHEDULER_H
+	#define SIGNALIZER_ANALYSISSCHEDULER_H
+
+	#include <algorithm>
+	#include <atomic>
+	#include <chrono>
+	#include <condition_variable>
+	#include <cstddef>
+	#include <memory>
+	#include <mutex>
+	#include <type_traits>
+	#include <vector>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Runs parallel analysis on a fixed pool of elevated priority workers, shared by every instance in the process,
+		/// so any amount of instances never use more cores than <see cref="getMaxConcurrency"/>.
+		/// Every worker has its own queue of jobs, and steals from the others once it runs dry.
+		/// The calling thread always takes part in its own job, so a job completes even if every worker is busy elsewhere.
+		/// </summary>
+		class AnalysisScheduler
+		{
+		public:
+
+			typedef std::chrono::steady_clock Clock;
+
+			/// <summary>
+			/// Keeps the pool alive, held by every instance. The workers are stopped once nothing holds it anymore.
+			/// </summary>
+			static std::shared_ptr<AnalysisScheduler> acquire();
+			/// <summary>
+			/// The pool, which is only valid while anything holds on to <see cref="acquire"/>.
+			/// If nothing does, jobs run serially on the calling thread.
+			/// </summary>
+			static AnalysisScheduler& instance() noexcept;
+
+			~AnalysisScheduler();
+
+			/// <summary>
+			/// Calls function(i) for every i in [0, count), on the calling thread and any idle workers, and returns once every
+			/// call returned. Indices are claimed grain at a time.
+			/// Indices that weren't claimed before the deadline are dropped, in which case false is returned.
+			/// </summary>
+			template<typename Function>
+			bool parallel_for(std::size_t count, Function&& function, std::size_t grain = 1, Clock::time_point deadline = Clock::time_point::max())
+			{
+				if (count == 0)
+					return true;
+
+				Job job;
+				job.invoke = [](void* f, std::size_t index) { (*static_cast<std::remove_reference_t<Function>*>(f))(index); };
+				job.function = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+				job.count = count;
+				job.grain = std::max<std::size_t>(1, grain);
+				job.deadline = deadline;
+
+				return run(job);
+			}
+
+			/// <summary>
+			/// The amount of threads analysing at once in the process, including one calling thread. Safe from any thread.
+			/// </summary>
+			void setMaxConcurrency(std::size_t threads) noexcept;
+			std::size_t getMaxConcurrency() const noexcept { return maxConcurrency.load(std::memory_order_relaxed); }
+			/// <summary>
+			/// The highest concurrency that can be set, one thread per core.
+			/// </summary>
+			std::size_t getHardwareConcurrency() const noexcept { return workers.size() + 1; }
+
+		private:
+
+			struct Job
+			{
+				void (*invoke)(void* function, std::size_t index);
+				void* function;
+				std::size_t count, grain;
+				Clock::time_point deadline;
+				/// <summary>
+				/// The next index to be claimed.
+				/// </summary>
+				std::atomic<std::size_t> next { 0 };
+				/// <summary>
+				/// Workers that took the job out of a queue, and can still be claiming indices.
+				/// </summary>
+				std::atomic<int> helpers { 0 };
+				std::atomic<bool> wasDropped { false };
+			};
+
+			class Worker;
+
+			AnalysisScheduler();
+			/// <summary>
+			/// One worker less than the cores, the calling threads are the last one.
+			/// </summary>
+			explicit AnalysisScheduler(std::size_t cores);
+
+			bool run(Job& job);
+			static void work(Job& job);
+			void workerLoop(std::size_t index);
+			Job* take(std::size_t index);
+			std::size_t activeWorkers() const noexcept;
+
+			std::vector<std::unique_ptr<Worker>> workers;
+			std::atomic<std::size_t> maxConcurrency;
+			/// <summary>
+			/// Entries in every queue, workers sleep while there are none.
+			/// </summary>
+			std::atomic<std::size_t> queued { 0 };
+			std::atomic<std::size_t> nextQueue { 0 };
+			std::atomic<bool> quit { false };
+			std::mutex sleepMutex;
+			std::condition_variable wakeUp;
+		};
+	}
+
+#endif
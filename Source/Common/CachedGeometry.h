@@ -0,0 +1,178 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:CachedGeometry.h
+
+		Geometry retained on the GPU across frames, rebuilt only when its inputs change
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_CACHEDGEOMETRY_H
+	#define SIGNALIZER_CACHEDGEOMETRY_H
+
+	#include "StreamedGeometry.h"
+	#include <initializer_list>
+	#include <vector>
+	#include <algorithm>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Remembers the inputs something was computed from, to tell when it is out of date.
+		/// </summary>
+		class CacheKey
+		{
+		public:
+
+			/// <summary>
+			/// Returns true if the values differ from the last ones, or the key was invalidated.
+			/// </summary>
+			bool update(std::initializer_list<double> values)
+			{
+				if (isValid && std::equal(values.begin(), values.end(), key.begin(), key.end()))
+					return false;
+
+				key.assign(values);
+				isValid = true;
+				return true;
+			}
+
+			void invalidate() noexcept { isValid = false; }
+
+		private:
+
+			std::vector<double> key;
+			bool isValid = false;
+		};
+
+		/// <summary>
+		/// Static geometry like grids and wireframes, kept in a buffer object and drawn with a single call.
+		/// The key should hold everything the geometry is built from, that isn't applied as a transform at draw time,
+		/// like the view size and colours. Anything that is hard to key (divisions of an axis f.ex.) can invalidate() it instead.
+		/// Must only be used on the OpenGL thread. Call release() before the context goes away.
+		/// </summary>
+		class CachedGeometry
+		{
+		public:
+
+			/// <summary>
+			/// Returns an empty batch to build the geometry into, if the key changed. Otherwise returns null,
+			/// and the last geometry is drawn again.
+			/// </summary>
+			StreamedGeometry::Batch * rebuild(GLint components, std::initializer_list<double> values)
+			{
+				if (!key.update(values))
+					return nullptr;
+
+				batch.reset(components);
+				isUploaded = false;
+				return &batch;
+			}
+
+			void invalidate() noexcept { key.invalidate(); }
+
+			void draw(GLenum primitive)
+			{
+				auto& gl = juce::OpenGLContext::getCurrentContext()->extensions;
+
+				if (!isUploaded)
+				{
+					upload(gl);
+				}
+
+				if (vertices == 0)
+					return;
+
+				gl.glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glVertexPointer(components, GL_FLOAT, 0, nullptr);
+
+				if (colourOffset)
+				{
+					glEnableClientState(GL_COLOR_ARRAY);
+					glColorPointer(4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<const GLvoid*>(colourOffset));
+				}
+
+				glDrawArrays(primitive, 0, static_cast<GLsizei>(vertices));
+
+				if (colourOffset)
+					glDisableClientState(GL_COLOR_ARRAY);
+
+				glDisableClientState(GL_VERTEX_ARRAY);
+				gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+			}
+
+			/// <summary>
+			/// Deletes the buffer object. The OpenGL context must be current.
+			/// </summary>
+			void release()
+			{
+				if (buffer)
+				{
+					if (auto context = juce::OpenGLContext::getCurrentContext())
+						context->extensions.glDeleteBuffers(1, &buffer);
+				}
+
+				buffer = 0;
+				isUploaded = false;
+				key.invalidate();
+			}
+
+		private:
+
+			void upload(juce::OpenGLExtensionFunctions& gl)
+			{
+				if (!buffer)
+					gl.glGenBuffers(1, &buffer);
+
+				vertices = batch.size();
+				components = batch.components;
+
+				const auto positionBytes = static_cast<GLsizeiptr>(batch.positionData.size() * sizeof(GLfloat));
+				const auto colourBytes = static_cast<GLsizeiptr>(batch.hasColours ? batch.colourData.size() : 0);
+
+				gl.glBindBuffer(GL_ARRAY_BUFFER, buffer);
+				gl.glBufferData(GL_ARRAY_BUFFER, positionBytes + colourBytes, nullptr, GL_STATIC_DRAW);
+				gl.glBufferSubData(GL_ARRAY_BUFFER, 0, positionBytes, batch.positionData.data());
+
+				if (colourBytes)
+					gl.glBufferSubData(GL_ARRAY_BUFFER, positionBytes, colourBytes, batch.colourData.data());
+
+				gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				colourOffset = colourBytes ? positionBytes : 0;
+				isUploaded = true;
+			}
+
+			CacheKey key;
+			StreamedGeometry::Batch batch;
+			GLuint buffer = 0;
+			GLint components = 3;
+			GLsizeiptr colourOffset = 0;
+			std::size_t vertices = 0;
+			bool isUploaded = false;
+		};
+	};
+
+#endif
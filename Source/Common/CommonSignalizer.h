@@ -36,13 +36,18 @@
 	#include "SignalizerConfiguration.h"
 	#include <cpl/lib/weak_atomic.h>
 	#include "ConcurrentConfig.h"
+	#include "QualityGovernor.h"
 	#include <mutex>
+	#include <atomic>
 	#include <cpl/AudioStream.h>
 	#include <cpl/gui/CViews.h>
 	#include <chrono>
 	#include <variant>
 	#include <cpl/Exceptions.h>
 	#include <functional>
+	#include <cpl/simd.h>
+	#include <limits>
+	#include <array>
 
 	namespace cpl
 	{
@@ -84,6 +89,52 @@
 			Lanczos
 		};
 
+		/// <summary>
+		/// A counter that listeners can compare against, to see whether something changed since they last looked.
+		/// </summary>
+		template<typename Counter>
+		struct BasicChangeVersion
+		{
+			struct Listener
+			{
+			public:
+				bool consumeChanges(const BasicChangeVersion& v)
+				{
+					const int current = v.version;
+
+					CPL_RUNTIME_ASSERTION(version <= current);
+
+					if (current > version)
+					{
+						version = current;
+						return true;
+					}
+
+					return false;
+				}
+
+			private:
+				int version {};
+			};
+
+			void bump() 
+			{
+				version++;
+			}
+
+		private:
+			Counter version{};
+		};
+
+		/// <summary>
+		/// Not atomic.
+		/// </summary>
+		typedef BasicChangeVersion<int> ChangeVersion;
+		/// <summary>
+		/// Can be bumped from another thread than the listener, f.ex. the audio thread.
+		/// </summary>
+		typedef BasicChangeVersion<std::atomic<int>> ConcurrentChangeVersion;
+
 		class StateEditor;
 		class SystemView;
 		class SharedBehaviour;
@@ -131,6 +182,31 @@
 
 		class GraphicsWindow : public cpl::COpenGLView
 		{
+		public:
+
+			/// <summary>
+			/// Whether the next frame can look different from the one on the screen. Once a view presented its retained frame
+			/// and nothing changed since, frames don't need to be requested at all: presenting the retained frame still
+			/// copies the whole view. Only call from the message thread.
+			/// </summary>
+			bool isFrameDue() noexcept
+			{
+				bool isDue = frameRequested.exchange(false) || !isFrameSettled.load();
+
+				if (activityVersion)
+					isDue |= activityChanged.consumeChanges(*activityVersion);
+
+				// the retained frame has the old size
+				if (getWidth() != dueWidth || getHeight() != dueHeight)
+				{
+					dueWidth = getWidth();
+					dueHeight = getHeight();
+					isDue = true;
+				}
+
+				return isDue;
+			}
+
 		protected:
 
 			GraphicsWindow(std::string name) 
@@ -163,34 +239,66 @@
 			cpl::CBoxFilter<float, 64> avgDelta;
 			cpl::CBoxFilter<float, 64> avgFrame;
 
+			/// <summary>
+			/// Set when something outside of the audio changed what the next frame should look like.
+			/// Consumed by the views when they decide whether to render or present the last frame again.
+			/// </summary>
+			cpl::ABoolFlag frameChanged;
+
+			/// <summary>
+			/// Lowers the rendering quality when frames are over budget. Views apply the level when rendering.
+			/// </summary>
+			QualityGovernor governor;
+
+			/// <summary>
+			/// Makes the next frame render, instead of presenting the last one again. Can be called from any thread.
+			/// </summary>
+			void invalidateFrame() noexcept
+			{
+				frameChanged = true;
+				frameRequested = true;
+			}
+
+			/// <summary>
+			/// The version of the audio the view displays, see <see cref="isFrameDue"/>.
+			/// </summary>
+			void setFrameActivity(const ConcurrentChangeVersion& version) noexcept
+			{
+				activityVersion = &version;
+			}
 
 			// Mouse overrides
 			void mouseMove(const juce::MouseEvent& event) override
 			{
 				// TODO: implement beginChangeGesture()
 				currentMouse.setFromPoint(event.position);
+				invalidateFrame();
 			}
 
 			void mouseDrag(const juce::MouseEvent& event) override
 			{
 				// TODO: implement beginChangeGesture()
 				currentMouse.setFromPoint(event.position);
+				invalidateFrame();
 			}
 
 			void mouseDown(const juce::MouseEvent& event) override
 			{
 				// TODO: implement endChangeGesture()
 				originMouse.setFromPoint(event.position);
+				invalidateFrame();
 			}
 
 			void mouseExit(const juce::MouseEvent& e)  override
 			{
 				isMouseInside = false;
+				invalidateFrame();
 			}
 
 			void mouseEnter(const juce::MouseEvent& e) override
 			{
 				isMouseInside = true;
+				invalidateFrame();
 			}
 
 			// Graphics overrides
@@ -205,10 +313,20 @@
 				}
 			}
 
-			void postFrame()
+			/// <summary>
+			/// Call at the end of every frame. Frames that weren't rendered (see RetainedFrame) are counted
+			/// in the statistics, but say nothing about the cost of rendering.
+			/// </summary>
+			void postFrame(bool wasRendered = true)
 			{
 				avgDelta.setNext(openGlEndToEndTime());
 				avgFrame.setNext(openGLFrameTime());
+
+				// a rendered frame still has to be retained, and presented once to settle
+				isFrameSettled = !wasRendered;
+
+				if (wasRendered && governor.update(openGLFrameTime(), openGlEndToEndTime()))
+					invalidateFrame();
 			}
 
 			double getAverageFrameTime()
@@ -229,6 +347,13 @@
 				usagePercent = 100 * (frame / delta);
 				fps = 1.0f / delta;
 			}
+
+		private:
+
+			std::atomic<bool> frameRequested { true }, isFrameSettled { false };
+			const ConcurrentChangeVersion* activityVersion = nullptr;
+			ConcurrentChangeVersion::Listener activityChanged;
+			int dueWidth = 0, dueHeight = 0;
 		};
 
 		class SystemView
@@ -953,38 +1078,127 @@
 			bool stereo;
 		};
 
+
 		/// <summary>
-		/// Not atomic.
+		/// Tells whether incoming audio can change what a view displays, so views can skip frames when it can't.
+		/// The version is bumped for every block, until the input has been silent for longer than the capacity of the
+		/// audio history. That is the most any view shows, so every view sharing a stream settles at the same time.
+		/// Silence is tracked per channel, and includes denormals: processors can use it to skip analysis of silent
+		/// channels, and to reset their state once a channel has settled.
+		/// onAudio() and the queries must only be called from the audio thread.
 		/// </summary>
-		struct ChangeVersion
+		class AudioActivity
 		{
-			struct Listener
+		public:
+
+			static constexpr std::size_t MaxChannels = MaxInputChannels;
+			static_assert(MaxChannels <= 64, "Silence of every channel is tracked in a 64-bit mask");
+
+			template<typename ISA>
+			void onAudio(const AudioStream::DataType* const* buffer, std::size_t numChannels, std::size_t numSamples, const AudioStream::AudioStreamInfo& info)
 			{
-			public:
-				bool consumeChanges(const ChangeVersion& v)
+				const auto hold = static_cast<std::size_t>(info.audioHistoryCapacity);
+				numChannels = std::min(numChannels, MaxChannels);
+
+				bool isSilent = true;
+				std::uint64_t mask = 0;
+
+				for (std::size_t c = 0; c < numChannels; ++c)
 				{
-					CPL_RUNTIME_ASSERTION(version <= v.version);
+					const bool channelSilent = peakOf<ISA>(buffer[c], numSamples) < std::numeric_limits<AudioStream::DataType>::min();
 
-					if (v.version > version)
+					if (channelSilent)
 					{
-						version = v.version;
-						return true;
+						mask |= std::uint64_t(1) << c;
+						silentRuns[c] += numSamples;
+					}
+					else
+					{
+						silentRuns[c] = 0;
+						isSilent = false;
 					}
-
-					return false;
 				}
 
-			private:
-				int version {};
-			};
+				silentChannels = mask;
+				channels = numChannels;
+				settleHold = hold;
 
-			void bump() 
+				const auto previouslySilent = silentSamples;
+				silentSamples = isSilent ? silentSamples + numSamples : 0;
+
+				if (!isSilent || previouslySilent < hold)
+					version.bump();
+			}
+
+			/// <summary>
+			/// Whether the channel only contained zeroes or denormals in the last block.
+			/// </summary>
+			bool isSilent(std::size_t channel) const noexcept
 			{
-				version++;
+				return channel < channels && (silentChannels >> channel) & 1;
+			}
+
+			/// <summary>
+			/// Whether every channel was silent in the last block.
+			/// </summary>
+			bool allSilent() const noexcept
+			{
+				return channels > 0 && silentChannels == (channels == MaxChannels ? ~std::uint64_t(0) : (std::uint64_t(1) << channels) - 1);
+			}
+
+			/// <summary>
+			/// Whether the channel has been silent for longer than the hold, so anything derived from it has decayed.
+			/// </summary>
+			bool isSettled(std::size_t channel) const noexcept
+			{
+				return isSilent(channel) && silentRuns[channel] > settleHold;
+			}
+
+			/// <summary>
+			/// Signals a change regardless of the audio, f.ex. when the stream properties changed.
+			/// </summary>
+			void touch()
+			{
+				version.bump();
+			}
+
+			const ConcurrentChangeVersion& getVersion() const noexcept
+			{
+				return version;
 			}
 
 		private:
-			int version{};
+
+			template<typename ISA>
+			static AudioStream::DataType peakOf(const AudioStream::DataType* samples, std::size_t numSamples)
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				constexpr std::size_t lanes = elements_of<V>::value;
+				const V vSign = consts<V>::sign_mask;
+				const auto stop = numSamples - (numSamples & (lanes - 1));
+
+				V vMax = zero<V>();
+				std::size_t n = 0;
+
+				for (; n < stop; n += lanes)
+					vMax = max(vand(loadu<V>(samples + n), vSign), vMax);
+
+				suitable_container<V> lanesMax = vMax;
+				auto peak = *std::max_element(lanesMax.begin(), lanesMax.end());
+
+				for (; n < numSamples; ++n)
+					peak = std::max(peak, std::abs(samples[n]));
+
+				return peak;
+			}
+
+			ConcurrentChangeVersion version;
+			std::uint64_t silentSamples = 0;
+			std::uint64_t silentChannels = 0;
+			std::size_t channels = 0, settleHold = 0;
+			std::array<std::uint64_t, MaxChannels> silentRuns {};
 		};
 
 		struct LegendCache
@@ -997,10 +1211,12 @@
 			void setFont(juce::Font fontToUse)
 			{
 				font = fontToUse;
+				version.bump();
 			}
 
 			void reset(juce::Point<float> positionToUse)
 			{
+				version.bump();
 				position = positionToUse;
 
 				position.y += offset * 3;
@@ -1016,6 +1232,15 @@
 				arrangement.addLineOfText(font, text, position.x, position.y);
 				colours.emplace_back(std::move(item));
 				position.y += offset + font.getHeight();
+				version.bump();
+			}
+
+			/// <summary>
+			/// Changes whenever the legend does, for caching the painted result.
+			/// </summary>
+			const ChangeVersion& getVersion() const noexcept
+			{
+				return version;
 			}
 
 			void addLine(const juce::String& text, juce::Colour colour)
@@ -1078,6 +1303,7 @@
 			juce::Font font;
 			juce::Point<float> position;
 			float startingY;
+			ChangeVersion version;
 		};
 
 		template<typename T, class Mutex = std::mutex>
@@ -0,0 +1,102 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:FramePacer.h
+
+		Measures the interval between presented frames, and limits the frame rate by sleeping
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_FRAMEPACER_H
+	#define SIGNALIZER_FRAMEPACER_H
+
+	#include <cpl/lib/weak_atomic.h>
+	#include <chrono>
+	#include <array>
+	#include <algorithm>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Keeps track of how often frames are actually presented, which is the refresh rate of the display divided
+		/// by the swap interval when synced, or the rate of whatever triggers the repaints otherwise.
+		/// onFrame() must be called from the rendering thread, the interval can be read from anywhere.
+		/// </summary>
+		class FramePacer
+		{
+		public:
+
+			typedef std::chrono::steady_clock Clock;
+
+			/// <summary>
+			/// Call first thing in every frame, which is right after the previous one was swapped.
+			/// Anything that blocks before it would be measured as part of the cadence.
+			/// </summary>
+			void onFrame()
+			{
+				const auto now = Clock::now();
+
+				if (hasLast)
+				{
+					const auto delta = std::chrono::duration<double>(now - last).count();
+
+					// stalls like suspensions and context recreation aren't part of the cadence
+					if (delta > 0 && delta < MaxInterval)
+					{
+						deltas[deltaIndex] = delta;
+						deltaIndex = (deltaIndex + 1) % deltas.size();
+						numDeltas = std::min(numDeltas + 1, deltas.size());
+
+						// the median ignores the odd late or doubled frame
+						auto sorted = deltas;
+						const auto middle = sorted.begin() + numDeltas / 2;
+						std::nth_element(sorted.begin(), middle, sorted.begin() + numDeltas);
+						interval = *middle;
+					}
+				}
+
+				last = now;
+				hasLast = true;
+			}
+
+			/// <summary>
+			/// Seconds between presented frames.
+			/// </summary>
+			double getFrameInterval() const noexcept
+			{
+				return interval;
+			}
+
+		private:
+
+			static constexpr double MaxInterval = 0.5;
+
+			std::array<double, 32> deltas {};
+			std::size_t deltaIndex = 0, numDeltas = 0;
+			Clock::time_point last;
+			bool hasLast = false;
+			cpl::relaxed_atomic<double> interval = 1.0 / 60;
+		};
+	};
+
+#endif
@@ -33,31 +33,115 @@
 
 namespace Signalizer
 {
+	struct HostGraph::Registry
+	{
+		typedef std::unordered_set<HHandle> Nodes;
+
+		/// <summary>
+		/// Every live instance, including aliases.
+		/// </summary>
+		std::set<HHandle> instances;
+		/// <summary>
+		/// The instance currently owning an identity, never an alias.
+		/// </summary>
+		std::unordered_map<SerializedHandle, HHandle, SerializedHandle::Hash> identities;
+		/// <summary>
+		/// The instances with a relation to an identity in their topology.
+		/// </summary>
+		std::unordered_map<SerializedHandle, Nodes, SerializedHandle::Hash> subscribers;
+		/// <summary>
+		/// Instances with a model listener, that display every node and so are told about all changes.
+		/// </summary>
+		Nodes watchers;
+
+		void subscribe(HHandle h, const SerializedHandle& identity)
+		{
+			subscribers[identity].insert(h);
+		}
+
+		void unsubscribe(HHandle h, const SerializedHandle& identity)
+		{
+			if (auto it = subscribers.find(identity); it != subscribers.end())
+			{
+				it->second.erase(h);
+
+				if (it->second.empty())
+					subscribers.erase(it);
+			}
+		}
+
+		/// <summary>
+		/// The instances that need to hear about changes to the node.
+		/// Copied, since the notifications may change the subscriptions.
+		/// </summary>
+		std::vector<HHandle> recipientsOf(HHandle node)
+		{
+			std::vector<HHandle> ret;
+
+			for (auto it = watchers.begin(); it != watchers.end();)
+			{
+				if ((*it)->modelChangedCallback.expired())
+				{
+					it = watchers.erase(it);
+					continue;
+				}
+
+				ret.push_back(*it++);
+			}
+
+			if (node->hasSerializedRepresentation())
+			{
+				if (auto it = subscribers.find(*node->nodeID); it != subscribers.end())
+				{
+					for (auto n : it->second)
+					{
+						if (!watchers.count(n))
+							ret.push_back(n);
+					}
+				}
+			}
+
+			return ret;
+		}
+	};
+
 	std::mutex HostGraph::staticMutex;
-	std::set<HostGraph::HHandle> HostGraph::staticSet;
+	HostGraph::Registry HostGraph::registry;
 	static std::atomic_int globalVersion;
 
 	constexpr const char* kSerializationControlKey = "serialization-control";
 	constexpr const char* kTopologyKey = "topology-data";
+	constexpr const char* kGainsKey = "topology-gains";
 
 	HostGraph::HostGraph(std::shared_ptr<AudioStream::Output> realtimeOutput)
 		: name("unnamed")
 		, realtime(std::move(realtimeOutput))
+		, publisher(std::make_shared<SharedStream::Publisher>())
 	{
+		realtime->addListener(publisher);
 		broadcastCreate(GraphLock(staticMutex));
 	}
 
 
 	HostGraph::~HostGraph()
 	{
+		realtime->removeListener(publisher);
+
 		const GraphLock lock(staticMutex);
 		broadcastDestruct(lock);
 		resurrectNextAlias(lock);
+
+		for (const auto& entry : topology)
+			registry.unsubscribe(this, entry.first);
+
+		registry.watchers.erase(this);
 	}
 
 	void HostGraph::addModelListener(std::weak_ptr<juce::AsyncUpdater> shared)
 	{
+		const GraphLock lock(staticMutex);
 		modelChangedCallback = std::move(shared);
+		registry.watchers.insert(this);
 	}
 
 	void HostGraph::serialize(cpl::CSerializer::Archiver& ar, cpl::Version version)
@@ -94,6 +178,25 @@ namespace Signalizer
 		};
 
 		serializeTopology(ar[kTopologyKey]);
+
+		// separate from the topology, so older versions still read it
+		auto& gains = ar[kGainsKey];
+
+		std::uint32_t counter = 0;
+
+		for (const auto& pairRelation : topology)
+			counter += static_cast<std::uint32_t>(pairRelation.second.gains.size());
+
+		gains << counter;
+
+		for (const auto& pairRelation : topology)
+		{
+			for (const auto& gain : pairRelation.second.gains)
+			{
+				gains << std::make_pair(pairRelation.first, gain.first);
+				gains << gain.second;
+			}
+		}
 	}
 
 	void HostGraph::deserialize(cpl::CSerializer::Builder& builder, cpl::Version version)
@@ -114,7 +217,7 @@ namespace Signalizer
 			// And this is how we conditionally load it now.
 			auto& serializedTopology = builder[kTopologyKey];
 			if (!serializedTopology.isEmpty())
-				deserializeTopology(serializedTopology, version, lock);
+				deserializeTopology(serializedTopology, version, lock, &builder[kGainsKey]);
 		}
 		else
 		{		
@@ -126,7 +229,7 @@ namespace Signalizer
 			broadcastDetailChange(DetailChange::Rename, lock);
 	}
 
-	void HostGraph::deserializeTopology(cpl::CSerializer::Builder& ar, cpl::Version version, const GraphLock& lock)
+	void HostGraph::deserializeTopology(cpl::CSerializer::Builder& ar, cpl::Version version, const GraphLock& lock, cpl::CSerializer::Builder* gains)
 	{
 		hadTopologyDeserialized = true;
 		decltype(nodeID) copyID;
@@ -150,7 +253,24 @@ namespace Signalizer
 		for (uint32_t i = 0; i < count; ++i)
 		{
 			ar >> copy;
-			topology[copy.first].inputs.insert(copy.second);
+			relationFor(copy.first, lock).inputs.insert(copy.second);
+		}
+
+		// gains have to be known before anything is connected
+		if (gains && !gains->isEmpty())
+		{
+			uint32_t gainCount;
+			*gains >> gainCount;
+
+			for (uint32_t i = 0; i < gainCount; ++i)
+			{
+				float gain;
+				*gains >> copy;
+				*gains >> gain;
+
+				if (auto it = topology.find(copy.first); it != topology.end() && it->second.inputs.count(copy.second))
+					it->second.gains[copy.second] = gain;
+			}
 		}
 
 		expectedNodesToResurrect = topology.size();
@@ -159,11 +279,13 @@ namespace Signalizer
 
 		if (count || expectedNodesToResurrect)
 		{
-			for (auto h : staticSet)
+			for (const auto& entry : topology)
 			{
-				if (h->hasSerializedRepresentation())
+				if (auto h = lookupForeign(entry.first, lock))
 					tryRebuildTopology(resolve(h), lock, false);
 			}
+
+			connectRemotes(lock);
 		}
 	}
 
@@ -241,6 +363,7 @@ namespace Signalizer
 
 			front->isAlias = false;
 			std::swap(front->aliases, aliases);
+			registry.identities[*front->nodeID] = front.get();
 			front->broadcastDetailChange(DetailChange::Reidentified, lock);
 		}
 	}
@@ -268,14 +391,16 @@ namespace Signalizer
 			if (it->first != *nodeID)
 				return false;
 
-			if (it->second.inputs.size() != 2)
-				return false;
+			const PinInt channels = getNumChannels();
 
-			if (it->second.inputs.count({ 0, 0 }) == 0)
+			if (it->second.inputs.size() != static_cast<std::size_t>(channels) || !it->second.gains.empty())
 				return false;
 
-			if (it->second.inputs.count({ 1, 1 }) == 0)
-				return false;
+			for (PinInt i = 0; i < channels; ++i)
+			{
+				if (it->second.inputs.count({ i, i }) == 0)
+					return false;
+			}
 		}
 		else
 		{
@@ -293,7 +418,9 @@ namespace Signalizer
 
 		GraphLock lock(staticMutex);
 
-		for (auto n : staticSet)
+		connectRemotes(lock);
+
+		for (auto n : registry.instances)
 		{
 			if (n->isAlias)
 			{
@@ -308,6 +435,7 @@ namespace Signalizer
 				for (const auto& pair : it->second.inputs)
 				{
 					m.connections.emplace_back(pair);
+					m.gains.emplace_back(it->second.gainOf(pair));
 				}
 			}
 
@@ -331,6 +459,39 @@ namespace Signalizer
 			}
 		}
 
+		// nodes published by other processes
+		for (auto& peer : SharedStream::discover())
+		{
+			const SerializedHandle handle(peer.key);
+
+			if (std::any_of(m.nodes.begin(), m.nodes.end(), [&](const auto& n) { return n.node == handle; }))
+				continue;
+
+			const auto offset = m.connections.size();
+
+			if (auto it = topology.find(handle); it != topology.end())
+			{
+				for (const auto& pair : it->second.inputs)
+				{
+					m.connections.emplace_back(pair);
+					m.gains.emplace_back(it->second.gainOf(pair));
+				}
+			}
+
+			m.nodes.emplace_back(
+				Model::NodeView
+				{
+					handle,
+					peer.name,
+					static_cast<int>(offset),
+					static_cast<int>(m.connections.size() - offset),
+					peer.channels,
+					0,
+					false
+				}
+			);
+		}
+
 		// add missing nodes, rare but slow intersection
 		if (m.nodes.size() != topology.size())
 		{
@@ -343,6 +504,7 @@ namespace Signalizer
 					for (const auto& pair : entry.second.inputs)
 					{
 						m.connections.emplace_back(pair);
+						m.gains.emplace_back(entry.second.gainOf(pair));
 					}
 
 					auto peer = entry.second.liveReference;
@@ -391,7 +553,7 @@ namespace Signalizer
 	bool HostGraph::internalConnect(const SerializedHandle& input, DirectedPortPair pair, const GraphLock& lock)
 	{
 		bool known = topology.count(input);
-		auto& relation = topology[input];
+		auto& relation = relationFor(input, lock);
 
 		if (relation.inputs.count(pair) != 0)
 			return false;
@@ -400,12 +562,20 @@ namespace Signalizer
 
 		if (auto h = resolve(input, lock))
 		{
-			submitConnect(h, pair, lock);
+			submitConnect(h, pair, relation.gainOf(pair), lock);
 		}
-		else if (!known)
+		else if (relation.isRemote)
+		{
+			if (mix)
+				mix->connectRemote(input.toKey(), pair, relation.remoteName, relation.gainOf(pair));
+		}
+		else
 		{
 			// (only expect this once)
-			expectedNodesToResurrect++;
+			if (!known)
+				expectedNodesToResurrect++;
+
+			tryConnectRemote(input, relation, SharedStream::discover(), lock);
 		}
 
 		return true;
@@ -443,13 +613,12 @@ namespace Signalizer
 		}
 
 		// if everything was connected, we've now disconnected everything
-		if (wasEverythingConnected || disconnections >= MaxInputChannels / 2)
+		if (wasEverythingConnected || disconnections >= static_cast<std::size_t>(std::max(1, getNumChannels() / 2)))
 			return true;
 
 		// otherwise, let's reconstruct a new set of topology 
 		const auto maxInputs = MaxInputChannels;
-		std::bitset<32> connectedPorts;
-		CPL_RUNTIME_ASSERTION(connectedPorts.size() > MaxInputChannels);
+		std::vector<bool> connectedPorts(maxInputs);
 
 		// compile list of free ports
 		for (const auto& rel : topology)
@@ -460,14 +629,25 @@ namespace Signalizer
 			}
 		}
 			
+		const auto peers = SharedStream::discover();
+
 		for (const auto& h : handles)
 		{
-			auto other = lookupForeign(h, lock);
+			int numChannels = 0;
 
-			if (!other)
-				return false;
+			if (auto other = lookupForeign(h, lock))
+			{
+				numChannels = other->getNumChannels();
+			}
+			else
+			{
+				auto peer = std::find_if(peers.begin(), peers.end(), [&](const auto& p) { return p.key == h.toKey(); });
 
-			auto numChannels = other->getNumChannels();
+				if (peer == peers.end())
+					return false;
+
+				numChannels = peer->channels;
+			}
 
 			// search for an offset where we fit
 			for(std::size_t offset = 0; offset < connectedPorts.size(); offset += 2) // (stereo offsets)
@@ -495,20 +675,67 @@ namespace Signalizer
 		return true;
 	}
 
+	bool HostGraph::setGain(const SerializedHandle& input, DirectedPortPair pair, float gain)
+	{
+		TriggerModelUpdateOnExit exit{ this };
+
+		GraphLock lock(staticMutex);
+
+		auto it = topology.find(input);
+
+		if (it == topology.end() || it->second.inputs.count(pair) == 0)
+			return false;
+
+		auto& relation = it->second;
+
+		if (gain == 1)
+			relation.gains.erase(pair);
+		else
+			relation.gains[pair] = gain;
+
+		if (!mix)
+			return true;
+
+		if (auto h = resolve(input, lock))
+		{
+			mix->setGain(resolve(h)->realtime, pair, gain);
+		}
+		else if (relation.isRemote)
+		{
+			mix->setRemoteGain(input.toKey(), pair, gain);
+		}
+
+		return true;
+	}
+
+	float HostGraph::getGain(const SerializedHandle& input, DirectedPortPair pair)
+	{
+		GraphLock lock(staticMutex);
+
+		auto it = topology.find(input);
+		return it != topology.end() ? it->second.gainOf(pair) : 1.0f;
+	}
+
 	bool HostGraph::internalDisconnect(const SerializedHandle& input, DirectedPortPair pair, const GraphLock& lock)
 	{
 		bool known = topology.count(input);
-		auto& relation = topology[input];
+		auto& relation = relationFor(input, lock);
 
 		if (relation.inputs.count(pair) == 0)
 			return false;
 
 		relation.inputs.erase(pair);
+		relation.gains.erase(pair);
 
 		if (auto h = resolve(input, lock))
 		{
 			submitDisconnect(h, pair, lock);
 		}
+		else if (relation.isRemote)
+		{
+			if (mix)
+				mix->disconnectRemote(input.toKey(), pair);
+		}
 		else if (!known)
 		{
 			expectedNodesToResurrect++;
@@ -523,6 +750,10 @@ namespace Signalizer
 
 		mix = handle.listener;
 
+		// remote connections were made in the previous mix graph
+		for (auto& entry : topology)
+			entry.second.isRemote = false;
+
 		if (!mix)
 			return;
 
@@ -530,11 +761,13 @@ namespace Signalizer
 
 		if (expectedNodesToResurrect)
 		{
-			for (auto h : staticSet)
+			for (const auto& entry : topology)
 			{
-				if(h->hasSerializedRepresentation())
+				if (auto h = lookupForeign(entry.first, lock))
 					tryRebuildTopology(resolve(h), lock, true);
 			}
+
+			connectRemotes(lock);
 		}
 	}
 
@@ -565,8 +798,34 @@ namespace Signalizer
 
 	int HostGraph::getNumChannels() const
 	{
-		return 2; // TODO: Fix
-		//return mix.realtime->getInfo().anticipatedChannels;
+		return numChannels;
+	}
+
+	void HostGraph::setNumChannels(int channels)
+	{
+		if (numChannels == channels)
+			return;
+
+		GraphLock g(staticMutex);
+		TriggerModelUpdateOnExit exit { this };
+
+		const PinInt previous = numChannels;
+		// the default layout follows the channels, anything else was routed by the user and is left alone
+		const bool followsChannels = isDefaultRuntimeLayout && hasSerializedRepresentation() && topology.count(*nodeID);
+
+		numChannels = channels;
+		publishStream(g);
+
+		if (followsChannels)
+		{
+			const auto& ref = serializeReference(this, g);
+
+			for (PinInt i = channels; i < previous; ++i)
+				internalDisconnect(ref, { i, i }, g);
+
+			for (PinInt i = previous; i < channels; ++i)
+				internalConnect(ref, { i, i }, g);
+		}
 	}
 
 	bool HostGraph::hasSerializedRepresentation() const
@@ -574,14 +833,14 @@ namespace Signalizer
 		return !isAlias && nodeID.has_value();
 	}
 
-	void HostGraph::submitConnect(HHandle h, DirectedPortPair pair, const GraphLock&)
+	void HostGraph::submitConnect(HHandle h, DirectedPortPair pair, float gain, const GraphLock&)
 	{
 		if (!mix)
 			return;
 
 		auto& other = *resolve(h);
 
-		mix->connect(other.realtime, pair, other.name);
+		mix->connect(other.realtime, pair, other.name, gain);
 	}
 
 	void HostGraph::submitDisconnect(HHandle h, DirectedPortPair pair, const GraphLock&)
@@ -596,16 +855,73 @@ namespace Signalizer
 		);
 	}
 
-	HostGraph::HHandle HostGraph::lookupForeign(const SerializedHandle& h, const GraphLock&)
+	void HostGraph::connectRemotes(const GraphLock& g)
 	{
-		for (auto g : staticSet)
+		if (!mix || topology.empty())
+			return;
+
+		std::optional<std::vector<SharedStream::Peer>> peers;
+
+		for (auto& entry : topology)
 		{
-			if (g->nodeID.has_value() && *g->nodeID == h && !g->isAlias)
-			{
-				return g;
-			}
+			if (entry.second.isRemote || resolve(entry.first, g))
+				continue;
+
+			if (!peers)
+				peers = SharedStream::discover();
+
+			tryConnectRemote(entry.first, entry.second, *peers, g);
+		}
+	}
+
+	bool HostGraph::tryConnectRemote(const SerializedHandle& h, Relation& relation, const std::vector<SharedStream::Peer>& peers, const GraphLock&)
+	{
+		if (!mix)
+			return false;
+
+		const auto key = h.toKey();
+		auto peer = std::find_if(peers.begin(), peers.end(), [&](const auto& p) { return p.key == key; });
+
+		if (peer == peers.end())
+			return false;
+
+		relation.remoteName = peer->name;
+
+		for (const auto& pair : relation.inputs)
+		{
+			if (!mix->connectRemote(key, pair, peer->name, relation.gainOf(pair)))
+				return false;
 		}
 
+		relation.isRemote = true;
+		return true;
+	}
+
+	void HostGraph::disconnectRemote(const SerializedHandle& h, Relation& relation, const GraphLock&)
+	{
+		if (!relation.isRemote)
+			return;
+
+		if (mix)
+		{
+			for (const auto& pair : relation.inputs)
+				mix->disconnectRemote(h.toKey(), pair);
+		}
+
+		relation.isRemote = false;
+	}
+
+	void HostGraph::publishStream(const GraphLock&)
+	{
+		if (hasSerializedRepresentation())
+			publisher->publish(nodeID->toKey(), name, getNumChannels());
+	}
+
+	HostGraph::HHandle HostGraph::lookupForeign(const SerializedHandle& h, const GraphLock&)
+	{
+		if (auto it = registry.identities.find(h); it != registry.identities.end())
+			return it->second;
+
 		return nullptr;
 	}
 
@@ -633,10 +949,23 @@ namespace Signalizer
 		return lookupForeign(h, g);
 	}
 
+	HostGraph::Relation& HostGraph::relationFor(const SerializedHandle& h, const GraphLock&)
+	{
+		auto [it, inserted] = topology.try_emplace(h);
+
+		if (inserted)
+			registry.subscribe(this, h);
+
+		return it->second;
+	}
+
 	void HostGraph::clearTopology(const GraphLock& g)
 	{
 		for (auto& serialized : topology)
+		{
 			resetInstancedTopologyFor(serialized.first, g, false);
+			registry.unsubscribe(this, serialized.first);
+		}
 
 		topology.clear();
 	}
@@ -652,12 +981,15 @@ namespace Signalizer
 		{
 			CPL_RUNTIME_ASSERTION(expectedNodesToResurrect > 0);
 
+			// the node moved into this process
+			disconnectRemote(it->first, it->second, g);
+
 			it->second.liveReference = other;
 			expectedNodesToResurrect--;
 
 			for (const auto& pair : it->second.inputs)
 			{
-				submitConnect(other, pair, g);
+				submitConnect(other, pair, it->second.gainOf(pair), g);
 			}
 		}
 	}
@@ -666,6 +998,8 @@ namespace Signalizer
 	{
 		if (auto it = topology.find(serialized); it != topology.end())
 		{
+			disconnectRemote(it->first, it->second, g);
+
 			if (it->second.liveReference != nullptr)
 			{
 				// expect to see this node again
@@ -682,8 +1016,11 @@ namespace Signalizer
 				it->second.liveReference = nullptr;
 			}
 
-			if(eraseSerializedInfo)
-				topology.erase(serialized);
+			if (eraseSerializedInfo)
+			{
+				registry.unsubscribe(this, it->first);
+				topology.erase(it);
+			}
 
 			return true;
 		}
@@ -691,15 +1028,23 @@ namespace Signalizer
 		return false;
 	}
 
-	HostGraph::SerializedHandle HostGraph::serializeReference(HHandle h, const GraphLock&)
+	HostGraph::SerializedHandle HostGraph::serializeReference(HHandle h, const GraphLock& lock)
 	{
 		// We should only serialize references to aliases in the edge case where it's ourselves.
 		CPL_RUNTIME_ASSERTION(!h->isAlias || resolve(h) == this);
 
 		if (h->nodeID.has_value())
 			return *h->nodeID;
-		else
-			return h->nodeID.emplace(SerializedHandle::generateUnique());
+
+		h->nodeID.emplace(SerializedHandle::generateUnique());
+
+		if (!h->isAlias)
+		{
+			registry.identities[*h->nodeID] = h;
+			h->publishStream(lock);
+		}
+
+		return *h->nodeID;
 	}
 
 	HostGraph* HostGraph::resolve(HHandle h)
@@ -710,25 +1055,41 @@ namespace Signalizer
 	void HostGraph::broadcastDetailChange(HostGraph::DetailChange change, const GraphLock& g)
 	{
 		version = globalVersion.fetch_add(1);
+		publishStream(g);
 
-		for (auto n : staticSet)
+		for (auto n : registry.recipientsOf(this))
 			n->onDetailChange(this, change, g);
 	}
 
 	void HostGraph::broadcastCreate(const GraphLock& g)
 	{
-		for (auto n : staticSet)
-			n->onNodeCreated(this, g);
+		for (auto n : registry.recipientsOf(this))
+		{
+			if (n != this)
+				n->onNodeCreated(this, g);
+		}
+
+		registry.instances.insert(this);
+
+		if (hasSerializedRepresentation())
+			registry.identities[*nodeID] = this;
 
-		staticSet.insert(this);
+		publishStream(g);
 	}
 
 	void HostGraph::broadcastDestruct(const GraphLock& g)
 	{
-		for (auto n : staticSet)
+		for (auto n : registry.recipientsOf(this))
 			n->onNodeDestroyed(this, g);
 
-		staticSet.erase(this);
+		registry.instances.erase(this);
+		publisher->withdraw();
+
+		if (nodeID.has_value())
+		{
+			if (auto it = registry.identities.find(*nodeID); it != registry.identities.end() && it->second == this)
+				registry.identities.erase(it);
+		}
 	}
 
 	// ----- reactive
@@ -38,12 +38,15 @@
 	#include <shared_mutex>
 	#include <map>
 	#include <set>
+	#include <unordered_map>
+	#include <unordered_set>
 	#include <string>
 	#include <vector>
 	#include <optional>
 	#include "SignalizerConfiguration.h"
 	#include "CommonSignalizer.h"
 	#include "MixGraphListener.h"
+	#include "SharedStreamTransport.h"
 	#include <memory>
 
 	namespace Signalizer
@@ -93,8 +96,33 @@
 					return std::memcmp(a.contents, b.contents, sizeof(contents)) < 0;
 				}
 
+				explicit SerializedHandle(const SharedStream::Key& key)
+					: SerializedHandle(key.data(), key.size())
+				{
+				}
+
 				juce::String toString() { return juce::Uuid(reinterpret_cast<const std::uint8_t*>(contents)).toString(); }
 
+				SharedStream::Key toKey() const noexcept
+				{
+					SharedStream::Key ret;
+					std::memcpy(ret.data(), contents, sizeof(contents));
+					return ret;
+				}
+
+				/// <summary>
+				/// Handles are random UUIDs, so any part of them is a good hash.
+				/// </summary>
+				struct Hash
+				{
+					std::size_t operator()(const SerializedHandle& h) const noexcept
+					{
+						std::size_t ret;
+						std::memcpy(&ret, h.contents, sizeof(ret));
+						return ret;
+					}
+				};
+
 			private:
 
 				SerializedHandle() 
@@ -126,6 +154,10 @@
 
 				std::vector<NodeView> nodes;
 				std::vector<DirectedPortPair> connections;
+				/// <summary>
+				/// The gain of every connection, in the same order.
+				/// </summary>
+				std::vector<float> gains;
 				int hostIndex{};
 				bool isAlias;
 				
@@ -144,10 +176,20 @@
 			void updateModel(Model& m);
 
 			void setName(std::string_view newName);
+			/// <summary>
+			/// The channels of the realtime output, as laid out by the host. Not from the audio thread.
+			/// A default layout is kept routing every channel to itself, other layouts are left as they are.
+			/// </summary>
+			void setNumChannels(int channels);
 
 			bool connect(const SerializedHandle& input, DirectedPortPair pair);
 			bool disconnect(const SerializedHandle& input, DirectedPortPair pair);
 			bool toggleSet(const std::vector<SerializedHandle>& handles);
+			/// <summary>
+			/// The gain an existing connection is mixed with. Connections start at unity gain.
+			/// </summary>
+			bool setGain(const SerializedHandle& input, DirectedPortPair pair, float gain);
+			float getGain(const SerializedHandle& input, DirectedPortPair pair);
 
 			void setMixGraph(MixGraphListener::Handle& handle);
 			void applyDefaultLayoutFromRuntime();
@@ -168,10 +210,31 @@
 			typedef std::lock_guard<std::mutex> GraphLock;
 			typedef HostGraph* HHandle;
 
+			/// <summary>
+			/// Indexes the live instances by identity, and by the identities in their topology,
+			/// so changes to a node are only delivered to the instances that refer to it.
+			/// </summary>
+			struct Registry;
+
 			struct Relation
 			{
 				HHandle liveReference {};
 				std::set<DirectedPortPair> inputs;
+				/// <summary>
+				/// The node lives in another process, and its inputs are connected through shared memory.
+				/// </summary>
+				bool isRemote = false;
+				std::string remoteName;
+				/// <summary>
+				/// Only the inputs that aren't mixed at unity gain.
+				/// </summary>
+				std::map<DirectedPortPair, float> gains;
+
+				float gainOf(DirectedPortPair pair) const
+				{
+					auto it = gains.find(pair);
+					return it != gains.end() ? it->second : 1.0f;
+				}
 			};
 
 			struct TriggerModelUpdateOnExit
@@ -271,14 +334,23 @@
 			bool internalConnect(const SerializedHandle& input, DirectedPortPair pair, const GraphLock& lock);
 			void resurrectNextAlias(const GraphLock& lock);
 			void changeIdentity(const std::optional<SerializedHandle>& potentialIdentity, const GraphLock& lock);
-			void submitConnect(HHandle h, DirectedPortPair pair, const GraphLock&);
+			void submitConnect(HHandle h, DirectedPortPair pair, float gain, const GraphLock&);
 			void submitDisconnect(HHandle h, DirectedPortPair pair, const GraphLock&);
+			/// <summary>
+			/// Connects relations to nodes that aren't in this process, but are published by another one.
+			/// Other processes can't notify this one, so this is polled whenever the topology is rebuilt or viewed.
+			/// </summary>
+			void connectRemotes(const GraphLock&);
+			bool tryConnectRemote(const SerializedHandle& h, Relation& relation, const std::vector<SharedStream::Peer>& peers, const GraphLock&);
+			void disconnectRemote(const SerializedHandle& h, Relation& relation, const GraphLock&);
+			void publishStream(const GraphLock&);
 			bool computeIsDefaultLayout(const TriggerModelUpdateOnExit&) const noexcept;
-			void deserializeTopology(cpl::CSerializer::Builder& ar, cpl::Version version, const GraphLock&);
+			void deserializeTopology(cpl::CSerializer::Builder& ar, cpl::Version version, const GraphLock&, cpl::CSerializer::Builder* gains = nullptr);
 			HHandle resolve(const SerializedHandle& h, const GraphLock&);
 			HHandle lookupPotentiallyForeign(const SerializedHandle& h, const GraphLock&);
 			static HHandle lookupForeign(const SerializedHandle& h, const GraphLock&);
 
+			Relation& relationFor(const SerializedHandle& h, const GraphLock&);
 			void clearTopology(const GraphLock&);
 			void tryRebuildTopology(HostGraph* other, const GraphLock&, bool rebuildPreviouslySeen);
 			// returns true if anything happend
@@ -295,7 +367,7 @@
 			void onNodeDestroyed(HHandle n, const GraphLock&);
 
 			static std::mutex staticMutex;
-			static std::set<HHandle> staticSet;
+			static Registry registry;
 
 			std::optional<SerializedHandle> nodeID;
 			std::string name;
@@ -304,11 +376,13 @@
 			std::weak_ptr<juce::AsyncUpdater> modelChangedCallback;
 			std::shared_ptr<AudioStream::Output> realtime;
 			std::shared_ptr<MixGraphListener> mix;
+			std::shared_ptr<SharedStream::Publisher> publisher;
 			std::vector<std::weak_ptr<HostGraph>> aliases;
 			std::size_t expectedNodesToResurrect = 0;
 			SerializationControl serializationControl;
 
 			int version = 0;
+			cpl::relaxed_atomic<int> numChannels = 2;
 			bool isAlias = false;
 			bool isDefaultRuntimeLayout = false;
 			bool hadTopologyDeserialized = false;
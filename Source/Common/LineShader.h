@@ -0,0 +1,162 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:LineShader.h
+
+		Shader program that widens line segments into quads, and antialiases them analytically
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_LINESHADER_H
+	#define SIGNALIZER_LINESHADER_H
+
+	#include "Signalizer.h"
+	#include <memory>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Draws line segments as quads, that the vertex shader widens in screen space after the usual
+		/// fixed function transforms. The fragment shader fades the edges by the distance to the centre of the line,
+		/// which antialiases them without any multisampling.
+		///
+		/// Every segment is 4 vertices. The vertex position is the start of the segment, and the texture coordinate
+		/// holds the end of the segment in xyz and a corner code in w: 4 * cap + 2 * end + side, where end selects the end
+		/// of the segment and side the edge of the line (see StreamedGeometry). Only ends with a cap are extended
+		/// by half the width; joints of a strip aren't, since the overlap would be drawn twice with additive blending.
+		/// The colour is scaled by the coverage, which suits the additive and premultiplied blending the views use.
+		/// Must only be used on the OpenGL thread. Call release() before the context goes away.
+		/// </summary>
+		class LineShader
+		{
+		public:
+
+			/// <summary>
+			/// Compiles the program the first time. Returns false if that isn't possible, in which case plain lines should be drawn.
+			/// </summary>
+			bool prepare()
+			{
+				if (program)
+					return true;
+
+				if (hasFailed)
+					return false;
+
+				auto context = juce::OpenGLContext::getCurrentContext();
+
+				if (!context || juce::OpenGLShaderProgram::getLanguageVersion() < 1.1)
+				{
+					hasFailed = true;
+					return false;
+				}
+
+				std::unique_ptr<juce::OpenGLShaderProgram> newProgram(new juce::OpenGLShaderProgram(*context));
+
+				if (!newProgram->addVertexShader(vertexShader) || !newProgram->addFragmentShader(fragmentShader) || !newProgram->link())
+				{
+					hasFailed = true;
+					return false;
+				}
+
+				program = std::move(newProgram);
+				viewport.reset(new juce::OpenGLShaderProgram::Uniform(*program, "viewport"));
+				halfWidth.reset(new juce::OpenGLShaderProgram::Uniform(*program, "halfWidth"));
+
+				return true;
+			}
+
+			/// <summary>
+			/// Binds the program, for lines of the width in pixels. prepare() must have succeeded.
+			/// </summary>
+			void use(GLfloat width)
+			{
+				GLint currentViewport[4];
+				glGetIntegerv(GL_VIEWPORT, currentViewport);
+
+				program->use();
+				viewport->set(static_cast<GLfloat>(currentViewport[2]), static_cast<GLfloat>(currentViewport[3]));
+				halfWidth->set(width * 0.5f);
+			}
+
+			void stop()
+			{
+				juce::OpenGLContext::getCurrentContext()->extensions.glUseProgram(0);
+			}
+
+			/// <summary>
+			/// Deletes the program. The OpenGL context must be current.
+			/// </summary>
+			void release()
+			{
+				viewport.reset();
+				halfWidth.reset();
+				program.reset();
+				hasFailed = false;
+			}
+
+		private:
+
+			static constexpr const char* vertexShader =
+				"uniform vec2 viewport;\n"
+				"uniform float halfWidth;\n"
+				"varying float edgeDistance;\n"
+				"void main()\n"
+				"{\n"
+				"	vec4 start = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+				"	vec4 end = gl_ModelViewProjectionMatrix * vec4(gl_MultiTexCoord0.xyz, 1.0);\n"
+				"	float cap = floor(gl_MultiTexCoord0.w * 0.25);\n"
+				"	float corner = gl_MultiTexCoord0.w - 4.0 * cap;\n"
+				"	float isEnd = floor(corner * 0.5);\n"
+				"	float side = (corner - 2.0 * isEnd) * 2.0 - 1.0;\n"
+				// the segment in pixels
+				"	vec2 halfViewport = 0.5 * viewport;\n"
+				"	vec2 direction = (end.xy / end.w - start.xy / start.w) * halfViewport;\n"
+				"	float pixels = length(direction);\n"
+				"	direction = pixels > 0.0001 ? direction / pixels : vec2(1.0, 0.0);\n"
+				"	vec2 normal = vec2(-direction.y, direction.x);\n"
+				// one extra pixel for the falloff, and square caps at the open ends
+				"	float extent = halfWidth + 1.0;\n"
+				"	vec2 offset = normal * (side * extent) + direction * ((2.0 * isEnd - 1.0) * cap * halfWidth);\n"
+				"	vec4 position = isEnd > 0.5 ? end : start;\n"
+				"	position.xy += offset / halfViewport * position.w;\n"
+				"	edgeDistance = side * extent;\n"
+				"	gl_FrontColor = gl_Color;\n"
+				"	gl_Position = position;\n"
+				"}\n";
+
+			static constexpr const char* fragmentShader =
+				"uniform float halfWidth;\n"
+				"varying float edgeDistance;\n"
+				"void main()\n"
+				"{\n"
+				"	float coverage = clamp(halfWidth + 0.5 - abs(edgeDistance), 0.0, 1.0);\n"
+				"	gl_FragColor = gl_Color * coverage;\n"
+				"}\n";
+
+			std::unique_ptr<juce::OpenGLShaderProgram> program;
+			std::unique_ptr<juce::OpenGLShaderProgram::Uniform> viewport, halfWidth;
+			bool hasFailed = false;
+		};
+	};
+
+#endif
@@ -30,6 +30,7 @@
 #include "MixGraphListener.h"
 #include <atomic>
 #include <memory>
+#include <thread>
 #include "../Processor/PluginProcessor.h"
 #include "CommonSignalizer.h"
 
@@ -37,12 +38,70 @@ namespace Signalizer
 {
 	static std::atomic_int mgCounter;
 
+	MixGraphListener::RoutingTable::RoutingTable(std::size_t numSources, std::size_t numRoutes, std::size_t channels, std::size_t latency, bool isPassThrough)
+		: sources(numSources)
+		, routes(numRoutes)
+		, channelNames(channels)
+		, targetLatency(static_cast<std::int64_t>(latency))
+		, capacity(static_cast<std::int64_t>(latency * 4))
+		, isPassThrough(isPassThrough)
+	{
+		matrix.resizeChannels(channels);
+
+		if (isPassThrough)
+			return;
+
+		// the producer can be writing up to half of a ring while it's being read
+		for (auto& r : routes)
+			r.buffer.resize(latency * 8);
+
+		firstMix.resize(channels + 1);
+		mixOrder.resize(numRoutes);
+
+		matrix.softBufferResize(static_cast<std::size_t>(capacity));
+	}
+
+	MixGraphListener::TableReference::TableReference(MixGraphListener& parent) noexcept
+		: parent(parent)
+	{
+		for (;;)
+		{
+			const auto epoch = parent.tableEpoch.load();
+			slot = epoch & 1;
+			parent.tableReaders[slot].fetch_add(1);
+
+			// if the table was replaced in the meantime, the slot might already be considered drained
+			if (parent.tableEpoch.load() == epoch)
+				break;
+
+			parent.tableReaders[slot].fetch_sub(1);
+		}
+
+		table = parent.liveTable.load();
+	}
+
+	MixGraphListener::TableReference::~TableReference()
+	{
+		parent.tableReaders[slot].fetch_sub(1);
+	}
+
+	MixGraphListener::RoutingTable::Source* MixGraphListener::RoutingTable::find(AudioStream::Handle handle) noexcept
+	{
+		for (auto& s : sources)
+		{
+			if (s.handle == handle)
+				return &s;
+		}
+
+		return nullptr;
+	}
+
 	auto MixGraphListener::emplace(std::shared_ptr<AudioStream::Output> stream)
 	{
 		auto its = graph.emplace(
 			std::piecewise_construct,
 			std::forward_as_tuple(stream->getHandle()),
-			std::forward_as_tuple(State::empty())
+			std::forward_as_tuple()
 		);
 		if (its.second)
 		{
@@ -57,7 +116,7 @@ namespace Signalizer
 		return its.first;
 	}
 
-	void MixGraphListener::remove(std::map<AudioStream::Handle, State>::iterator position)
+	void MixGraphListener::remove(std::map<AudioStream::Handle, Node>::iterator position)
 	{
 		CPL_RUNTIME_ASSERTION(position->second.refCount == 0);
 		if (auto sh = position->second.source.lock())
@@ -71,7 +130,10 @@ namespace Signalizer
 
 	void MixGraphListener::close()
 	{
-		cpl::unique_lock<cpl::shared_mutex> graphLayoutAndDataLock(dataMutex);
+		cancelPendingUpdate();
+		stopTimer();
+
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
 
 		// there might be further processing, but from now on we're in a dead state.
 		enabled = false;
@@ -86,13 +148,17 @@ namespace Signalizer
 			sh->removeListener(shared_from_this());
 
 		graph.clear();
+		remotes.clear();
 	}
 
 	void MixGraphListener::assignSelf()
 	{
-		self = &emplace(realtime)->second;
-		// always keep ourselves alive.
-		self->refCount++;
+		{
+			std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+			// always keep ourselves alive.
+			emplace(realtime)->second.refCount++;
+			publishTopology(lock);
+		}
 
 		if(auto sh = weakPresentationOutput.lock())
 			sh->addListener(shared_from_this());
@@ -109,6 +175,8 @@ namespace Signalizer
 			concurrentConfig.bpm = changedSource.getPlayhead().getBPM();
 			concurrentConfig.numChannels = info.channels;
 			concurrentConfig.sampleRate = info.sampleRate;
+			// buffers are sized by the latency, so they're rebuilt off this thread
+			triggerAsyncUpdate();
 		}
 		else if (changedSource.getHandle() == presentationOutput)
 		{
@@ -121,6 +189,43 @@ namespace Signalizer
 	{
 	}
 
+	void MixGraphListener::handleAsyncUpdate()
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		if (enabled)
+			publishTopology(lock);
+	}
+
+	void MixGraphListener::timerCallback()
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		if (remotes.empty())
+		{
+			stopTimer();
+			return;
+		}
+
+		bool changed = false;
+
+		for (auto& r : remotes)
+		{
+			auto& stream = r.second.stream;
+
+			if (stream && stream->refresh())
+				continue;
+
+			// the old subscription is closed with the last table referring to it
+			auto reopened = SharedStream::Subscriber::open(r.first);
+			changed |= reopened || stream;
+			stream = std::move(reopened);
+		}
+
+		if (changed && enabled)
+			publishTopology(lock);
+	}
+
 	MixGraphListener::MixGraphListener(AudioProcessor& p, AudioStream::IO&& presentation)
 		: realtime(p.getRealtimeOutput())
 		, presentationInput(std::move(std::get<0>(presentation)))
@@ -128,7 +233,11 @@ namespace Signalizer
 		, presentationOutput(std::get<1>(presentation)->getHandle())
 		, structuralChange(false)
 		, enabled(true)
-		, self(nullptr)
+		, maximumLatency(0)
+		, currentLatency(0)
+		, targetLatency(0)
+		, underruns(0)
+		, realignments(0)
 		, concurrentConfig(*p.config)
 		, id(mgCounter.fetch_add(1))
 	{
@@ -165,21 +274,127 @@ namespace Signalizer
 		return { Handle(mixGraph), presentationOutput };
 	}
 
-	void MixGraphListener::connect(std::shared_ptr<AudioStream::Output>& other, DirectedPortPair pair, const std::string& name)
+	void MixGraphListener::connect(std::shared_ptr<AudioStream::Output>& other, DirectedPortPair pair, const std::string& name, float gain)
 	{
 		// mix graph listener can't be destroyed while this is happening.
 		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
-		auto portName = name + "[" + std::to_string(pair.Source) + "]";
 
-		connectionCommands.emplace_back(ConnectionCommand{ other, std::move(portName), pair, true});
+		CPL_RUNTIME_ASSERTION(other.get() != nullptr);
+
+		auto it = graph.find(other->getHandle());
+
+		if (it == graph.end())
+		{
+			// TODO: This assertion has fired in the wild. See added NONTERMINAL_ASSUMPTION below.
+			CPL_RUNTIME_ASSERTION(other.get() != realtime.get());
+			it = emplace(other);
+		}
+
+		auto& source = it->second;
+		source.refCount++;
+		source.channels[pair] = { name + "[" + std::to_string(pair.Source) + "]", std::make_shared<Gain>(gain) };
+
+		publishTopology(lock);
 	}
 
 	void MixGraphListener::disconnect(std::shared_ptr<AudioStream::Output>& other, DirectedPortPair pair)
 	{
 		// mix graph listener can't be destroyed while this is happening.
 		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
 		// it's fine source itself is already dead, we only operate on local copies.
-		connectionCommands.emplace_back(ConnectionCommand{ other, {}, pair, false });
+		auto it = graph.find(other->getHandle());
+
+		if (it == graph.end())
+			return;
+
+		auto& source = it->second;
+		source.channels.erase(pair);
+
+		if (--source.refCount == 0 && NONTERMINAL_ASSUMPTION(other.get() != realtime.get()))
+			remove(it);
+
+		publishTopology(lock);
+	}
+
+	bool MixGraphListener::connectRemote(const SharedStream::Key& key, DirectedPortPair pair, const std::string& name, float gain)
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		auto& source = remotes[key];
+
+		if (!source.stream)
+			source.stream = SharedStream::Subscriber::open(key);
+
+		// the publisher creates the segment once it sees the lease, the timer picks it up
+		if (!source.stream && !SharedStream::isPublished(key))
+		{
+			if (source.channels.empty())
+				remotes.erase(key);
+
+			return false;
+		}
+
+		source.channels[pair] = { name + "[" + std::to_string(pair.Source) + "]", std::make_shared<Gain>(gain) };
+
+		if (!isTimerRunning())
+			startTimer(SharedStream::MaintenanceInterval);
+
+		publishTopology(lock);
+		return true;
+	}
+
+	void MixGraphListener::disconnectRemote(const SharedStream::Key& key, DirectedPortPair pair)
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		auto it = remotes.find(key);
+
+		if (it == remotes.end())
+			return;
+
+		it->second.channels.erase(pair);
+
+		// the subscription is closed with the last table referring to it
+		if (it->second.channels.empty())
+			remotes.erase(it);
+
+		if (remotes.empty())
+			stopTimer();
+
+		publishTopology(lock);
+	}
+
+	void MixGraphListener::setGain(std::shared_ptr<AudioStream::Output>& other, DirectedPortPair pair, float gain)
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		if (auto it = graph.find(other->getHandle()); it != graph.end())
+		{
+			if (auto c = it->second.channels.find(pair); c != it->second.channels.end())
+				changeGain(c->second, gain, lock);
+		}
+	}
+
+	void MixGraphListener::setRemoteGain(const SharedStream::Key& key, DirectedPortPair pair, float gain)
+	{
+		std::lock_guard<std::mutex> lock(connectDisconnectMutex);
+
+		if (auto it = remotes.find(key); it != remotes.end())
+		{
+			if (auto c = it->second.channels.find(pair); c != it->second.channels.end())
+				changeGain(c->second, gain, lock);
+		}
+	}
+
+	void MixGraphListener::changeGain(Channel& channel, float gain, const std::lock_guard<std::mutex>& lock)
+	{
+		*channel.gain = gain;
+
+		// the host is passed through without mixing, so it needs its routes compiled once.
+		// otherwise the live routes pick it up, without priming the rings again
+		if (gain != 1 && isPassThroughPublished)
+			publishTopology(lock);
 	}
 
 	std::size_t MixGraphListener::reportLatency() const noexcept
@@ -192,141 +407,412 @@ namespace Signalizer
 		return isSynchronized;
 	}
 
-	void MixGraphListener::handleStructuralChange(AudioStream::ListenerContext& ctx, std::size_t numSamples, cpl::unique_lock<cpl::shared_mutex>& lock)
+	MixGraphListener::Statistics MixGraphListener::getStatistics() const noexcept
 	{
-		auto& realInfo = ctx.getInfo();
+		return { underruns, realignments, currentLatency, targetLatency };
+	}
 
-		if (structuralChange)
+	void MixGraphListener::publishTopology(const std::lock_guard<std::mutex>&)
+	{
+		// the last replaced table is released here, off the audio thread, once no audio thread can be using it anymore.
+		if (retiredTable)
+		{
+			while (tableReaders[retiredEpoch & 1].load() != 0)
+				std::this_thread::yield();
+
+			retiredTable.reset();
+		}
+
+		std::size_t numRoutes = 0;
+		PinInt maxDestinationPort = -1;
+		bool isIdentity = true;
+
+		for (auto& g : graph)
 		{
-			PinInt maxDestinationPort = -1;
-			std::int64_t setPorts = 0;
-			for (auto& g : graph)
+			numRoutes += g.second.channels.size();
+
+			for (auto& c : g.second.channels)
 			{
-				for (auto& entry : g.second.channelQueues)
-				{
-					maxDestinationPort = std::max(maxDestinationPort, entry.first.Destination);
-					setPorts |= 1ll << static_cast<std::int64_t>(entry.first.Destination);
-					auto nameCopy = entry.second.originName;
-					presentationInput.enqueueChannelName(entry.first.Destination, std::move(nameCopy));
-				}
+				maxDestinationPort = std::max(maxDestinationPort, c.first.Destination);
+				isIdentity &= c.first.Source == c.first.Destination && *c.second.gain == 1;
 			}
+		}
+
+		std::size_t numRemotes = 0;
 
-			// from first-indexing to zero-based
-			maxDestinationPort++;
+		for (auto& r : remotes)
+		{
+			if (!r.second.stream)
+				continue;
 
-			// round up to next multiple of two, so there's always pairs of channels
-			maxDestinationPort += maxDestinationPort % 2;
+			numRemotes++;
+			numRoutes += r.second.channels.size();
+
+			for (auto& c : r.second.channels)
+				maxDestinationPort = std::max(maxDestinationPort, c.first.Destination);
+		}
 
-			matrix.resizeChannels(maxDestinationPort);
+		// from first-indexing to zero-based
+		maxDestinationPort++;
+
+		// round up to next multiple of two, so there's always pairs of channels
+		maxDestinationPort += maxDestinationPort % 2;
+
+		// two host blocks, see onStreamPropertiesChanged()
+		const auto latency = std::max<std::size_t>(128, maximumLatency);
+
+		// the default layout: the host is the only source, and every channel is routed to itself, so no channel is left out either
+		const bool isPassThrough = graph.size() == 1 && numRemotes == 0 && isIdentity && maxDestinationPort > 0 && numRoutes == static_cast<std::size_t>(maxDestinationPort);
+
+		auto compiled = std::make_unique<RoutingTable>(graph.size() + numRemotes, numRoutes, static_cast<std::size_t>(maxDestinationPort), latency, isPassThrough);
+		isPassThroughPublished = isPassThrough;
+
+		for (auto& name : compiled->channelNames)
+			name = "nothing";
+
+		std::size_t sourceIndex = 1, routeIndex = 0;
+
+		for (auto& g : graph)
+		{
+			// the realtime output is always the first source
+			const bool isSelf = g.first == realtime->getHandle();
+			const auto index = isSelf ? 0 : sourceIndex++;
+			auto& source = compiled->sources[index];
+
+			source.handle = g.first;
+			source.stream = g.second.source;
+			source.firstRoute = routeIndex;
+			source.numRoutes = g.second.channels.size();
+
+			for (auto& c : g.second.channels)
+			{
+				auto& route = compiled->routes[routeIndex++];
+				route.source = c.first.Source;
+				route.destination = c.first.Destination;
+				route.gain = c.second.gain;
+				route.sourceIndex = index;
+				compiled->channelNames[c.first.Destination] = c.second.name;
+			}
+		}
+
+		for (auto& r : remotes)
+		{
+			if (!r.second.stream)
+				continue;
+
+			const auto index = sourceIndex++;
+			auto& source = compiled->sources[index];
+
+			// never matches a listener context, remote sources are only pumped
+			source.remote = r.second.stream;
+			source.firstRoute = routeIndex;
+			source.numRoutes = r.second.channels.size();
+
+			for (auto& c : r.second.channels)
+			{
+				auto& route = compiled->routes[routeIndex++];
+				route.source = c.first.Source;
+				route.destination = c.first.Destination;
+				route.gain = c.second.gain;
+				route.sourceIndex = index;
+				compiled->channelNames[c.first.Destination] = c.second.name;
+			}
+		}
+
+		if (!isPassThrough)
+		{
+			// counting sort of the routes by their channel
+			for (auto& route : compiled->routes)
+				compiled->firstMix[route.destination + 1]++;
+
+			for (std::size_t c = 1; c < compiled->firstMix.size(); ++c)
+				compiled->firstMix[c] += compiled->firstMix[c - 1];
+
+			auto next = compiled->firstMix;
+
+			for (std::size_t r = 0; r < compiled->routes.size(); ++r)
+				compiled->mixOrder[next[compiled->routes[r].destination]++] = r;
+		}
+
+		CPL_RUNTIME_ASSERTION(compiled->sources.size() > 0 && compiled->self().handle == realtime->getHandle());
+
+		// replaces any table that wasn't picked up yet
+		pendingTable = std::move(compiled);
+	}
+
+	void MixGraphListener::handleStructuralChange(RoutingTable& routing, AudioStream::ListenerContext& ctx, std::size_t numSamples)
+	{
+		auto& realInfo = ctx.getInfo();
+		auto& matrix = routing.matrix;
+
+		if (structuralChange)
+		{
+			if (!routing.namesPublished)
+			{
+				for (std::size_t i = 0; i < routing.channelNames.size(); ++i)
+					presentationInput.enqueueChannelName(i, std::move(routing.channelNames[i]));
+
+				routing.namesPublished = true;
+			}
 
 			presentationInput.initializeInfo(
 				[&](AudioStream::ProducerInfo & info)
 				{
-					info.channels = maxDestinationPort;
+					info.channels = matrix.size();
 					info.sampleRate = realInfo.sampleRate;
-					info.anticipatedSize = static_cast<std::uint32_t>(numSamples);
+					// the largest block the host announced, so listeners can size their buffers once
+					info.anticipatedSize = static_cast<std::uint32_t>(std::max<std::size_t>(realInfo.anticipatedSize, numSamples));
 				}
 			);
 
+			targetLatency = static_cast<std::size_t>(routing.targetLatency);
+			structuralChange = false;
+		}
+
+		// storage was reserved for the capacity of the table, unless it's never used
+		if (!routing.isPassThrough)
+			matrix.softBufferResize(numSamples);
+	}
+
+	bool MixGraphListener::present(RoutingTable& routing, RoutingTable::Source& source, const BlockTimeline::Stamp* host, std::int64_t hostPosition, std::size_t numSamples)
+	{
+		BlockTimeline::Stamp stamp;
+
+		// silent unless something is available below
+		source.presentCount = 0;
+
+		// nothing from this source yet
+		if (!source.timeline.latest(stamp))
+			return true;
+
+		const auto samples = static_cast<std::int64_t>(numSamples);
+		const auto end = stamp.end();
+		const auto oldest = std::max<std::int64_t>(0, end - routing.capacity);
+
+		if (!source.isPrimed)
+		{
+			// still filling up to the target latency
+			if (end < routing.targetLatency + samples)
+				return true;
 
-			for (std::int64_t i = 0; i < maxDestinationPort; ++i)
+			source.readPosition = end - routing.targetLatency - samples;
+			source.pendingDifference = 0;
+			source.isPrimed = true;
+		}
+
+		bool isSynchronized = true;
+		const bool isLocked = host && host->isPlaying && stamp.isPlaying;
+
+		if (isLocked)
+		{
+			// where the host is on its timeline, in this source
+			const auto expected = stamp.positionOf(host->timelineOf(hostPosition));
+			const auto difference = expected - source.readPosition;
+
+			if (difference != 0)
 			{
-				if ((setPorts & (1ll << i)) == 0)
+				isSynchronized = false;
+
+				// twice the same offset? then it isn't just a late block
+				if (difference == source.pendingDifference && expected >= oldest && expected <= end)
 				{
-					presentationInput.enqueueChannelName(i, "nothing");
+					source.readPosition = expected;
+					source.pendingDifference = 0;
+					realignments++;
+				}
+				else
+				{
+					source.pendingDifference = difference;
 				}
 			}
+		}
+		else
+		{
+			source.pendingDifference = 0;
+		}
+
+		// fell further behind than the ring holds
+		if (source.readPosition < oldest)
+		{
+			source.readPosition = std::max(oldest, end - routing.targetLatency - samples);
+			realignments++;
+		}
 
+		// the rest stays silent, the matrix is cleared
+		const auto available = std::max<std::int64_t>(0, std::min(samples, end - source.readPosition));
 
-			structuralChange = false;
+		source.presentFrom = source.readPosition;
+		source.presentCount = static_cast<std::size_t>(available);
+		source.readPosition += samples;
+
+		if (available < samples)
+		{
+			underruns++;
+
+			// without a timeline to follow, buffer up to the target latency again
+			if (!isLocked)
+				source.isPrimed = false;
 		}
 
-		matrix.softBufferResize(numSamples);
+		currentLatency = std::max<std::size_t>(currentLatency, static_cast<std::size_t>(std::max<std::int64_t>(0, end - source.readPosition)));
+
+		return isSynchronized;
 	}
 
-	void MixGraphListener::deliver(AudioStream::ListenerContext& ctx, std::size_t numSamples)
+	template<typename ISA>
+	void MixGraphListener::mix(RoutingTable& routing, std::size_t numSamples)
 	{
-		cpl::unique_lock<cpl::shared_mutex> graphLayoutAndDataLock(dataMutex);
+		using namespace cpl::simd;
+		typedef typename ISA::V V;
 
-		handleStructuralChange(ctx, numSamples, graphLayoutAndDataLock);
+		constexpr std::size_t lanes = elements_of<V>::value;
 
-		// no channels to show
-		if (matrix.size() < 1)
-			return;
+		for (std::size_t d = 0; d + 1 < routing.firstMix.size(); ++d)
+		{
+			const auto first = routing.firstMix[d];
+			const auto count = routing.firstMix[d + 1] - first;
 
-		// clear the matrix for additive / empty slots - might not be needed?
-		matrix.clear();
+			if (count == 0)
+				continue;
 
-		const auto hostEndpoint = self->endpoint.load();
-		const auto hostSamples = static_cast<std::int64_t>(self->containedSamples.load());
+			AFloat* const output = routing.matrix[d];
+			cpl::variable_array<const AFloat*> heads(count);
+			cpl::variable_array<AFloat> gains(count);
 
-		bool seeminglySynchronized = true;
+			for (std::size_t offset = 0; offset < numSamples;)
+			{
+				// the span where every contributing ring is contiguous, and none of them runs out
+				std::size_t length = numSamples - offset, active = 0;
 
-		for (auto& g : graph)
-		{
-			auto& state = g.second;
-			auto containedInState = state.containedSamples.load();
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const auto& route = routing.routes[routing.mixOrder[first + i]];
+					const auto& source = routing.sources[route.sourceIndex];
+					const AFloat gain = *route.gain;
 
-			if (containedInState != 0 && ctx.getPlayhead().isPlaying())
-			{
-				const auto sampleDifference = containedInState - hostSamples;
-				const auto tlDifference = state.endpoint - hostEndpoint;
-				const auto difference = sampleDifference - tlDifference;
+					if (gain == 0 || offset >= source.presentCount)
+						continue;
+
+					const auto position = source.presentFrom + static_cast<std::int64_t>(offset);
+
+					heads[active] = route.buffer.at(position);
+					gains[active] = gain;
+					active++;
+
+					length = std::min({ length, source.presentCount - offset, route.buffer.contiguous(position) });
+				}
+
+				// sources only ever run out, so the rest stays silent. the matrix is cleared
+				if (active == 0)
+					break;
+
+				AFloat* const out = output + offset;
+				const auto stop = length - (length & (lanes - 1));
 
-				const auto hasDiscontinuity = self->discontinuity || state.discontinuity;
+				suitable_container<V> result;
+				std::size_t n = 0;
 
-				if (difference != 0)
+				for (; n < stop; n += lanes)
 				{
-					seeminglySynchronized = false;
-					// twice we had the same delay? try to adjust
-					if (!hasDiscontinuity && state.typicalOffset == difference)
-					{
-						if (difference > 0)
-						{
-							// erase history, we are too far behind...
-							containedInState -= std::min(containedInState, difference);
-							state.containedSamples = containedInState;
-						}
-						else
-						{
-							// add history, insert silence...
-							for (auto& q : state.channelQueues)
-							{
-								q.second.buffer.createWriter().advance(static_cast<std::size_t>(-difference));
-							}
-
-							containedInState += -difference;
-							state.containedSamples = containedInState;
-						}
-
-						state.typicalOffset = 0;
-					}
-					else
-					{
-						state.typicalOffset = difference;
-					}
+					V sum = zero<V>();
+
+					for (std::size_t i = 0; i < active; ++i)
+						sum = sum + set1<V>(gains[i]) * loadu<V>(heads[i] + n);
+
+					result = sum;
+					std::copy(result.begin(), result.end(), out + n);
 				}
-			}
 
-			// if we don't have enough to deliver, do nothing (matrix cleared at beginning)
-			if (containedInState >= static_cast<std::int64_t>(numSamples) || containedInState != 0)
-			{
-				for (auto& q : state.channelQueues)
+				for (; n < length; ++n)
 				{
-					auto reader = q.second.buffer.createProxyView();
-					reader.offset(-containedInState);
+					AFloat sum = 0;
+
+					for (std::size_t i = 0; i < active; ++i)
+						sum += gains[i] * heads[i][n];
 
-					reader.copyFromHead<true>(matrix[q.first.Destination], numSamples);
+					out[n] = sum;
 				}
+
+				offset += length;
 			}
+		}
+	}
+
+	void MixGraphListener::pump(RoutingTable& routing, RoutingTable::Source& source)
+	{
+		BlockTimeline::Stamp stamp;
 
-			// seems ultra wrong but makes them sync
-			// something to do with this exceeding max buffer size back in onStreamAudio
-			auto current = state.containedSamples.load();
-			auto toSubtract = std::min(current, static_cast<std::int64_t>(numSamples));
-			state.containedSamples.store(current - toSubtract);
+		if (!source.remote->latest(stamp))
+			return;
+
+		const auto end = stamp.end();
+
+		// the other process restarted the stream
+		if (source.remotePosition > end)
+			source.remotePosition = 0;
+
+		// anything older might be overwritten while it's copied
+		const auto from = std::max({ source.remotePosition, end - source.remote->history(), std::int64_t(0) });
+
+		if (from >= end)
+			return;
+
+		const auto numSamples = static_cast<std::size_t>(end - from);
+		const auto numChannels = source.remote->getNumChannels();
+		const auto position = source.timeline.getWritePosition();
+
+		constexpr std::size_t chunkSize = 256;
+		AFloat chunk[chunkSize];
+
+		for (auto q = routing.begin(source); q != routing.end(source); ++q)
+		{
+			if (q->source >= static_cast<PinInt>(numChannels))
+				continue;
+
+			for (std::size_t offset = 0; offset < numSamples; offset += chunkSize)
+			{
+				const auto count = std::min(chunkSize, numSamples - offset);
+				source.remote->read(static_cast<std::size_t>(q->source), from + offset, chunk, count);
+				q->buffer.write(position + offset, chunk, count);
+			}
 		}
 
+		source.timeline.publish(stamp.timelineOf(from), numSamples, stamp.isPlaying);
+		source.remotePosition = end;
+	}
+
+	void MixGraphListener::deliver(RoutingTable& routing, AudioStream::ListenerContext& ctx, std::size_t numSamples)
+	{
+		handleStructuralChange(routing, ctx, numSamples);
+
+		auto& self = routing.self();
+		auto& matrix = routing.matrix;
+
+		// no channels to show
+		if (matrix.size() < 1)
+		{
+			self.readPosition += numSamples;
+			return;
+		}
+
+		// clear the matrix for additive / empty slots
+		matrix.clear();
+
+		BlockTimeline::Stamp host;
+		const bool hasHost = self.timeline.latest(host);
+		const auto hostPosition = self.readPosition;
+
+		bool seeminglySynchronized = true;
+		currentLatency = 0;
+
+		// the host is presented like any other source, and always lines up with itself
+		for (auto& source : routing.sources)
+		{
+			seeminglySynchronized &= present(routing, source, hasHost ? &host : nullptr, hostPosition, numSamples);
+		}
+
+		cpl::simd::dynamic_isa_dispatch<AFloat, MixDispatcher>(*this, routing, numSamples);
+
 		this->isSynchronized = seeminglySynchronized;
 
 		// TODO: don't copy into a matrix, rig a provider from the read heads instead?
@@ -342,198 +828,126 @@ namespace Signalizer
 		if (handle == presentationOutput)
 			return;
 
-		const auto localMaxLatency = maximumLatency.load();
-		const auto maxBufferSize = localMaxLatency * 8;
-		const auto globalPosition = ctx.getPlayhead().getPositionInSamples();
-
 		const bool isSelf = handle == realtime->getHandle();
 
-		if (enabled)
-		{
-			cpl::shared_lock<cpl::shared_mutex> lock(dataMutex);
+		// only the realtime callback replaces the table, so it can't change under the reference below.
+		if (isSelf)
+			updateTopologyCommands();
 
-			// certain conditions can cause callbacks to temporarily appear, even though we deregistrered from this source and no longer know it.
-			auto it = graph.find(handle);
-			if (it == graph.end())
-				return;
+		if (!enabled)
+			return;
 
-			auto& s = it->second;
+		// Sources never wait for each other or for the presentation: each one only writes its own rings.
+		TableReference routing(*this);
 
-			s.discontinuity = s.endpoint - globalPosition;
+		if (!routing.get())
+			return;
 
-			s.globalPosition = globalPosition;
-			s.endpoint = globalPosition + numSamples;
+		// certain conditions can cause callbacks to temporarily appear, even though we deregistrered from this source and no longer know it.
+		auto s = routing->find(handle);
+		if (!s)
+			return;
 
-			const auto neededSize = std::min<std::size_t>(maxBufferSize, s.containedSamples + numSamples);
+		if (isSelf && routing->isPassThrough)
+		{
+			// present the audio of the host directly, nothing else needs to line up with it
+			if (!NONTERMINAL_ASSUMPTION(routing->matrix.size() <= numChannels))
+				return;
 
-			for (auto& q : s.channelQueues)
-			{
-				auto& channelQ = q.second.buffer;
-				// clamp to max of 16 * buffersize.
-				if (channelQ.getSize() < neededSize)
-					channelQ.setStorageRequirements(neededSize, cpl::Math::nextPow2(neededSize), true);
-
-				// TODO: Having this so late causes this node to be processed anyway "as if" it had stuff, good idea?
-				if (!NONTERMINAL_ASSUMPTION(q.first.Source < numChannels))
-					continue;
-
-				channelQ
-					.createWriter()
-					.copyIntoHead(buffer[q.first.Source], numSamples);
-			}
+			handleStructuralChange(*routing.get(), ctx, numSamples);
+
+			currentLatency = 0;
+			isSynchronized = true;
 
-			const auto currentContained = s.containedSamples.load() + numSamples;
-			s.containedSamples.store(std::min<std::int64_t>(currentContained, maxBufferSize));
+			presentationInput.processIncomingRTAudio(buffer, routing->matrix.size(), numSamples, ctx.getPlayhead());
+			return;
 		}
 
+		const auto position = s->timeline.getWritePosition();
 
-		if (isSelf)
+		for (auto q = routing->begin(*s); q != routing->end(*s); ++q)
 		{
-			updateTopologyCommands();
+			// the host layout can have fewer channels than the topology was made for, those stay silent
+			if (q->source >= static_cast<PinInt>(numChannels))
+				continue;
 
-			if (!enabled || graph.empty())
-				return;
-
-			const auto hostSamples = self->containedSamples.load();
-			const auto hostOrigin = self->endpoint - hostSamples;
-
-			auto min = hostSamples;
-			auto latency = min;
-			
-			if (min == 0)
-			{
-				// Happens when changing self (resetting the enqueued count)
-				return;
-			}
-
-			for (auto& g : graph)
-			{
-				if (min <= 0)
-					break;
+			q->buffer.write(position, buffer[q->source], numSamples);
+		}
 
-				auto containedInState = g.second.containedSamples.load();
-				latency = std::max(containedInState, latency);
+		s->timeline.publish(ctx.getPlayhead().getPositionInSamples(), numSamples, ctx.getPlayhead().isPlaying());
 
-				// when playing, we want to clamp the available amount of samples with respect to the alignment
-				// of the timeline compared to the host. this ensures the inner chomping doesn't play "catch up"
-				if (ctx.getPlayhead().isPlaying() && !self->discontinuity && !g.second.discontinuity)
-				{
-					const auto available = g.second.endpoint - hostOrigin;
+		if (!isSelf)
+			return;
 
-					if(available < containedInState)
-						containedInState = std::min(containedInState, std::max(0ll, available));
-				}
+		// remote sources have no audio thread of their own in this process
+		for (auto& source : routing->sources)
+		{
+			if (source.remote)
+				pump(*routing.get(), source);
+		}
 
-				if (containedInState > 0)
-				{
-					// we can keep progressing.
-					min = std::min(min, containedInState);
-				}
-				else if (hostSamples > static_cast<std::int64_t>(localMaxLatency))
-				{
-					// this link in the chain is still zero, but we are spilling over our max latency which is unexpected 
-					// even for a reverse dependency.
-					// is something on the way, at least?
-
-					if(auto sh = g.second.source.lock(); sh && sh->getApproximateInFlightPackets() > 0)
-					{
-						// OK: we will get notified at a later stage.
-						return;
-					}
-					else
-					{
-						// super special case for *current having been updated inbetween these statements (easy to provoke with a debugger)
-						const auto newAvailable = g.second.containedSamples.load();
-						if (newAvailable == containedInState)
-						{
-							// ignore this dependency - it's not processing yet for some reason or deleted itself
-							continue;
-						}
-						else
-						{
-							min = std::min(min, newAvailable);
-							continue;
-						}
-					}
-				}
-				else
-				{
-					// Not spilling over, but there's globally not > 0 samples so just early out.
-					return;
-				}
-			}
+		auto& self = routing->self();
+		BlockTimeline::Stamp host;
 
-			if (min > 0)
-			{
-				// make sure when we're processing more than a stereo pair to at least present a sizable buffer,
-				// since multithreading is going to be involved.
-				constexpr int minMultiChannel = 64;
+		if (!self.timeline.latest(host))
+			return;
 
-				if (matrix.size() > 2 && min < minMultiChannel)
-					return;
+		const auto ready = host.end() - routing->targetLatency;
 
-				currentLatency = latency;
-				deliver(ctx, min);
-			}
+		if (!self.isPrimed)
+		{
+			if (ready <= 0)
+				return;
 
+			self.readPosition = ready;
+			self.isPrimed = true;
+			return;
 		}
-	}
 
-	void MixGraphListener::updateTopologyCommands()
-	{
-		decltype(connectionCommands) localNewToplogy;
+		// samples of the host that are past the jitter buffer, and can be presented
+		auto available = ready - self.readPosition;
 
+		if (available > routing->capacity)
 		{
-			std::lock_guard<std::mutex> cdlock(connectDisconnectMutex);
-			std::swap(localNewToplogy, connectionCommands);
+			// f.ex. after a topology change stalled the presentation
+			self.readPosition = ready - routing->capacity;
+			available = routing->capacity;
+			realignments++;
 		}
 
-		// eager delivery. only "we" can alter the graph, so we don't need protection.
-		if (!localNewToplogy.empty())
-			structuralChange = true;
-		else
+		if (available <= 0)
 			return;
 
-		isSynchronized = false;
-
-		// so we can alter mapping tables. can be done without.
-		cpl::unique_lock<cpl::shared_mutex> lock(dataMutex);
+		// make sure when we're processing more than a stereo pair to at least present a sizable buffer,
+		// since multithreading is going to be involved.
+		constexpr int minMultiChannel = 64;
 
-		for (auto& command : localNewToplogy)
-		{
-			const auto key = command.stream.get();
-			auto it = graph.find(key->getHandle());
+		if (routing->matrix.size() > 2 && available < minMultiChannel)
+			return;
 
-			if (it == graph.end())
-			{
-				CPL_RUNTIME_ASSERTION(command.isConnection);
-				CPL_RUNTIME_ASSERTION(command.stream.get() != nullptr);
-				// TODO: This assertion has fired in the wild. See added NONTERMINAL_ASSUMPTION below.
-				CPL_RUNTIME_ASSERTION(command.stream.get() != self->source.lock().get());
-				it = emplace(command.stream);
-			}
+		deliver(*routing.get(), ctx, static_cast<std::size_t>(available));
+	}
 
-			auto& source = it->second;
+	void MixGraphListener::updateTopologyCommands()
+	{
+		// never wait for a table being compiled, it'll be picked up next time around.
+		std::unique_lock<std::mutex> cdlock(connectDisconnectMutex, std::try_to_lock);
 
-			if (command.isConnection)
-			{
-				source.refCount++;
+		if (!cdlock.owns_lock() || !pendingTable)
+			return;
 
-				// also ensures it exists.
-				source.channelQueues[command.pair].originName = std::move(command.name); 
+		// the new rings are empty, so every source buffers up to the target latency again
+		std::swap(table, pendingTable);
+		liveTable.store(table.get());
+		// readers of the replaced table are all counted in the slot of this epoch
+		retiredEpoch = tableEpoch.fetch_add(1);
 
-				// TODO: Pauses other channels from this source (and everything)
-				source.containedSamples = 0;
-				
-			}
-			else
-			{
-				source.channelQueues.erase(command.pair);
+		// released by the next compilation
+		retiredTable = std::move(pendingTable);
 
-				if (--source.refCount == 0 && NONTERMINAL_ASSUMPTION(&source != self))
-					remove(it);
-			}
-		}
+		// eager delivery.
+		structuralChange = true;
+		isSynchronized = false;
 	}
 
 }
@@ -36,7 +36,7 @@
 	#include <cpl/state/Serialization.h>
 	#include <cpl/dsp/ChannelMatrix.h>
 	#include <mutex>
-	#include <cpl/shared_mutex.h>
+	#include <atomic>
 	#include <map>
 	#include <set>
 	#include <string>
@@ -46,12 +46,14 @@
 	#include <memory>
 	#include "ConcurrentConfig.h"
 	#include "CommonSignalizer.h"
+	#include "SampleRing.h"
+	#include "SharedStreamTransport.h"
 
 	namespace Signalizer
 	{
 		class AudioProcessor;
 		
-		class MixGraphListener : public AudioStream::Listener, public std::enable_shared_from_this<MixGraphListener>
+		class MixGraphListener : public AudioStream::Listener, public std::enable_shared_from_this<MixGraphListener>, private juce::AsyncUpdater, private juce::Timer
 		{
 		public:
 			friend class HostGraph;
@@ -88,11 +90,45 @@
 
 			static std::pair<Handle, std::shared_ptr<AudioStream::Output>> create(AudioProcessor& processor);
 
-			void connect(std::shared_ptr<AudioStream::Output>& stream, DirectedPortPair pair, const std::string& name);
+			/// <summary>
+			/// Routes a channel of the stream to a presented channel, scaled by the gain.
+			/// Every route to the same presented channel is summed.
+			/// </summary>
+			void connect(std::shared_ptr<AudioStream::Output>& stream, DirectedPortPair pair, const std::string& name, float gain = 1);
 			void disconnect(std::shared_ptr<AudioStream::Output>& stream, DirectedPortPair pair);
+			/// <summary>
+			/// Changes the gain of an existing route while it plays, without compiling the topology again.
+			/// </summary>
+			void setGain(std::shared_ptr<AudioStream::Output>& stream, DirectedPortPair pair, float gain);
+			/// <summary>
+			/// Connects a stream published by another process, see SharedStream. Returns false if it isn't published.
+			/// The stream is reopened whenever the publisher goes away or moves it, and joins the mix once its segment exists.
+			/// </summary>
+			bool connectRemote(const SharedStream::Key& key, DirectedPortPair pair, const std::string& name, float gain = 1);
+			void disconnectRemote(const SharedStream::Key& key, DirectedPortPair pair);
+			void setRemoteGain(const SharedStream::Key& key, DirectedPortPair pair, float gain);
 			std::size_t reportLatency() const noexcept;
 			bool reportSynchronized() const noexcept;
 
+			struct Statistics
+			{
+				/// <summary>
+				/// Deliveries where a source hadn't written enough yet, and silence was presented in its place.
+				/// </summary>
+				std::uint64_t underruns;
+				/// <summary>
+				/// Times a source was moved to line up with the host timeline, or to get back within the bounds of the jitter buffer.
+				/// </summary>
+				std::uint64_t realignments;
+				/// <summary>
+				/// The samples buffered ahead of the presentation, for the source that is furthest ahead.
+				/// </summary>
+				std::size_t latency;
+				std::size_t targetLatency;
+			};
+
+			Statistics getStatistics() const noexcept;
+
 			~MixGraphListener();
 
 		private:
@@ -101,101 +137,235 @@
 
 			MixGraphListener(AudioProcessor& p, AudioStream::IO&& presentation);
 
-			typedef cpl::CLIFOStream<AFloat> Buffer;
+			typedef SampleRing<AFloat> Buffer;
 
-			struct ConnectionCommand
+			typedef cpl::relaxed_atomic<AFloat> Gain;
+
+			struct Channel
 			{
-				std::shared_ptr<AudioStream::Output> stream;
 				std::string name;
-				DirectedPortPair pair;
-				bool isConnection;
+				/// <summary>
+				/// Shared with the routes of the tables compiled from it, which read it live.
+				/// </summary>
+				std::shared_ptr<Gain> gain;
+			};
+
+			/// <summary>
+			/// A source connected in the topology, as edited by <see cref="connect"/> and <see cref="disconnect"/>.
+			/// Never touched by the audio threads.
+			/// </summary>
+			struct Node
+			{
+				std::map<DirectedPortPair, Channel> channels;
+				std::weak_ptr<AudioStream::Output> source;
+				std::int32_t refCount {};
+			};
+
+			/// <summary>
+			/// A source in another process, read from shared memory instead of listened to.
+			/// </summary>
+			struct RemoteNode
+			{
+				std::map<DirectedPortPair, Channel> channels;
+				/// <summary>
+				/// Null while the publisher hasn't created the segment, or went away. Left out of the tables until then.
+				/// </summary>
+				std::shared_ptr<SharedStream::Subscriber> stream;
 			};
 
-			struct State
+			/// <summary>
+			/// The topology compiled into flat arrays, with every buffer allocated up front for <see cref="capacity"/> samples.
+			/// Built off the audio thread, and swapped in by the realtime callback so the audio threads never allocate,
+			/// search trees or handle strings.
+			/// Every connection is a wait-free single producer / single consumer ring: the source's audio thread writes,
+			/// and the realtime callback of this instance reads it through a jitter buffer of <see cref="targetLatency"/> samples.
+			/// </summary>
+			struct RoutingTable
 			{
-				struct Channel
+				struct Route
 				{
-					cpl::CLIFOStream<AFloat> buffer;
-					std::string originName;
+					Buffer buffer;
+					PinInt source {};
+					PinInt destination {};
+					std::shared_ptr<const Gain> gain;
+					std::size_t sourceIndex {};
 				};
 
-				std::map<DirectedPortPair, Channel> channelQueues;
+				struct Source
+				{
+					AudioStream::Handle handle {};
+					std::weak_ptr<AudioStream::Output> stream;
+					/// <summary>
+					/// The routes of this source are <see cref="firstRoute"/> ..< <see cref="firstRoute"/> + <see cref="numRoutes"/>
+					/// </summary>
+					std::size_t firstRoute {}, numRoutes {};
+					/// <summary>
+					/// Written by the audio thread of the source.
+					/// </summary>
+					BlockTimeline timeline;
+					/// <summary>
+					/// The next position to present, only used by the realtime callback.
+					/// </summary>
+					std::int64_t readPosition {};
+					/// <summary>
+					/// The offset to the host timeline seen last delivery. Only a difference that repeats causes a realignment,
+					/// so a source that's just late for a single block isn't moved.
+					/// </summary>
+					std::int64_t pendingDifference {};
+					/// <summary>
+					/// The samples presented this block start at <see cref="presentFrom"/>, and the first <see cref="presentCount"/> of them
+					/// are available. Set by <see cref="present"/>, and mixed afterwards.
+					/// </summary>
+					std::int64_t presentFrom {};
+					std::size_t presentCount {};
+					/// <summary>
+					/// Whether the source has buffered up to the target latency, and is being presented.
+					/// </summary>
+					bool isPrimed = false;
+					/// <summary>
+					/// Set for sources in other processes. The realtime callback copies their new blocks into the rings
+					/// (see <see cref="pump"/>), and is the producer of the timeline instead.
+					/// </summary>
+					std::shared_ptr<SharedStream::Subscriber> remote;
+					/// <summary>
+					/// The next position to copy from the remote stream.
+					/// </summary>
+					std::int64_t remotePosition {};
+				};
+
+				RoutingTable(std::size_t numSources, std::size_t numRoutes, std::size_t channels, std::size_t latency, bool isPassThrough);
+
+				Source* find(AudioStream::Handle handle) noexcept;
+				Route* begin(const Source& s) noexcept { return routes.data() + s.firstRoute; }
+				Route* end(const Source& s) noexcept { return routes.data() + s.firstRoute + s.numRoutes; }
+
 				/// <summary>
-				/// The amount of samples contained leading up to <see cref="endpoint"/>
+				/// The realtime output itself, always the first source.
 				/// </summary>
-				cpl::weak_atomic<std::int64_t> containedSamples {};
+				Source& self() noexcept { return sources.front(); }
+
+				std::vector<Source> sources;
+				std::vector<Route> routes;
 				/// <summary>
-				/// Reported discontinuity, ie. if the last <see cref="globalPosition"/> didn't update the current
-				/// <see cref="endpoint"/>
+				/// The routes by presented channel: the routes into channel c are the indices mixOrder[firstMix[c]] ..< mixOrder[firstMix[c + 1]].
 				/// </summary>
-				std::int64_t discontinuity{};
+				std::vector<std::size_t> mixOrder, firstMix;
 				/// <summary>
-				/// The last timing difference between this state and the host.
+				/// One per presented channel. Moved into the presentation the first time the table is in use.
 				/// </summary>
-				std::int64_t typicalOffset{};
+				std::vector<std::string> channelNames;
+				cpl::ChannelMatrix<AudioStream::DataType> matrix;
 				/// <summary>
-				/// The last reported time stamp of this current graph (not including the samples leading up to the endpoint).
+				/// Samples every source is presented behind its newest block, which leaves room for the tracks of the host to be processed
+				/// in any order, or on different threads.
 				/// </summary>
-				std::int64_t globalPosition{};
+				const std::int64_t targetLatency;
 				/// <summary>
-				/// The end of this current time line, ie. the global position plus the amount of samples this state received
-				/// last time around.
+				/// Samples of history kept in each ring, and the most that can be delivered at once.
 				/// </summary>
-				cpl::weak_atomic<std::int64_t> endpoint{};
-				std::int32_t refCount {};
+				const std::int64_t capacity;
+				/// <summary>
+				/// Only the host is connected, with every channel to itself. Its audio is then presented as is,
+				/// without rings, jitter buffer or matrix.
+				/// </summary>
+				const bool isPassThrough;
+				bool namesPublished = false;
+			};
 
-				std::weak_ptr<AudioStream::Output> source;
+			/// <summary>
+			/// Keeps the live routing table from being deleted while an audio thread uses it, without locking.
+			/// Readers count themselves in the slot of the current epoch. A replaced table is only deleted
+			/// once the slot of the epoch it was replaced in has drained, see <see cref="publishTopology"/>.
+			/// </summary>
+			class TableReference
+			{
+			public:
 
-				State(const State& other) = delete;
-				State(State&& other) noexcept
-					: channelQueues(std::move(other.channelQueues))
-					, containedSamples(other.containedSamples)
-					, globalPosition(other.globalPosition)
-					, endpoint(other.endpoint)
-					, refCount(other.refCount)
-					, source(std::move(other.source))
-				{
-				
-				}
-				State& operator = (State&& other) = delete;
+				TableReference(MixGraphListener& parent) noexcept;
+				~TableReference();
 
-				static State empty() { return {}; }
+				RoutingTable* get() const noexcept { return table; }
+				RoutingTable* operator -> () const noexcept { return table; }
 
 			private:
-				State() {}
+				MixGraphListener& parent;
+				RoutingTable* table;
+				std::uint32_t slot;
 			};
 
 			auto emplace(std::shared_ptr<AudioStream::Output> stream);
-			void remove(std::map<AudioStream::Handle, State>::iterator position);
+			void remove(std::map<AudioStream::Handle, Node>::iterator position);
 
 			void onStreamPropertiesChanged(AudioStream::ListenerContext& changedSource, const AudioStream::AudioStreamInfo& before) override final;
 			void onStreamAudio(AudioStream::ListenerContext& source, AFloat** buffer, std::size_t numChannels, std::size_t numSamples) override final;
 			void onStreamDied(AudioStream::ListenerContext& dyingSource) override final;
+			void handleAsyncUpdate() override;
+			/// <summary>
+			/// Renews the leases of the remote streams, and reopens those that went stale.
+			/// </summary>
+			void timerCallback() override;
 
-			void handleStructuralChange(AudioStream::ListenerContext&, std::size_t numSamples, cpl::unique_lock<cpl::shared_mutex>& lock);
-			void deliver(AudioStream::ListenerContext& ctx, std::size_t numSamples);
+			void handleStructuralChange(RoutingTable& routing, AudioStream::ListenerContext&, std::size_t numSamples);
+			void deliver(RoutingTable& routing, AudioStream::ListenerContext& ctx, std::size_t numSamples);
+			/// <summary>
+			/// Moves the read position of a source as needed, and decides what's available of the next samples.
+			/// Returns false if the source isn't lined up with the host timeline.
+			/// </summary>
+			bool present(RoutingTable& routing, RoutingTable::Source& source, const BlockTimeline::Stamp* host, std::int64_t hostPosition, std::size_t numSamples);
+			/// <summary>
+			/// Sums the presented samples of every route into its channel of the matrix, in one pass per channel.
+			/// </summary>
+			template<typename ISA>
+			void mix(RoutingTable& routing, std::size_t numSamples);
+
+			struct MixDispatcher
+			{
+				template<typename ISA> static void dispatch(MixGraphListener& m, RoutingTable& routing, std::size_t numSamples) { m.mix<ISA>(routing, numSamples); }
+			};
+			/// <summary>
+			/// Copies the blocks a remote source published since last time into its rings.
+			/// </summary>
+			void pump(RoutingTable& routing, RoutingTable::Source& source);
 
+			/// <summary>
+			/// Compiles the current topology, and leaves it for the realtime callback to swap in.
+			/// </summary>
+			void publishTopology(const std::lock_guard<std::mutex>&);
+			void changeGain(Channel& channel, float gain, const std::lock_guard<std::mutex>&);
 			void updateTopologyCommands();
 			void assignSelf();
 
 			const int id;
-			std::map<AudioStream::Handle, State> graph;
-			std::size_t initialSampleCapacity {};
+			std::map<AudioStream::Handle, Node> graph;
+			std::map<SharedStream::Key, RemoteNode> remotes;
 			std::shared_ptr<AudioStream::Output> realtime;
 			AudioStream::Input presentationInput;
 			AudioStream::Handle presentationOutput;
 			std::weak_ptr<AudioStream::Output> weakPresentationOutput;
-			State* self;
-			cpl::shared_mutex dataMutex;
 
+			/// <summary>
+			/// Protects the <see cref="graph"/>, the <see cref="remotes"/> and the pending and retired tables.
+			/// The realtime callback only ever tries to lock it.
+			/// </summary>
 			std::mutex connectDisconnectMutex;
-			std::vector<ConnectionCommand> connectionCommands;
+			/// <summary>
+			/// The table in use, only replaced by the realtime callback. Audio threads access it through a <see cref="TableReference"/>.
+			/// </summary>
+			std::unique_ptr<RoutingTable> table;
+			std::unique_ptr<RoutingTable> pendingTable, retiredTable;
+			std::atomic<RoutingTable*> liveTable { nullptr };
+			std::atomic<std::uint32_t> tableEpoch { 0 }, tableReaders[2] { { 0 }, { 0 } };
+			std::uint32_t retiredEpoch {};
+			/// <summary>
+			/// Whether the last compiled table passes the host through, which ignores the gains.
+			/// </summary>
+			bool isPassThroughPublished = false;
 
-			cpl::ChannelMatrix<AudioStream::DataType> matrix;
 			std::atomic_bool structuralChange;
 			std::atomic_bool enabled;
 			cpl::weak_atomic<std::size_t> maximumLatency;
-			cpl::relaxed_atomic<std::size_t> currentLatency;
+			cpl::relaxed_atomic<std::size_t> currentLatency, targetLatency;
+			cpl::relaxed_atomic<std::uint64_t> underruns, realignments;
 			cpl::relaxed_atomic<bool> isSynchronized;
 
 			ConcurrentConfig& concurrentConfig;
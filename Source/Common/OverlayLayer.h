@@ -0,0 +1,151 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:OverlayLayer.h
+
+		2D graphics rasterised into a texture, and only painted again when invalidated
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_OVERLAYLAYER_H
+	#define SIGNALIZER_OVERLAYLAYER_H
+
+	#include "CachedGeometry.h"
+	#include <cpl/rendering/OpenGLRasterizers.h>
+	#include <memory>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// The static part of a view's 2D graphics (axis labels, legends), painted in software into an image
+		/// that is kept in a texture, and composited with OpenGL every frame.
+		/// Things that change every frame (cursor readouts, diagnostics) should still go through renderGraphics().
+		/// Must only be used on the OpenGL thread. Call release() before the context goes away.
+		/// </summary>
+		class OverlayLayer
+		{
+		public:
+
+			/// <summary>
+			/// Paints the layer again if the key changed, the view was resized or the layer was invalidated,
+			/// and draws it on top of the current frame.
+			/// The key should hold everything the painter depends on, that isn't covered by invalidate().
+			/// </summary>
+			template<typename Painter>
+			void render(int width, int height, double scale, std::initializer_list<double> values, Painter paint)
+			{
+				const int pixelWidth = std::max(1, juce::roundToInt(width * scale));
+				const int pixelHeight = std::max(1, juce::roundToInt(height * scale));
+
+				const bool isResized = !texture || pixelWidth != imageWidth || pixelHeight != imageHeight;
+				const bool isStale = key.update(values);
+
+				if (isResized || (isStale && framesSinceRaster >= refreshInterval))
+				{
+					rasterize(pixelWidth, pixelHeight, scale, paint);
+					framesSinceRaster = 0;
+				}
+				else if (isStale)
+				{
+					// keep it stale until it's time to repaint
+					key.invalidate();
+				}
+
+				framesSinceRaster++;
+
+				cpl::OpenGLRendering::COpenGLStack openGLStack;
+				cpl::OpenGLRendering::MatrixModification m;
+				m.loadIdentityMatrix();
+
+				openGLStack.enable(GL_TEXTURE_2D);
+				// juce images are premultiplied
+				openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+				{
+					// the texture is padded to powers of two, with the image in the top left corner
+					const auto textureWidth = 2.0f * image.getWidth() / imageWidth;
+					const auto textureHeight = 2.0f * image.getHeight() / imageHeight;
+
+					cpl::OpenGLRendering::ImageDrawer drawer(openGLStack, *texture);
+					drawer.setColour(juce::Colours::white);
+					drawer.drawAt({ -1.0f, 1.0f - textureHeight, textureWidth, textureHeight });
+				}
+
+				openGLStack.disable(GL_TEXTURE_2D);
+			}
+
+			void invalidate() noexcept { key.invalidate(); }
+
+			/// <summary>
+			/// Repaints a stale layer at most every this many frames, drawing the old one in between.
+			/// Resizing always repaints.
+			/// </summary>
+			void setRefreshInterval(std::size_t frames) noexcept { refreshInterval = std::max<std::size_t>(1, frames); }
+
+			/// <summary>
+			/// Deletes the texture. The OpenGL context must be current.
+			/// </summary>
+			void release()
+			{
+				texture.reset();
+				key.invalidate();
+			}
+
+		private:
+
+			template<typename Painter>
+			void rasterize(int pixelWidth, int pixelHeight, double scale, Painter& paint)
+			{
+				const int textureWidth = juce::nextPowerOfTwo(pixelWidth);
+				const int textureHeight = juce::nextPowerOfTwo(pixelHeight);
+
+				if (image.isNull() || image.getWidth() != textureWidth || image.getHeight() != textureHeight)
+					image = juce::Image(juce::Image::ARGB, textureWidth, textureHeight, true);
+				else
+					image.clear(image.getBounds());
+
+				{
+					juce::Graphics g(image);
+					g.reduceClipRegion(0, 0, pixelWidth, pixelHeight);
+					g.addTransform(juce::AffineTransform::scale(static_cast<float>(scale)));
+					paint(g);
+				}
+
+				if (!texture)
+					texture.reset(new juce::OpenGLTexture());
+
+				texture->loadImage(image);
+
+				imageWidth = pixelWidth;
+				imageHeight = pixelHeight;
+			}
+
+			CacheKey key;
+			juce::Image image;
+			std::unique_ptr<juce::OpenGLTexture> texture;
+			int imageWidth = 0, imageHeight = 0;
+			std::size_t refreshInterval = 1, framesSinceRaster = 0;
+		};
+	};
+
+#endif
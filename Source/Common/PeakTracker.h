@@ -0,0 +1,223 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:PeakTracker.h
+
+		Running absolute peak over a sliding window, maintained as audio is written
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_PEAKTRACKER_H
+	#define SIGNALIZER_PEAKTRACKER_H
+
+	#include "SignalizerConfiguration.h"
+	#include <cpl/simd.h>
+	#include <vector>
+	#include <algorithm>
+	#include <cmath>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Tracks the absolute peak of the last window of samples written to it.
+		/// Samples are reduced to block maxima, which are kept in a monotonic queue
+		/// so writing is amortized O(1) per block and reading the peak is O(1).
+		/// Not thread safe.
+		/// </summary>
+		class PeakTracker
+		{
+		public:
+
+			static constexpr std::size_t BlockSize = 256;
+
+			/// <summary>
+			/// Sets the size of the window in samples, rounded up to whole blocks.
+			/// Resets the tracker if it changed.
+			/// </summary>
+			void setWindow(std::size_t samples)
+			{
+				const auto blocks = std::max<std::size_t>(1, (samples + BlockSize - 1) / BlockSize);
+
+				if (blocks == windowBlocks)
+					return;
+
+				windowBlocks = blocks;
+				queue.resize(windowBlocks + 1);
+				reset();
+			}
+
+			void reset() noexcept
+			{
+				first = count = 0;
+				blockIndex = 0;
+				blockFill = 0;
+				blockPeak = 0;
+			}
+
+			/// <summary>
+			/// Returns the largest absolute sample in the window.
+			/// </summary>
+			AFloat getPeak() const noexcept
+			{
+				return count ? std::max(queue[first].peak, blockPeak) : blockPeak;
+			}
+
+			/// <summary>
+			/// Tracks the absolute value of the samples.
+			/// </summary>
+			template<typename ISA>
+			void write(const AFloat* samples, std::size_t numSamples)
+			{
+				process<ISA>(
+					numSamples,
+					[=](std::size_t n) { return cpl::simd::loadu<typename ISA::V>(samples + n); },
+					[=](std::size_t n) { return samples[n]; }
+				);
+			}
+
+			/// <summary>
+			/// Tracks the absolute value of half the binary function of the samples, ie. mid or side signals.
+			/// </summary>
+			template<typename ISA, typename BinaryFunction>
+			void write(const AFloat* left, const AFloat* right, std::size_t numSamples, BinaryFunction f)
+			{
+				using cpl::simd::loadu;
+				typedef typename ISA::V V;
+
+				process<ISA>(
+					numSamples,
+					[=](std::size_t n) { return cpl::simd::consts<V>::half * f(loadu<V>(left + n), loadu<V>(right + n)); },
+					[=](std::size_t n) { return static_cast<AFloat>(0.5) * f(left[n], right[n]); }
+				);
+			}
+
+			/// <summary>
+			/// Tracks samples known to be zero, without reading them.
+			/// Runs longer than the window only cost as much as the window.
+			/// </summary>
+			void writeSilence(std::size_t numSamples) noexcept
+			{
+				if (!windowBlocks)
+					return;
+
+				const auto chunk = std::min(numSamples, BlockSize - blockFill);
+				blockFill += chunk;
+				numSamples -= chunk;
+
+				if (blockFill < BlockSize)
+					return;
+
+				pushBlock(blockPeak);
+				blockPeak = 0;
+				blockFill = numSamples % BlockSize;
+
+				const auto blocks = numSamples / BlockSize;
+				// after a window of zeroes, the queue only holds the newest one
+				const auto pushed = std::min<std::size_t>(blocks, windowBlocks + 1);
+
+				for (std::size_t i = 0; i < pushed; ++i)
+					pushBlock(0);
+
+				blockIndex += blocks - pushed;
+			}
+
+		private:
+
+			struct Block
+			{
+				std::uint64_t index;
+				AFloat peak;
+			};
+
+			template<typename ISA, typename VectorLoad, typename ScalarLoad>
+			void process(std::size_t numSamples, VectorLoad vectorLoad, ScalarLoad scalarLoad)
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				constexpr std::size_t lanes = elements_of<V>::value;
+				const V vSign = consts<V>::sign_mask;
+
+				if (!windowBlocks)
+					return;
+
+				for (std::size_t n = 0; n < numSamples;)
+				{
+					const auto chunk = std::min(numSamples - n, BlockSize - blockFill);
+					const auto end = n + chunk;
+					const auto stop = n + chunk - (chunk & (lanes - 1));
+
+					V vMax = zero<V>();
+					std::size_t i = n;
+
+					for (; i < stop; i += lanes)
+						vMax = max(vand(vectorLoad(i), vSign), vMax);
+
+					suitable_container<V> lanesMax = vMax;
+					auto peak = std::max(blockPeak, *std::max_element(lanesMax.begin(), lanesMax.end()));
+
+					for (; i < end; ++i)
+						peak = std::max(peak, std::abs(scalarLoad(i)));
+
+					blockPeak = peak;
+					blockFill += chunk;
+					n = end;
+
+					if (blockFill == BlockSize)
+					{
+						pushBlock(blockPeak);
+						blockPeak = 0;
+						blockFill = 0;
+					}
+				}
+			}
+
+			void pushBlock(AFloat peak) noexcept
+			{
+				const auto capacity = queue.size();
+
+				// older blocks that aren't larger can never be the peak again
+				while (count && queue[(first + count - 1) % capacity].peak <= peak)
+					count--;
+
+				queue[(first + count) % capacity] = { blockIndex, peak };
+				count++;
+
+				// expire blocks that left the window
+				while (queue[first].index + windowBlocks <= blockIndex)
+				{
+					first = (first + 1) % capacity;
+					count--;
+				}
+
+				blockIndex++;
+			}
+
+			std::vector<Block> queue;
+			std::size_t first = 0, count = 0, windowBlocks = 0, blockFill = 0;
+			std::uint64_t blockIndex = 0;
+			AFloat blockPeak = 0;
+		};
+	};
+
+#endif
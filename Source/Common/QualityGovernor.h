@@ -0,0 +1,159 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:QualityGovernor.h
+
+		Steps rendering quality down and up again, depending on how much of the frame budget is used
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_QUALITYGOVERNOR_H
+	#define SIGNALIZER_QUALITYGOVERNOR_H
+
+	#include <cstddef>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Watches the time spent rendering frames against the time between them, and lowers the quality level
+		/// when rendering takes up most of the frame, or the frame rate drops too low while rendering is a large part of it.
+		/// The quality is raised again once there's plenty of headroom for a while. The thresholds are far apart,
+		/// and every change waits for the timings to settle, so the level doesn't oscillate.
+		/// Views read the level every frame, and decide what each step means for them.
+		/// Not thread safe.
+		/// </summary>
+		class QualityGovernor
+		{
+		public:
+
+			/// <summary>
+			/// Every level includes the reductions of the ones before it.
+			/// </summary>
+			enum Level
+			{
+				Full,
+				NoMultisampling,
+				LinearInterpolation,
+				ReducedResolution,
+				ReducedDensity,
+				ReducedOverlay,
+				Minimal = ReducedOverlay
+			};
+
+			/// <summary>
+			/// Call after every rendered frame, with the time it took and the time since the previous one.
+			/// Returns true if the level changed.
+			/// </summary>
+			bool update(double frameTime, double delta)
+			{
+				if (!(delta > 0) || !(frameTime >= 0))
+					return false;
+
+				averageFrame += Smoothing * (frameTime - averageFrame);
+				averageDelta += Smoothing * (delta - averageDelta);
+
+				// let the averages catch up with the last change
+				if (settleFrames > 0)
+				{
+					settleFrames--;
+					return false;
+				}
+
+				const auto usage = averageFrame / averageDelta;
+				const bool overBudget = usage > OverBudgetUsage || (averageDelta > MaxDelta && usage > HeadroomUsage);
+				const bool hasHeadroom = usage < HeadroomUsage && averageDelta < MaxDelta;
+
+				pressure = overBudget ? pressure + 1 : 0;
+				relief = hasHeadroom ? relief + 1 : 0;
+
+				if (pressure > StepDownFrames && level < Minimal)
+				{
+					setLevel(static_cast<Level>(level + 1));
+					return true;
+				}
+
+				if (relief > StepUpFrames && level > Full)
+				{
+					setLevel(static_cast<Level>(level - 1));
+					return true;
+				}
+
+				return false;
+			}
+
+			/// <summary>
+			/// Returns true if the reductions of the level are in effect.
+			/// </summary>
+			bool isReduced(Level step) const noexcept { return level >= step; }
+
+			Level getLevel() const noexcept { return level; }
+
+			const char* getLevelName() const noexcept
+			{
+				switch (level)
+				{
+					default: case Full: return "full";
+					case NoMultisampling: return "no multisampling";
+					case LinearInterpolation: return "linear interpolation";
+					case ReducedResolution: return "reduced resolution";
+					case ReducedDensity: return "reduced density";
+					case ReducedOverlay: return "reduced overlay";
+				}
+			}
+
+			/// <summary>
+			/// Restores full quality, f.ex. when the context is recreated.
+			/// </summary>
+			void reset() noexcept
+			{
+				setLevel(Full);
+				averageFrame = averageDelta = 0;
+			}
+
+		private:
+
+			void setLevel(Level newLevel) noexcept
+			{
+				level = newLevel;
+				pressure = relief = 0;
+				settleFrames = SettleFrames;
+			}
+
+			static constexpr double Smoothing = 0.05;
+			/// <summary>
+			/// Fractions of the frame spent rendering.
+			/// </summary>
+			static constexpr double OverBudgetUsage = 0.85, HeadroomUsage = 0.4;
+			/// <summary>
+			/// Frame rates below 30 fps count as over budget, if rendering is part of the reason.
+			/// </summary>
+			static constexpr double MaxDelta = 1.0 / 30;
+			static constexpr std::size_t StepDownFrames = 30, StepUpFrames = 300, SettleFrames = 60;
+
+			Level level = Full;
+			double averageFrame = 0, averageDelta = 0;
+			std::size_t pressure = 0, relief = 0, settleFrames = 0;
+		};
+	};
+
+#endif
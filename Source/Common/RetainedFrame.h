@@ -0,0 +1,184 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:RetainedFrame.h
+
+		Copy of the last rendered frame, presented again when nothing has changed
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_RETAINEDFRAME_H
+	#define SIGNALIZER_RETAINEDFRAME_H
+
+	#include "CachedGeometry.h"
+	#include <cpl/rendering/OpenGLRasterizers.h>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Render on demand: once a frame has been rendered, it is copied into a texture. As long as nothing changes,
+		/// that copy is drawn instead of rendering the whole view again, which is a single textured quad.
+		/// The copy is taken after rendering to the screen (instead of rendering into a framebuffer object),
+		/// so the frame keeps any multisampling of the window.
+		/// Must only be used on the OpenGL thread. Call release() before the context goes away.
+		/// </summary>
+		class RetainedFrame
+		{
+		public:
+
+			/// <summary>
+			/// Returns true if the frame has to be rendered, and retain() should be called afterwards.
+			/// This is the case if anything changed, the key changed, or there is no retained frame of the current size.
+			/// Otherwise, the retained frame was presented and the frame should be skipped.
+			/// The key should hold whatever the views read every frame without being notified, like the size of the view.
+			/// </summary>
+			bool begin(bool hasChanged, std::initializer_list<double> values)
+			{
+				GLint viewport[4];
+				glGetIntegerv(GL_VIEWPORT, viewport);
+
+				hasChanged |= key.update(values);
+				hasChanged |= !isRetained || viewport[2] != width || viewport[3] != height;
+
+				if (hasChanged)
+				{
+					isRetained = false;
+					return true;
+				}
+
+				present();
+				return false;
+			}
+
+			/// <summary>
+			/// Copies the frame that was just rendered.
+			/// </summary>
+			void retain()
+			{
+				GLint viewport[4];
+				glGetIntegerv(GL_VIEWPORT, viewport);
+
+				if (viewport[2] <= 0 || viewport[3] <= 0)
+					return;
+
+				// errors left by the rendering aren't ours, and would otherwise be read below
+				for (int i = 0; i < MaxPendingErrors; ++i)
+				{
+					if (glGetError() == GL_NO_ERROR)
+						break;
+				}
+
+				if (!texture)
+					glGenTextures(1, &texture);
+
+				glBindTexture(GL_TEXTURE_2D, texture);
+
+				width = viewport[2];
+				height = viewport[3];
+
+				// padded to powers of two like the overlay, with the frame in the bottom left corner
+				const GLint paddedWidth = juce::nextPowerOfTwo(width);
+				const GLint paddedHeight = juce::nextPowerOfTwo(height);
+
+				if (paddedWidth != textureWidth || paddedHeight != textureHeight)
+				{
+					textureWidth = paddedWidth;
+					textureHeight = paddedHeight;
+
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				}
+
+				glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], width, height);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				// if the frame can't be read back (f.ex. from a multisampled framebuffer object), just keep rendering
+				isRetained = glGetError() == GL_NO_ERROR;
+			}
+
+			/// <summary>
+			/// Makes the next frame render.
+			/// </summary>
+			void invalidate() noexcept { isRetained = false; }
+
+			/// <summary>
+			/// Deletes the texture. The OpenGL context must be current.
+			/// </summary>
+			void release()
+			{
+				if (texture)
+					glDeleteTextures(1, &texture);
+
+				texture = 0;
+				width = height = 0;
+				textureWidth = textureHeight = 0;
+				isRetained = false;
+				key.invalidate();
+			}
+
+		private:
+
+			void present()
+			{
+				cpl::OpenGLRendering::COpenGLStack openGLStack;
+				cpl::OpenGLRendering::MatrixModification m;
+				m.loadIdentityMatrix();
+
+				openGLStack.enable(GL_TEXTURE_2D);
+				// a straight copy, replacing whatever was there
+				openGLStack.setBlender(GL_ONE, GL_ZERO);
+
+				glBindTexture(GL_TEXTURE_2D, texture);
+				glColor4f(1, 1, 1, 1);
+
+				const auto u = static_cast<GLfloat>(width) / textureWidth;
+				const auto v = static_cast<GLfloat>(height) / textureHeight;
+
+				glBegin(GL_QUADS);
+				glTexCoord2f(0, 0); glVertex2f(-1, -1);
+				glTexCoord2f(u, 0); glVertex2f(1, -1);
+				glTexCoord2f(u, v); glVertex2f(1, 1);
+				glTexCoord2f(0, v); glVertex2f(-1, 1);
+				glEnd();
+
+				glBindTexture(GL_TEXTURE_2D, 0);
+				openGLStack.disable(GL_TEXTURE_2D);
+			}
+
+			/// <summary>
+			/// Without a current context, glGetError() may never return GL_NO_ERROR.
+			/// </summary>
+			static constexpr int MaxPendingErrors = 32;
+
+			CacheKey key;
+			GLuint texture = 0;
+			GLint width = 0, height = 0;
+			GLint textureWidth = 0, textureHeight = 0;
+			bool isRetained = false;
+		};
+	};
+
+#endif
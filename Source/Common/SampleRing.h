@@ -0,0 +1,216 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2021 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:SampleRing.h
+
+		Wait-free single producer / single consumer rings of samples, stamped with
+		the timeline of the blocks they were written in.
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_SAMPLERING_H
+	#define SIGNALIZER_SAMPLERING_H
+
+	#include <cpl/Common.h>
+	#include <cpl/simd.h>
+	#include <atomic>
+	#include <array>
+	#include <algorithm>
+	#include <cstdint>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Fixed size ring of samples, addressed by absolute positions that only ever grow.
+		/// The producer writes wherever it is, and never waits for the consumer: a consumer that falls more than
+		/// half the capacity behind has lost the data, which it can tell from the positions (see <see cref="BlockTimeline"/>).
+		/// Positions are published by a <see cref="BlockTimeline"/>, so the ring itself has no synchronization.
+		/// </summary>
+		template<typename T>
+		class SampleRing
+		{
+		public:
+
+			/// <summary>
+			/// Allocates and clears storage for at least this many samples, rounded up to a power of two.
+			/// Not thread safe.
+			/// </summary>
+			void resize(std::size_t minimumCapacity)
+			{
+				const auto capacity = cpl::Math::nextPow2(std::max<std::size_t>(minimumCapacity, 2));
+				storage.assign(capacity, T());
+				mask = capacity - 1;
+			}
+
+			std::size_t capacity() const noexcept { return storage.size(); }
+
+			/// <summary>
+			/// The samples behind the newest position that can be read safely, while the producer is writing the next block.
+			/// </summary>
+			std::size_t history() const noexcept { return storage.size() / 2; }
+
+			/// <summary>
+			/// Writes samples to [position, position + numSamples). Only the last <see cref="history"/> samples of a bigger block are kept.
+			/// </summary>
+			void write(std::int64_t position, const T* source, std::size_t numSamples) noexcept
+			{
+				if (numSamples > history())
+				{
+					const auto skip = numSamples - history();
+					source += skip;
+					position += skip;
+					numSamples -= skip;
+				}
+
+				copy(position, numSamples, [&](std::size_t index, std::size_t offset, std::size_t count) { std::copy(source + offset, source + offset + count, storage.data() + index); });
+			}
+
+			/// <summary>
+			/// Reads samples from [position, position + numSamples), which must have been published.
+			/// </summary>
+			void read(std::int64_t position, T* destination, std::size_t numSamples) const noexcept
+			{
+				copy(position, numSamples, [&](std::size_t index, std::size_t offset, std::size_t count) { std::copy(storage.data() + index, storage.data() + index + count, destination + offset); });
+			}
+
+			/// <summary>
+			/// Where the sample at the position is stored. It is followed by <see cref="contiguous"/> samples before the ring wraps.
+			/// </summary>
+			const T* at(std::int64_t position) const noexcept { return storage.data() + (static_cast<std::size_t>(position) & mask); }
+			std::size_t contiguous(std::int64_t position) const noexcept { return storage.size() - (static_cast<std::size_t>(position) & mask); }
+
+		private:
+
+			template<typename Function>
+			void copy(std::int64_t position, std::size_t numSamples, Function f) const noexcept
+			{
+				const auto start = static_cast<std::size_t>(position) & mask;
+				const auto first = std::min(numSamples, storage.size() - start);
+
+				f(start, 0, first);
+
+				if (first < numSamples)
+					f(0, first, numSamples - first);
+			}
+
+			cpl::aligned_vector<T, 32> storage;
+			std::size_t mask = 0;
+		};
+
+		/// <summary>
+		/// The write position of one producer, shared by all its <see cref="SampleRing"/>s, together with a stamp of the
+		/// host timeline for each published block. The producer is wait-free, and the consumer never blocks it.
+		/// </summary>
+		class BlockTimeline
+		{
+		public:
+
+			struct Stamp
+			{
+				/// <summary>
+				/// The first position in the rings written by the block.
+				/// </summary>
+				std::int64_t position;
+				/// <summary>
+				/// The host timeline position in samples, at the start of the block.
+				/// </summary>
+				std::int64_t timeline;
+				std::int64_t numSamples;
+				bool isPlaying;
+
+				/// <summary>
+				/// The end of everything published up to and including this block.
+				/// </summary>
+				std::int64_t end() const noexcept { return position + numSamples; }
+
+				/// <summary>
+				/// The ring position of a timeline position, assuming the timeline is contiguous around this block.
+				/// </summary>
+				std::int64_t positionOf(std::int64_t timelinePosition) const noexcept { return position + (timelinePosition - timeline); }
+				std::int64_t timelineOf(std::int64_t ringPosition) const noexcept { return timeline + (ringPosition - position); }
+			};
+
+			/// <summary>
+			/// Where the producer writes the next block. Only for the producer.
+			/// </summary>
+			std::int64_t getWritePosition() const noexcept { return writePosition; }
+
+			/// <summary>
+			/// Publishes a block of samples written to the rings at <see cref="getWritePosition"/>.
+			/// </summary>
+			void publish(std::int64_t timelinePosition, std::size_t numSamples, bool isPlaying) noexcept
+			{
+				const auto index = published.load(std::memory_order_relaxed);
+				auto& slot = stamps[index % stamps.size()];
+
+				slot.position.store(writePosition, std::memory_order_relaxed);
+				slot.timeline.store(timelinePosition, std::memory_order_relaxed);
+				slot.numSamples.store(static_cast<std::int64_t>(numSamples), std::memory_order_relaxed);
+				slot.isPlaying.store(isPlaying, std::memory_order_relaxed);
+
+				writePosition += numSamples;
+				published.store(index + 1, std::memory_order_release);
+			}
+
+			/// <summary>
+			/// Reads the stamp of the newest published block. Returns false if nothing was published yet.
+			/// </summary>
+			bool latest(Stamp& stamp) const noexcept
+			{
+				for (;;)
+				{
+					const auto index = published.load(std::memory_order_acquire);
+
+					if (index == 0)
+						return false;
+
+					auto& slot = stamps[(index - 1) % stamps.size()];
+
+					stamp.position = slot.position.load(std::memory_order_relaxed);
+					stamp.timeline = slot.timeline.load(std::memory_order_relaxed);
+					stamp.numSamples = slot.numSamples.load(std::memory_order_relaxed);
+					stamp.isPlaying = slot.isPlaying.load(std::memory_order_relaxed);
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					// the slot is only reused after the producer went all the way around, which needs another try
+					if (published.load(std::memory_order_relaxed) - index < stamps.size() - 1)
+						return true;
+				}
+			}
+
+		private:
+
+			struct Slot
+			{
+				std::atomic<std::int64_t> position {}, timeline {}, numSamples {};
+				std::atomic<bool> isPlaying {};
+			};
+
+			std::array<Slot, 16> stamps;
+			std::atomic<std::uint64_t> published {};
+			std::int64_t writePosition = 0;
+		};
+	};
+
+#endif
@@ -42,6 +42,11 @@ namespace Signalizer
 			hideWidgetsOnMouseExit = false,
 			stopProcessingOnSuspend = false,
 			showLegend = false;
+
+		/// <summary>
+		/// Measured seconds between presented frames of the editor.
+		/// </summary>
+		cpl::relaxed_atomic<double> frameInterval = 1.0 / 60;
 	};
 };
 
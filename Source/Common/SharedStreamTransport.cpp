@@ -0,0 +1,716 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2021 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:SharedStreamTransport.cpp
+
+		Implementation of SharedStreamTransport.h
+
+*************************************************************************************/
+
+#include "SharedStreamTransport.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace Signalizer
+{
+	namespace SharedStream
+	{
+		// every process sharing segments must agree on these, bump the layout on any change
+		constexpr std::uint32_t Magic = 0x53475a53; // "SGZS"
+		constexpr std::uint32_t Layout = 4;
+		constexpr std::size_t MaxEntries = 256;
+		/// <summary>
+		/// Publishers refresh their heartbeat every block, entries older than this are considered dead.
+		/// Segments nobody leased for this long are released.
+		/// </summary>
+		constexpr juce::int64 StaleMilliseconds = 10000;
+		/// <summary>
+		/// How long a renewed lease lasts, a few maintenance intervals so a busy message thread doesn't interrupt the stream.
+		/// </summary>
+		constexpr juce::int64 LeaseMilliseconds = 4 * MaintenanceInterval;
+
+		static_assert(std::atomic<std::int64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+			"Atomics in shared memory must be lock free to be shared between processes");
+
+		struct StreamHeader
+		{
+			std::uint32_t magic, layout;
+			/// <summary>
+			/// The rings in the segment, set before it is announced.
+			/// </summary>
+			std::uint32_t allocatedChannels;
+			std::atomic<std::uint32_t> channels;
+			BlockTimeline timeline;
+			// followed by allocatedChannels rings of Capacity samples, at SampleOffset
+		};
+
+		constexpr std::size_t SampleOffset = (sizeof(StreamHeader) + 63) & ~std::size_t(63);
+
+		static constexpr std::size_t segmentSizeFor(std::size_t channels)
+		{
+			return SampleOffset + channels * Capacity * sizeof(AFloat);
+		}
+
+		struct RegistryEntry
+		{
+			enum State : std::uint32_t { Free, Claimed };
+
+			std::atomic<std::uint32_t> state;
+			/// <summary>
+			/// Odd while the contents are being written, readers retry until it's the same even number before and after.
+			/// </summary>
+			std::atomic<std::uint32_t> sequence;
+			std::atomic<std::int64_t> heartbeat;
+			/// <summary>
+			/// Extended by subscribers while they read. The publisher only writes while it hasn't run out.
+			/// </summary>
+			std::atomic<std::int64_t> lease;
+			/// <summary>
+			/// The publisher holding the entry, only it writes to it.
+			/// </summary>
+			std::atomic<std::uint64_t> owner;
+			std::uint8_t key[16];
+			std::uint8_t process[16];
+			std::int32_t channels;
+			/// <summary>
+			/// Empty while there is no segment.
+			/// </summary>
+			char segment[48];
+			char name[64];
+		};
+
+		struct Registry
+		{
+			std::uint32_t magic, layout;
+			RegistryEntry entries[MaxEntries];
+		};
+
+		struct EntryContents
+		{
+			Key key;
+			std::uint8_t process[16];
+			std::int32_t channels;
+			char segment[48];
+			char name[64];
+		};
+
+		static juce::File getDirectory()
+		{
+			return juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("Signalizer-streams");
+		}
+
+		static const juce::Uuid& getProcessToken()
+		{
+			static const juce::Uuid token;
+			return token;
+		}
+
+		static juce::int64 now()
+		{
+			return juce::Time::currentTimeMillis();
+		}
+
+		/// <summary>
+		/// Serializes creating and mapping files between processes.
+		/// </summary>
+		static juce::InterProcessLock& getFileLock()
+		{
+			static juce::InterProcessLock lock("Signalizer-streams");
+			return lock;
+		}
+
+		/// <summary>
+		/// Maps a file of at least the size, creating it zeroed if needed. The caller must hold the interprocess lock.
+		/// </summary>
+		static std::unique_ptr<juce::MemoryMappedFile> map(const juce::File& file, std::size_t size, bool create)
+		{
+			if (create && (!file.existsAsFile() || file.getSize() < static_cast<juce::int64>(size)))
+			{
+				file.getParentDirectory().createDirectory();
+
+				juce::MemoryBlock zeroes(size, true);
+
+				if (!file.replaceWithData(zeroes.getData(), zeroes.getSize()))
+					return nullptr;
+			}
+
+			std::unique_ptr<juce::MemoryMappedFile> ret(new juce::MemoryMappedFile(file, juce::MemoryMappedFile::readWrite));
+
+			if (!ret->getData() || ret->getSize() < size)
+				return nullptr;
+
+			return ret;
+		}
+
+		/// <summary>
+		/// The registry of this machine, mapped for the lifetime of the process. Null if it couldn't be created.
+		/// </summary>
+		static Registry* getRegistry()
+		{
+			static std::unique_ptr<juce::MemoryMappedFile> mapping;
+			static std::once_flag flag;
+
+			std::call_once(flag, []
+			{
+				const juce::InterProcessLock::ScopedLockType scope(getFileLock());
+
+				// named by the layout, so processes of other versions keep to themselves instead of locking each other out
+				mapping = map(getDirectory().getChildFile("registry-" + juce::String(Layout) + ".shm"), sizeof(Registry), true);
+
+				if (!mapping)
+					return;
+
+				// a zeroed registry is valid and empty, only a different layout is not
+				auto registry = static_cast<Registry*>(mapping->getData());
+
+				if (registry->magic == 0)
+				{
+					registry->magic = Magic;
+					registry->layout = Layout;
+				}
+				else if (registry->magic != Magic || registry->layout != Layout)
+				{
+					mapping.reset();
+				}
+			});
+
+			return mapping ? static_cast<Registry*>(mapping->getData()) : nullptr;
+		}
+
+		static bool read(const RegistryEntry& entry, EntryContents& contents)
+		{
+			for (int attempts = 0; attempts < 64; ++attempts)
+			{
+				if (entry.state.load(std::memory_order_acquire) != RegistryEntry::Claimed)
+					return false;
+
+				const auto before = entry.sequence.load(std::memory_order_acquire);
+
+				if (before & 1)
+					continue;
+
+				std::memcpy(contents.key.data(), entry.key, sizeof(entry.key));
+				std::memcpy(contents.process, entry.process, sizeof(entry.process));
+				contents.channels = entry.channels;
+				std::memcpy(contents.segment, entry.segment, sizeof(entry.segment));
+				std::memcpy(contents.name, entry.name, sizeof(entry.name));
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (entry.sequence.load(std::memory_order_relaxed) == before && before != 0)
+				{
+					contents.segment[sizeof(contents.segment) - 1] = '\0';
+					contents.name[sizeof(contents.name) - 1] = '\0';
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		/// <summary>
+		/// Whether the entry holds a live stream of another process.
+		/// </summary>
+		static bool isLivePeer(const RegistryEntry& entry, EntryContents& contents)
+		{
+			if (!read(entry, contents) || entry.heartbeat.load(std::memory_order_relaxed) < now() - StaleMilliseconds)
+				return false;
+
+			return std::memcmp(contents.process, getProcessToken().getRawData(), sizeof(contents.process)) != 0;
+		}
+
+		/// <summary>
+		/// Calls the function with the contents and index of every live entry of another process, until it returns true.
+		/// </summary>
+		template<typename Function>
+		static bool findPeer(Function f)
+		{
+			auto registry = getRegistry();
+
+			if (!registry)
+				return false;
+
+			for (std::size_t i = 0; i < MaxEntries; ++i)
+			{
+				EntryContents contents;
+
+				if (!isLivePeer(registry->entries[i], contents))
+					continue;
+
+				if (f(contents, i))
+					return true;
+			}
+
+			return false;
+		}
+
+		std::vector<Peer> discover()
+		{
+			std::vector<Peer> ret;
+
+			findPeer(
+				[&](const EntryContents& c, std::size_t)
+				{
+					ret.push_back({ c.key, c.name, c.channels });
+					return false;
+				}
+			);
+
+			return ret;
+		}
+
+		bool isPublished(const Key& key)
+		{
+			return findPeer([&](const EntryContents& c, std::size_t) { return c.key == key; });
+		}
+
+		/// <summary>
+		/// Maintains every publisher of the process on the message thread, alive while any of them is published.
+		/// </summary>
+		class Maintenance : private juce::Timer
+		{
+		public:
+
+			static std::shared_ptr<Maintenance> acquire()
+			{
+				static std::mutex mutex;
+				static std::weak_ptr<Maintenance> current;
+
+				std::lock_guard<std::mutex> lock(mutex);
+
+				auto shared = current.lock();
+
+				if (!shared)
+				{
+					shared = std::make_shared<Maintenance>();
+					current = shared;
+				}
+
+				return shared;
+			}
+
+			Maintenance()
+			{
+				startTimer(MaintenanceInterval);
+			}
+
+			~Maintenance()
+			{
+				stopTimer();
+			}
+
+			void add(Publisher* p)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (std::find(publishers.begin(), publishers.end(), p) == publishers.end())
+					publishers.push_back(p);
+			}
+
+			void remove(Publisher* p)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				publishers.erase(std::remove(publishers.begin(), publishers.end(), p), publishers.end());
+			}
+
+		private:
+
+			void timerCallback() override
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				for (auto p : publishers)
+					p->maintain();
+			}
+
+			std::mutex mutex;
+			std::vector<Publisher*> publishers;
+		};
+
+		Publisher::Publisher()
+			: claim(static_cast<std::uint64_t>(juce::Random::getSystemRandom().nextInt64()) | 1)
+		{
+		}
+
+		Publisher::~Publisher()
+		{
+			withdraw();
+		}
+
+		void Publisher::publish(const Key& keyToUse, const std::string& nameToUse, int numChannels)
+		{
+			if (!getRegistry())
+				return;
+
+			// outside of the lock, the maintenance takes it with its own held
+			if (!maintenance)
+			{
+				maintenance = Maintenance::acquire();
+				maintenance->add(this);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				key = keyToUse;
+				name = nameToUse;
+				channels = numChannels;
+
+				if (registrySlot < 0 && !claimEntry())
+					return;
+
+				announce();
+			}
+
+			// a subscriber might already be waiting
+			maintain();
+		}
+
+		bool Publisher::claimEntry()
+		{
+			auto entries = getRegistry()->entries;
+			int slot = -1;
+
+			for (std::size_t i = 0; i < MaxEntries && slot < 0; ++i)
+			{
+				auto state = static_cast<std::uint32_t>(RegistryEntry::Free);
+
+				if (entries[i].state.compare_exchange_strong(state, RegistryEntry::Claimed))
+				{
+					entries[i].owner.store(claim);
+					slot = static_cast<int>(i);
+				}
+			}
+
+			// full: take over an entry of a process that went away without withdrawing.
+			// the owner is swapped atomically, so only one process can take it over
+			const auto stale = now() - StaleMilliseconds;
+
+			for (std::size_t i = 0; i < MaxEntries && slot < 0; ++i)
+			{
+				auto owner = entries[i].owner.load();
+
+				if (entries[i].heartbeat.load() < stale && entries[i].owner.compare_exchange_strong(owner, claim))
+					slot = static_cast<int>(i);
+			}
+
+			if (slot < 0)
+				return false;
+
+			entries[slot].heartbeat.store(now());
+			// whoever leased the previous stream of this entry doesn't care for this one
+			entries[slot].lease.store(0);
+
+			// the registry is read by the audio thread once it sees the slot
+			registry.store(getRegistry());
+			registrySlot.store(slot);
+			return true;
+		}
+
+		bool Publisher::isOwner(int slot) const noexcept
+		{
+			auto cached = registry.load(std::memory_order_relaxed);
+			return cached && slot >= 0 && cached->entries[slot].owner.load(std::memory_order_relaxed) == claim;
+		}
+
+		void Publisher::withdraw()
+		{
+			if (maintenance)
+			{
+				maintenance->remove(this);
+				maintenance.reset();
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			const auto slot = registrySlot.exchange(-1);
+
+			// taken over by another process, if it thought this one was dead
+			if (isOwner(slot))
+			{
+				auto& entry = registry.load()->entries[slot];
+				auto owner = claim;
+
+				if (entry.owner.compare_exchange_strong(owner, 0))
+					entry.state.store(RegistryEntry::Free, std::memory_order_release);
+			}
+
+			replaceSegment(nullptr, juce::File());
+		}
+
+		void Publisher::maintain()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto slot = registrySlot.load();
+
+			if (slot < 0)
+				return;
+
+			if (!isOwner(slot))
+			{
+				// this process stalled for long enough to be considered dead, so the entry is gone. subscribers reopen by the key
+				registrySlot.store(-1);
+				replaceSegment(nullptr, juce::File());
+
+				if (!claimEntry())
+					return;
+
+				slot = registrySlot.load();
+				announce();
+			}
+
+			auto& entry = registry.load()->entries[slot];
+
+			// the audio thread doesn't run while the host is idle, but the stream is still there
+			entry.heartbeat.store(now(), std::memory_order_relaxed);
+
+			const auto lease = entry.lease.load(std::memory_order_relaxed);
+			const auto wanted = static_cast<std::uint32_t>(std::clamp<int>(channels, 1, static_cast<int>(MaxChannels)));
+			const auto current = header.load(std::memory_order_relaxed);
+
+			if (lease > now())
+			{
+				if (current && current->allocatedChannels >= wanted)
+					return;
+
+				// a new file every time, so subscribers of the old segment can tell
+				const auto newFile = getDirectory().getChildFile(juce::Uuid().toString() + ".shm");
+				std::unique_ptr<juce::MemoryMappedFile> newMapping;
+
+				{
+					const juce::InterProcessLock::ScopedLockType scope(getFileLock());
+					newMapping = map(newFile, segmentSizeFor(wanted), true);
+				}
+
+				if (!newMapping)
+					return;
+
+				auto segment = new (newMapping->getData()) StreamHeader();
+				segment->magic = Magic;
+				segment->layout = Layout;
+				segment->allocatedChannels = wanted;
+
+				replaceSegment(std::move(newMapping), newFile);
+				announce();
+			}
+			else if (current && lease < now() - StaleMilliseconds)
+			{
+				replaceSegment(nullptr, juce::File());
+				announce();
+			}
+		}
+
+		void Publisher::replaceSegment(std::unique_ptr<juce::MemoryMappedFile> newMapping, const juce::File& newFile)
+		{
+			header.store(newMapping ? static_cast<StreamHeader*>(newMapping->getData()) : nullptr);
+
+			// the audio thread reads the header after flagging itself, so from here on it can only see the new one
+			while (isWriting.load())
+				std::this_thread::yield();
+
+			if (mapping)
+			{
+				mapping.reset();
+				file.deleteFile();
+			}
+
+			mapping = std::move(newMapping);
+			file = newFile;
+		}
+
+		void Publisher::announce()
+		{
+			const auto slot = registrySlot.load();
+
+			if (!isOwner(slot))
+				return;
+
+			auto& entry = registry.load()->entries[slot];
+
+			entry.sequence.fetch_add(1, std::memory_order_acq_rel);
+
+			std::memcpy(entry.key, key.data(), sizeof(entry.key));
+			std::memcpy(entry.process, getProcessToken().getRawData(), sizeof(entry.process));
+			entry.channels = channels;
+			std::memset(entry.segment, 0, sizeof(entry.segment));
+			std::strncpy(entry.segment, mapping ? file.getFileName().toRawUTF8() : "", sizeof(entry.segment) - 1);
+			std::memset(entry.name, 0, sizeof(entry.name));
+			std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+			entry.heartbeat.store(now(), std::memory_order_relaxed);
+
+			entry.sequence.fetch_add(1, std::memory_order_release);
+		}
+
+		void Publisher::onStreamAudio(AudioStream::ListenerContext& source, AFloat** buffer, std::size_t numChannels, std::size_t numSamples)
+		{
+			// the registry is only created off the audio thread, and cached once an entry is claimed
+			const auto slot = registrySlot.load();
+
+			if (slot < 0 || !isOwner(slot))
+				return;
+
+			auto& entry = registry.load(std::memory_order_relaxed)->entries[slot];
+			const auto time = now();
+
+			entry.heartbeat.store(time, std::memory_order_relaxed);
+
+			// nobody's listening
+			if (entry.lease.load(std::memory_order_relaxed) < time)
+				return;
+
+			struct WritingScope
+			{
+				WritingScope(std::atomic<bool>& flag) : flag(flag) { flag.store(true); }
+				~WritingScope() { flag.store(false, std::memory_order_release); }
+				std::atomic<bool>& flag;
+			} scope(isWriting);
+
+			auto segment = header.load();
+
+			if (!segment)
+				return;
+
+			numChannels = std::min<std::size_t>(numChannels, segment->allocatedChannels);
+			segment->channels.store(static_cast<std::uint32_t>(numChannels), std::memory_order_relaxed);
+
+			auto samples = reinterpret_cast<AFloat*>(reinterpret_cast<char*>(segment) + SampleOffset);
+			const auto history = Capacity / 2;
+			auto position = segment->timeline.getWritePosition();
+
+			// only the last half of a big block can be read safely anyway
+			std::size_t skip = numSamples > history ? numSamples - history : 0;
+			position += skip;
+
+			for (std::size_t c = 0; c < numChannels; ++c)
+			{
+				auto ring = samples + c * Capacity;
+				const auto start = static_cast<std::size_t>(position) & (Capacity - 1);
+				const auto count = numSamples - skip;
+				const auto first = std::min(count, Capacity - start);
+
+				std::copy(buffer[c] + skip, buffer[c] + skip + first, ring + start);
+				std::copy(buffer[c] + skip + first, buffer[c] + skip + count, ring);
+			}
+
+			segment->timeline.publish(source.getPlayhead().getPositionInSamples(), numSamples, source.getPlayhead().isPlaying());
+		}
+
+		std::shared_ptr<Subscriber> Subscriber::open(const Key& key)
+		{
+			auto registry = getRegistry();
+			juce::String segmentName;
+			std::size_t slot = 0;
+
+			const bool found = findPeer(
+				[&](const EntryContents& c, std::size_t index)
+				{
+					if (c.key != key)
+						return false;
+
+					segmentName = c.segment;
+					slot = index;
+					return true;
+				}
+			);
+
+			if (!found)
+				return nullptr;
+
+			// asks the publisher for a segment, if it doesn't have one yet
+			registry->entries[slot].lease.store(now() + LeaseMilliseconds, std::memory_order_relaxed);
+
+			if (segmentName.isEmpty())
+				return nullptr;
+
+			std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+			{
+				const juce::InterProcessLock::ScopedLockType scope(getFileLock());
+				mapping = map(getDirectory().getChildFile(segmentName), SampleOffset, false);
+			}
+
+			if (!mapping)
+				return nullptr;
+
+			auto& header = *static_cast<StreamHeader*>(mapping->getData());
+
+			if (header.magic != Magic || header.layout != Layout || header.allocatedChannels > MaxChannels)
+				return nullptr;
+
+			if (mapping->getSize() < segmentSizeFor(header.allocatedChannels))
+				return nullptr;
+
+			return std::shared_ptr<Subscriber>(new Subscriber(std::move(mapping), header, key, slot, segmentName));
+		}
+
+		Subscriber::Subscriber(std::unique_ptr<juce::MemoryMappedFile> mappingToUse, StreamHeader& headerToUse, const Key& key, std::size_t slot, const juce::String& segment)
+			: mapping(std::move(mappingToUse))
+			, header(headerToUse)
+			, samples(reinterpret_cast<const AFloat*>(reinterpret_cast<const char*>(&headerToUse) + SampleOffset))
+			, key(key)
+			, slot(slot)
+			, segment(segment)
+		{
+		}
+
+		bool Subscriber::refresh()
+		{
+			auto registry = getRegistry();
+
+			if (!registry)
+				return false;
+
+			auto& entry = registry->entries[slot];
+			EntryContents contents;
+
+			if (!isLivePeer(entry, contents) || contents.key != key || segment != contents.segment)
+				return false;
+
+			entry.lease.store(now() + LeaseMilliseconds, std::memory_order_relaxed);
+			return true;
+		}
+
+		bool Subscriber::latest(BlockTimeline::Stamp& stamp) const noexcept
+		{
+			return header.timeline.latest(stamp);
+		}
+
+		std::size_t Subscriber::getNumChannels() const noexcept
+		{
+			return std::min<std::size_t>(header.channels.load(std::memory_order_relaxed), header.allocatedChannels);
+		}
+
+		void Subscriber::read(std::size_t channel, std::int64_t position, AFloat* destination, std::size_t numSamples) const noexcept
+		{
+			auto ring = samples + channel * Capacity;
+			const auto start = static_cast<std::size_t>(position) & (Capacity - 1);
+			const auto first = std::min(numSamples, Capacity - start);
+
+			std::copy(ring + start, ring + start + first, destination);
+			std::copy(ring, ring + (numSamples - first), destination + first);
+		}
+	}
+}
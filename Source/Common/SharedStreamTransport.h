@@ -0,0 +1,214 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2021 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:SharedStreamTransport.h
+
+		Publishes realtime audio streams in shared memory, so instances running in
+		other processes (sandboxed or bridged by the host) can be sidechained.
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_SHAREDSTREAMTRANSPORT_H
+	#define SIGNALIZER_SHAREDSTREAMTRANSPORT_H
+
+	#include "CommonSignalizer.h"
+	#include "SampleRing.h"
+	#include <array>
+	#include <atomic>
+	#include <memory>
+	#include <mutex>
+	#include <string>
+	#include <vector>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Streams are published in memory mapped files in a common temporary folder, one segment per stream holding
+		/// a ring of samples per channel and a <see cref="BlockTimeline"/>. A single registry segment lists the published
+		/// streams by the serialized handle of their host graph node, which is how other processes discover them.
+		/// Subscribers hold a lease in the registry entry of the stream, and a segment is only created and written to
+		/// while the lease is held, sized for the channels of the stream at the time.
+		/// Writing is wait-free, and readers never block the publishing audio thread, exactly like the rings of a MixGraphListener.
+		/// </summary>
+		namespace SharedStream
+		{
+			/// <summary>
+			/// The raw contents of a HostGraph::SerializedHandle.
+			/// </summary>
+			typedef std::array<std::uint8_t, 16> Key;
+
+			/// <summary>
+			/// The most channels a segment holds.
+			/// </summary>
+			constexpr std::size_t MaxChannels = MaxInputChannels;
+			/// <summary>
+			/// Samples per channel in a segment, a power of two. Half of it can be read safely behind the newest block.
+			/// </summary>
+			constexpr std::size_t Capacity = 1 << 13;
+			/// <summary>
+			/// How often subscribers renew their lease, and publishers check for new ones, in milliseconds.
+			/// </summary>
+			constexpr int MaintenanceInterval = 500;
+
+			struct Peer
+			{
+				Key key;
+				std::string name;
+				int channels;
+			};
+
+			/// <summary>
+			/// The streams published by other processes, that are still alive.
+			/// </summary>
+			std::vector<Peer> discover();
+
+			/// <summary>
+			/// Whether another process publishes a stream under the key.
+			/// </summary>
+			bool isPublished(const Key& key);
+
+			struct StreamHeader;
+			struct Registry;
+			class Maintenance;
+
+			/// <summary>
+			/// Copies the audio of the stream it listens to into a shared segment, while another process holds a lease on it.
+			/// publish() and withdraw() must not be called from the audio thread.
+			/// </summary>
+			class Publisher : public AudioStream::Listener
+			{
+			public:
+
+				Publisher();
+				~Publisher();
+
+				/// <summary>
+				/// Announces the stream under the key, or updates the announcement.
+				/// </summary>
+				void publish(const Key& key, const std::string& name, int channels);
+				void withdraw();
+
+				/// <summary>
+				/// Creates the segment once a subscriber asks for it, or again if the channels outgrew it,
+				/// and releases it once nobody has asked for a while. Called periodically, never from the audio thread.
+				/// </summary>
+				void maintain();
+
+			private:
+
+				void onStreamAudio(AudioStream::ListenerContext& source, AFloat** buffer, std::size_t numChannels, std::size_t numSamples) override;
+				void onStreamPropertiesChanged(AudioStream::ListenerContext& source, const AudioStream::AudioStreamInfo& before) override {}
+
+				/// <summary>
+				/// Takes a free entry in the registry, or one of a process that went away.
+				/// </summary>
+				bool claimEntry();
+				/// <summary>
+				/// Whether the entry is still held by this publisher, and not taken over by another process.
+				/// </summary>
+				bool isOwner(int slot) const noexcept;
+				/// <summary>
+				/// Writes the contents of the registry entry.
+				/// </summary>
+				void announce();
+				/// <summary>
+				/// Replaces the segment the audio thread writes to, and releases the old one once it's not written to anymore.
+				/// </summary>
+				void replaceSegment(std::unique_ptr<juce::MemoryMappedFile> newMapping, const juce::File& newFile);
+
+				/// <summary>
+				/// Protects everything but the header, which the audio thread only reads through <see cref="header"/>.
+				/// </summary>
+				std::mutex mutex;
+				std::unique_ptr<juce::MemoryMappedFile> mapping;
+				juce::File file;
+				std::atomic<StreamHeader*> header { nullptr };
+				/// <summary>
+				/// Set by the audio thread while it uses the header.
+				/// </summary>
+				std::atomic<bool> isWriting { false };
+				/// <summary>
+				/// Cached when claiming an entry, so the audio thread never creates the registry.
+				/// </summary>
+				std::atomic<Registry*> registry { nullptr };
+				std::atomic<int> registrySlot { -1 };
+				/// <summary>
+				/// Identifies this publisher as the owner of its entry.
+				/// </summary>
+				const std::uint64_t claim;
+				std::shared_ptr<Maintenance> maintenance;
+				Key key {};
+				std::string name;
+				int channels = 0;
+			};
+
+			/// <summary>
+			/// Reads a stream published by another process. Every method but open() and refresh() is wait-free, and can be called from an audio thread.
+			/// </summary>
+			class Subscriber
+			{
+			public:
+
+				/// <summary>
+				/// Takes a lease on the stream published under the key, and opens its segment.
+				/// Returns null if there is no such stream, or the publisher hasn't created the segment yet. Not from the audio thread.
+				/// </summary>
+				static std::shared_ptr<Subscriber> open(const Key& key);
+
+				/// <summary>
+				/// Renews the lease. Returns false if the publisher went away or moved to another segment,
+				/// in which case the stream has to be opened again. Call every <see cref="MaintenanceInterval"/>, not from the audio thread.
+				/// </summary>
+				bool refresh();
+
+				/// <summary>
+				/// The stamp of the newest block the publisher wrote.
+				/// </summary>
+				bool latest(BlockTimeline::Stamp& stamp) const noexcept;
+				std::size_t getNumChannels() const noexcept;
+
+				/// <summary>
+				/// The samples behind the newest position that can be read safely.
+				/// </summary>
+				std::int64_t history() const noexcept { return Capacity / 2; }
+
+				/// <summary>
+				/// Reads samples from [position, position + numSamples) of a channel.
+				/// </summary>
+				void read(std::size_t channel, std::int64_t position, AFloat* destination, std::size_t numSamples) const noexcept;
+
+			private:
+
+				Subscriber(std::unique_ptr<juce::MemoryMappedFile> mapping, StreamHeader& header, const Key& key, std::size_t slot, const juce::String& segment);
+
+				std::unique_ptr<juce::MemoryMappedFile> mapping;
+				StreamHeader& header;
+				const AFloat* samples;
+				const Key key;
+				const std::size_t slot;
+				const juce::String segment;
+			};
+		}
+	}
+
+#endif
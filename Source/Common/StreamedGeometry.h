@@ -0,0 +1,336 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:StreamedGeometry.h
+
+		Bulk upload and drawing of per-frame vertex arrays through buffer objects
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_STREAMEDGEOMETRY_H
+	#define SIGNALIZER_STREAMEDGEOMETRY_H
+
+	#include "Signalizer.h"
+	#include "LineShader.h"
+	#include <cpl/simd.h>
+	#include <vector>
+	#include <algorithm>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// Streams vertex arrays that change every frame to the GPU, and draws them in one call.
+		/// Uploads rotate through a small ring of buffer objects, and the storage of each is orphaned before writing,
+		/// so the driver never has to wait for the GPU to finish reading the previous contents.
+		/// Lines can optionally be drawn antialiased through a LineShader, see setAntialiasedLineWidth().
+		/// Must only be used on the OpenGL thread. Call release() before the context goes away.
+		/// </summary>
+		class StreamedGeometry
+		{
+		public:
+
+			static constexpr std::size_t RingSize = 4;
+
+			/// <summary>
+			/// A vertex array being built for a single draw call, owned by the geometry to avoid reallocations.
+			/// Positions have either 2 or 3 components. Colours are RGBA bytes per vertex, and only stored once a colour is added:
+			/// like PrimitiveDrawer, a colour applies to every vertex added after it.
+			/// </summary>
+			class Batch
+			{
+			public:
+
+				/// <summary>
+				/// Direct access to the positions of this many vertices, for bulk writing.
+				/// </summary>
+				GLfloat* positions(std::size_t vertices)
+				{
+					positionData.resize(vertices * components);
+					return positionData.data();
+				}
+
+				/// <summary>
+				/// Direct access to the colours of this many vertices, for bulk writing.
+				/// </summary>
+				GLubyte* colours(std::size_t vertices)
+				{
+					colourData.resize(vertices * 4);
+					hasColours = true;
+					return colourData.data();
+				}
+
+				void addVertex(GLfloat x, GLfloat y, GLfloat z)
+				{
+					positionData.push_back(x);
+					positionData.push_back(y);
+
+					if (components == 3)
+						positionData.push_back(z);
+
+					if (hasColours)
+						colourData.insert(colourData.end(), std::begin(currentColour), std::end(currentColour));
+				}
+
+				void addColour(float r, float g, float b, float a = 1)
+				{
+					currentColour[0] = toByte(r);
+					currentColour[1] = toByte(g);
+					currentColour[2] = toByte(b);
+					currentColour[3] = toByte(a);
+
+					if (!hasColours)
+					{
+						// vertices before the first colour get it too
+						hasColours = true;
+						for (std::size_t i = 0; i < size(); ++i)
+							colourData.insert(colourData.end(), std::begin(currentColour), std::end(currentColour));
+					}
+				}
+
+				void addColour(const juce::Colour& colour)
+				{
+					addColour(colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha());
+				}
+
+				/// <summary>
+				/// Adds an OpenGL ordered byte pixel, like cpl::GraphicsND::UPixel
+				/// </summary>
+				template<typename Pixel>
+				auto addColour(const Pixel& colour) -> decltype(colour.pixel.r, void())
+				{
+					addColour(colour.pixel.r / 255.0f, colour.pixel.g / 255.0f, colour.pixel.b / 255.0f, colour.pixel.a / 255.0f);
+				}
+
+				std::size_t size() const noexcept { return positionData.size() / components; }
+
+			private:
+
+				friend class StreamedGeometry;
+				friend class CachedGeometry;
+
+				void reset(GLint newComponents)
+				{
+					components = newComponents;
+					hasColours = false;
+					positionData.clear();
+					colourData.clear();
+				}
+
+				static GLubyte toByte(float x) noexcept
+				{
+					return static_cast<GLubyte>(std::max(0.0f, std::min(1.0f, x)) * 255 + 0.5f);
+				}
+
+				cpl::aligned_vector<GLfloat, 32> positionData;
+				std::vector<GLubyte> colourData;
+				GLubyte currentColour[4] {};
+				GLint components = 3;
+				bool hasColours = false;
+			};
+
+			/// <summary>
+			/// Starts a new batch, discarding the previous one.
+			/// </summary>
+			Batch& begin(GLint components)
+			{
+				batch.reset(components);
+				return batch;
+			}
+
+			/// <summary>
+			/// Draws the current batch. Without colours, the current OpenGL colour is used.
+			/// </summary>
+			void draw(GLenum primitive)
+			{
+				draw(primitive, batch.components, batch.positionData.data(), batch.size(), batch.hasColours ? batch.colourData.data() : nullptr);
+			}
+
+			/// <summary>
+			/// Draws vertices from external arrays. Colours are RGBA bytes per vertex, or null to use the current OpenGL colour.
+			/// </summary>
+			void draw(GLenum primitive, GLint components, const GLfloat* positions, std::size_t vertices, const GLubyte* colours = nullptr)
+			{
+				if (vertices == 0)
+					return;
+
+				const bool isLines = primitive == GL_LINE_STRIP || primitive == GL_LINES;
+
+				if (isLines && lineWidth > 0 && lineShader.prepare())
+				{
+					drawAntialiasedLines(primitive, components, positions, vertices, colours);
+					return;
+				}
+
+				drawArrays(primitive, components, positions, vertices, colours, nullptr);
+			}
+
+			/// <summary>
+			/// Line strips and lines drawn after this are widened to quads and antialiased in a shader, instead of relying
+			/// on multisampling. The width is in pixels, like glLineWidth. Zero, or no shader support, draws plain lines.
+			/// </summary>
+			void setAntialiasedLineWidth(GLfloat pixels) noexcept
+			{
+				lineWidth = pixels;
+			}
+
+			/// <summary>
+			/// Deletes the buffer objects and shaders. The OpenGL context must be current.
+			/// </summary>
+			void release()
+			{
+				lineShader.release();
+
+				if (!isCreated)
+					return;
+
+				if (auto context = juce::OpenGLContext::getCurrentContext())
+					context->extensions.glDeleteBuffers(static_cast<GLsizei>(RingSize), buffers);
+
+				isCreated = false;
+			}
+
+		private:
+
+			void drawArrays(GLenum primitive, GLint components, const GLfloat* positions, std::size_t vertices, const GLubyte* colours, const GLfloat* texCoords)
+			{
+				auto& gl = juce::OpenGLContext::getCurrentContext()->extensions;
+
+				if (!isCreated)
+				{
+					gl.glGenBuffers(static_cast<GLsizei>(RingSize), buffers);
+					isCreated = true;
+				}
+
+				const auto positionBytes = static_cast<GLsizeiptr>(vertices * components * sizeof(GLfloat));
+				const auto colourBytes = static_cast<GLsizeiptr>(colours ? vertices * 4 : 0);
+				const auto texCoordBytes = static_cast<GLsizeiptr>(texCoords ? vertices * 4 * sizeof(GLfloat) : 0);
+
+				gl.glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+				// orphan the old storage, the driver hands out fresh memory if the previous draw is still in flight
+				gl.glBufferData(GL_ARRAY_BUFFER, positionBytes + colourBytes + texCoordBytes, nullptr, GL_STREAM_DRAW);
+				gl.glBufferSubData(GL_ARRAY_BUFFER, 0, positionBytes, positions);
+
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glVertexPointer(components, GL_FLOAT, 0, nullptr);
+
+				if (colours)
+				{
+					gl.glBufferSubData(GL_ARRAY_BUFFER, positionBytes, colourBytes, colours);
+					glEnableClientState(GL_COLOR_ARRAY);
+					glColorPointer(4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<const GLvoid*>(positionBytes));
+				}
+
+				if (texCoords)
+				{
+					gl.glBufferSubData(GL_ARRAY_BUFFER, positionBytes + colourBytes, texCoordBytes, texCoords);
+					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+					glTexCoordPointer(4, GL_FLOAT, 0, reinterpret_cast<const GLvoid*>(positionBytes + colourBytes));
+				}
+
+				glDrawArrays(primitive, 0, static_cast<GLsizei>(vertices));
+
+				if (texCoords)
+					glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+				if (colours)
+					glDisableClientState(GL_COLOR_ARRAY);
+
+				glDisableClientState(GL_VERTEX_ARRAY);
+				gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				current = (current + 1) % RingSize;
+			}
+
+			/// <summary>
+			/// Expands every segment into a quad of 4 corners for the LineShader. Only the open ends are capped:
+			/// both ends of separate lines, and the first and last end of a strip.
+			/// </summary>
+			void drawAntialiasedLines(GLenum primitive, GLint components, const GLfloat* positions, std::size_t vertices, const GLubyte* colours)
+			{
+				const std::size_t step = primitive == GL_LINES ? 2 : 1;
+				const std::size_t segments = vertices < 2 ? 0 : (vertices - 2) / step + 1;
+
+				if (segments == 0)
+					return;
+
+				// corner codes, 2 * end + side, in drawing order
+				const GLfloat corners[] = { 0, 1, 3, 2 };
+
+				lineStarts.resize(segments * 4 * 3);
+				lineEnds.resize(segments * 4 * 4);
+				lineColours.resize(colours ? segments * 4 * 4 : 0);
+
+				const bool isStrip = primitive == GL_LINE_STRIP;
+
+				for (std::size_t s = 0; s < segments; ++s)
+				{
+					const auto a = s * step, b = a + 1;
+					const GLfloat caps[] = { !isStrip || s == 0 ? 4.0f : 0.0f, !isStrip || s + 1 == segments ? 4.0f : 0.0f };
+
+					for (std::size_t k = 0; k < 4; ++k)
+					{
+						const auto corner = s * 4 + k;
+
+						lineStarts[corner * 3 + 0] = positions[a * components + 0];
+						lineStarts[corner * 3 + 1] = positions[a * components + 1];
+						lineStarts[corner * 3 + 2] = components == 3 ? positions[a * components + 2] : 0;
+
+						lineEnds[corner * 4 + 0] = positions[b * components + 0];
+						lineEnds[corner * 4 + 1] = positions[b * components + 1];
+						lineEnds[corner * 4 + 2] = components == 3 ? positions[b * components + 2] : 0;
+						lineEnds[corner * 4 + 3] = corners[k] + caps[k < 2 ? 0 : 1];
+
+						if (colours)
+						{
+							const auto source = (k < 2 ? a : b) * 4;
+							std::copy(colours + source, colours + source + 4, lineColours.begin() + corner * 4);
+						}
+					}
+				}
+
+				// the shader already covers the edges, multisampling would only blur them further
+				const bool wasMultisampled = glIsEnabled(GL_MULTISAMPLE) == GL_TRUE;
+
+				if (wasMultisampled)
+					glDisable(GL_MULTISAMPLE);
+
+				lineShader.use(lineWidth);
+				drawArrays(GL_QUADS, 3, lineStarts.data(), segments * 4, colours ? lineColours.data() : nullptr, lineEnds.data());
+				lineShader.stop();
+
+				if (wasMultisampled)
+					glEnable(GL_MULTISAMPLE);
+			}
+
+			Batch batch;
+			LineShader lineShader;
+			cpl::aligned_vector<GLfloat, 32> lineStarts, lineEnds;
+			std::vector<GLubyte> lineColours;
+			GLfloat lineWidth = 0;
+			GLuint buffers[RingSize] {};
+			std::size_t current = 0;
+			bool isCreated = false;
+		};
+	};
+
+#endif
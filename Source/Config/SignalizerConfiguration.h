@@ -59,7 +59,11 @@
 
 		typedef cpl::AudioStream<AFloat, 256> AudioStream;
 
-		static constexpr int MaxInputChannels = 16;
+		/// <summary>
+		/// Upper bound of channels in any layout, enough for 7th order ambisonics.
+		/// Storage is sized for the channels actually in use, this only bounds fixed tables.
+		/// </summary>
+		static constexpr int MaxInputChannels = 64;
 
 	};
 #endif
@@ -31,6 +31,8 @@
 #include "MainEditor.h"
 #include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <iterator>
 
 namespace Signalizer
 {
@@ -156,7 +158,7 @@ namespace Signalizer
 				using Base = NodeBase<Host>;
 
 				Host(HostGraph::Model& model, juce::Rectangle<float> bounds)
-					: Base(&model, 0)
+					: Base(&model, 0), ports(visiblePorts(model))
 				{
 					auto width = bounds.getWidth() / 3;
 
@@ -164,9 +166,23 @@ namespace Signalizer
 						bounds.getRight() - (space + width),
 						bounds.getY() + space * 2,
 						width,
-						calculateHeight(Signalizer::MaxInputChannels)
+						calculateHeight(ports)
 					);
 				}
+
+				/// <summary>
+				/// Every connected port and a free pair after them, so big layouts don't crowd the view with unused pins.
+				/// </summary>
+				static int visiblePorts(const HostGraph::Model& model) noexcept
+				{
+					int highest = -1;
+
+					for (const auto& c : model.connections)
+						highest = std::max<int>(highest, c.Destination);
+
+					const auto used = highest + 1 + (highest + 1) % 2;
+					return std::min(Signalizer::MaxInputChannels, std::max(16, used + 2));
+				}
 				
 				juce::Point<float> getPinPositionFor(PinInt port) const noexcept
 				{
@@ -175,8 +191,10 @@ namespace Signalizer
 
 				bool moveNextPort()
 				{
-					return ++port < Signalizer::MaxInputChannels;
+					return ++port < ports;
 				}
+
+				int ports;
 			};
 
 			struct Node : public NodeBase<Node>
@@ -244,12 +262,14 @@ namespace Signalizer
 				{
 					checkBoundsOfConnection();
 
-					auto connection = model->connections[model->nodes[index].connectionOffset + static_cast<std::size_t>(con)];
+					const auto offset = model->nodes[index].connectionOffset + static_cast<std::size_t>(con);
+					auto connection = model->connections[offset];
 
 					return std::make_tuple(
 						getPinPositionFor(connection.Source), 
 						host.getPinPositionFor(connection.Destination),
-						connection
+						connection,
+						model->gains[offset]
 					);
 				}
 
@@ -387,7 +407,7 @@ namespace Signalizer
 				while (n.moveNextConnection())
 				{
 					auto current = n.getCurrentConnection(host);
-					if(!c(std::get<0>(current), std::get<1>(current), std::make_pair(n.getView(), std::get<2>(current))))
+					if(!c(std::get<0>(current), std::get<1>(current), std::make_pair(n.getView(), std::get<2>(current)), std::get<3>(current)))
 						return;
 				}
 			}
@@ -398,9 +418,12 @@ namespace Signalizer
 			edges.resize(0);
 			
 			forEachConnection(
-				[this](auto sourcePos, auto destPos, auto pair)
+				[this](auto sourcePos, auto destPos, auto pair, float gain)
 				{
-					layoutEdge(edges.emplace_back(), sourcePos, destPos);
+					auto& edge = edges.emplace_back();
+					edge.destination = destPos;
+					edge.gain = gain;
+					layoutEdge(edge.path, sourcePos, destPos);
 					return true;
 				}
 			);
@@ -426,9 +449,22 @@ namespace Signalizer
 
 			g.setColour(edgeColour);
 
-			for (auto& p : edges)
+			for (auto& e : edges)
 			{
-				g.strokePath(p, pst);
+				g.strokePath(e.path, pst);
+			}
+
+			// only connections that aren't at unity are labelled
+			for (auto& e : edges)
+			{
+				if (e.gain == 1)
+					continue;
+
+				g.drawText(
+					gainText(e.gain),
+					juce::Rectangle<float>(e.destination.x - 60, e.destination.y - 16, 55, 14),
+					juce::Justification::centredRight
+				);
 			}
 
 			if (sourceDrag.has_value())
@@ -540,7 +576,7 @@ namespace Signalizer
 
 				// Test if we're redragging an existing edge
 				forEachConnection(
-					[this](auto sourcePos, auto destPos, const auto& con)
+					[this](auto sourcePos, auto destPos, const auto& con, float)
 					{
 						if (ImmediateLayout::expandPoint(destPos).contains(lastControlPosition))
 						{
@@ -556,6 +592,29 @@ namespace Signalizer
 					}
 				);
 			}
+			else if (e.mods.isPopupMenu())
+			{
+				// the gain of the connection ending in this pin
+				forEachConnection(
+					[this](auto sourcePos, auto destPos, const auto& con, float gain)
+					{
+						if (!ImmediateLayout::expandPoint(destPos).contains(lastControlPosition))
+							return true;
+
+						juce::PopupMenu menu;
+
+						for (int i = 0; i < numGainSteps; ++i)
+						{
+							const auto stepGain = gainForItem(i + 1);
+							menu.addItem(i + 1, gainText(stepGain), true, std::abs(stepGain - gain) < 1e-4f);
+						}
+
+						menu.showMenuAsync(juce::PopupMenu::Options(), new GainChoice(*this, con.first.node, con.second));
+						isChoosingGain = true;
+						return false;
+					}
+				);
+			}
 		}
 
 
@@ -581,7 +640,7 @@ namespace Signalizer
 					}
 				}
 			}
-			else
+			else if (!isChoosingGain)
 			{
 				ImmediateLayout layout(model, graphRect(), filter);
 
@@ -616,12 +675,52 @@ namespace Signalizer
 			}
 
 			sourceDrag.reset();
+			isChoosingGain = false;
 			pointOfInterest = { };
 			lastControlPosition = e.position;
 
 			repaint();
 		}
 
+		static constexpr float gainSteps[] = { 0, -3, -6, -12, -24 };
+		/// <summary>
+		/// The steps, and muting the connection.
+		/// </summary>
+		static constexpr int numGainSteps = static_cast<int>(std::size(gainSteps)) + 1;
+
+		static float gainForItem(int item)
+		{
+			return item < numGainSteps ? std::pow(10.0f, gainSteps[item - 1] / 20) : 0.0f;
+		}
+
+		static std::string gainText(float gain)
+		{
+			if (gain <= 0)
+				return "Muted";
+
+			char buf[32];
+			cpl::sprintfs(buf, "%.1f dB", 20 * std::log10(gain));
+			return buf;
+		}
+
+		struct GainChoice : public juce::ModalComponentManager::Callback
+		{
+			GainChoice(Content& content, const HostGraph::SerializedHandle& node, DirectedPortPair pair)
+				: content(&content), node(node), pair(pair)
+			{
+			}
+
+			void modalStateFinished(int result) override
+			{
+				if (content && result > 0)
+					content->graph.setGain(node, pair, gainForItem(result));
+			}
+
+			juce::Component::SafePointer<Content> content;
+			HostGraph::SerializedHandle node;
+			DirectedPortPair pair;
+		};
+
 		void connectionRequest(PinInt destination)
 		{
 			CPL_RUNTIME_ASSERTION(sourceDrag.has_value());
@@ -672,7 +771,14 @@ namespace Signalizer
 		Button identityButton;
 		juce::TextEditor filterField;
 		juce::Point<float> lastControlPosition, pointOfInterest;
-		std::vector<juce::Path> edges;
+		struct EdgeView
+		{
+			juce::Path path;
+			juce::Point<float> destination;
+			float gain;
+		};
+
+		std::vector<EdgeView> edges;
 		std::string filter;
 		std::once_flag focusGrab;
 		
@@ -688,6 +794,10 @@ namespace Signalizer
 
 		std::optional<DraggedEdge> sourceDrag;
 		bool isMouseDown;
+		/// <summary>
+		/// The gain menu of a connection was opened by this click, which then doesn't toggle anything.
+		/// </summary>
+		bool isChoosingGain = false;
 
 		// Inherited via Listener
 		virtual void onObjectDestruction(const cpl::CBaseControl::ObjectProxy& destroyedObject) override
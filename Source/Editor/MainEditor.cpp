@@ -38,6 +38,7 @@
 #include "version.h"
 #include <cpl/Mathext.h>
 #include "GraphEditor.h"
+#include "../Common/AnalysisScheduler.h"
 #include <set>
 
 namespace cpl
@@ -62,6 +63,21 @@ namespace Signalizer
 
 	const static int kdefaultLength = 700, kdefaultHeight = 480;
 
+	/// <summary>
+	/// The analysis cores knob spans from a single core to every core.
+	/// </summary>
+	static std::size_t analysisCoresFor(double normalized)
+	{
+		const auto cores = AnalysisScheduler::instance().getHardwareConcurrency();
+		return 1 + cpl::Math::round<std::size_t>(cpl::Math::confineTo(normalized, 0.0, 1.0) * (cores - 1));
+	}
+
+	static double normalizedAnalysisCores(std::size_t threads)
+	{
+		const auto cores = AnalysisScheduler::instance().getHardwareConcurrency();
+		return cores > 1 ? static_cast<double>(threads - 1) / (cores - 1) : 1.0;
+	}
+
 	const static juce::String MainEditorName = "Main Editor Settings";
 
 	std::string MainPresetName = "main";
@@ -225,6 +241,7 @@ namespace Signalizer
 			if (auto section = new Signalizer::CContentPage::MatrixSection())
 			{
 				section->addControl(&kmaxHistorySize, 0);
+				section->addControl(&kanalysisCores, 0);
 				section->addControl(&klegendChoice, 1);
 				page->addSection(section, "Globals");
 			}
@@ -327,6 +344,43 @@ namespace Signalizer
 
 	}
 
+	bool MainEditor::isRepaintingContinuously()
+	{
+		return kvsync.bGetBoolState() && newc.swapInterval > 0;
+	}
+
+	void MainEditor::updateRepaintMode()
+	{
+		if (!hasCurrentView())
+			return;
+
+		if (isRepaintingContinuously())
+		{
+			// this is kind of stupid; the sync setting must be set after the context is created..
+			struct RetrySync
+			{
+				RetrySync(MainEditor * h) : handle(h) {};
+				MainEditor * handle;
+
+				void operator()()
+				{
+					if (handle->oglc.isAttached())
+						handle->oglc.setContinuousRepainting(handle->isRepaintingContinuously());
+					else
+						cpl::GUIUtils::FutureMainEvent(200, RetrySync(handle), handle);
+				}
+
+			};
+
+			RetrySync(this)();
+		}
+		else
+		{
+			// a swap interval of zero would render as fast as possible, so the timer paces it instead of sleeping in the rendering
+			oglc.setContinuousRepainting(false);
+		}
+	}
+
 	void MainEditor::pushEditor(StateEditor * editor)
 	{
 		pushEditor(std::unique_ptr<StateEditor>(editor));
@@ -542,39 +596,16 @@ namespace Signalizer
 			newc.swapInterval = cpl::Math::round<int>(kswapInterval.bGetValue() * kdefaultMaxSkippedFrames);
 
 			mtFlags.swapIntervalChanged = true;
+			updateRepaintMode();
 		}
 		else if (c == &kvsync)
 		{
-			if (kvsync.getValueReference().getNormalizedValue() > 0.5)
-			{
-				if (hasCurrentView())
-				{
-					// this is kind of stupid; the sync setting must be set after the context is created..
-					struct RetrySync
-					{
-						RetrySync(MainEditor * h) : handle(h) {};
-						MainEditor * handle;
-
-						void operator()()
-						{
-							if (handle->oglc.isAttached())
-								handle->oglc.setContinuousRepainting(true);
-							else
-								cpl::GUIUtils::FutureMainEvent(200, RetrySync(handle), handle);
-						}
-
-					};
-
-					RetrySync(this)();
-				}
-			}
-			else
-			{
-				if (hasCurrentView())
-				{
-					oglc.setContinuousRepainting(false);
-				}
-			}
+			updateRepaintMode();
+		}
+		// shared by every instance, so the last one restored decides
+		else if (c == &kanalysisCores)
+		{
+			AnalysisScheduler::instance().setMaxConcurrency(analysisCoresFor(value));
 		}
 		// change of refresh rate
 		else if (c == &krefreshRate)
@@ -1078,6 +1109,7 @@ namespace Signalizer
 		data << khideTabs;
 		data << khideWidgets << kstopProcessingOnSuspend;
 		data << klegendChoice;
+		data << kanalysisCores;
 	}
 
 	void MainEditor::nestedOnMouseMove(const juce::MouseEvent & e)
@@ -1220,6 +1252,11 @@ namespace Signalizer
 		{
 			data >> klegendChoice;
 		}
+
+		if (version >= cpl::Version(0, 4, 4))
+		{
+			data >> kanalysisCores;
+		}
 	}
 
 	bool MainEditor::stringToValue(const cpl::CBaseControl * ctrl, const cpl::string_ref valString, cpl::iCtrlPrec_t & val)
@@ -1254,6 +1291,14 @@ namespace Signalizer
 				return true;
 			}
 		}
+		else if (ctrl == &kanalysisCores)
+		{
+			if (cpl::lexicalConversion(valString, newVal))
+			{
+				val = normalizedAnalysisCores(static_cast<std::size_t>(std::max(1.0, newVal)));
+				return true;
+			}
+		}
 		return false;
 	}
 
@@ -1272,6 +1317,11 @@ namespace Signalizer
 			valString = buf;
 			return true;
 		}
+		else if (ctrl == &kanalysisCores)
+		{
+			valString = std::to_string(analysisCoresFor(val)) + " cores";
+			return true;
+		}
 		return false;
 	}
 
@@ -1393,6 +1443,8 @@ namespace Signalizer
 
 		if (hasCurrentView())
 		{
+			const bool showedLegend = globalState->showLegend;
+
 			switch (cpl::Math::distribute<LegendChoice>(klegendChoice.bGetValue()))
 			{
 			case LegendChoice::OnlyWhenIrregular:
@@ -1419,8 +1471,14 @@ namespace Signalizer
 					focusGained(FocusChangeType::focusChangedDirectly);
 			}
 
-			if(!kvsync.bGetBoolState())
-				activeView().repaintMainContent();
+			if (!isRepaintingContinuously())
+			{
+				auto window = dynamic_cast<GraphicsWindow*>(&activeView());
+
+				// views that already present a retained frame of the current state aren't drawn again
+				if (!window || globalState->showLegend != showedLegend || window->isFrameDue())
+					activeView().repaintMainContent();
+			}
 		}
 
 		int failedAnswer = 0;
@@ -1467,6 +1525,10 @@ namespace Signalizer
 
 	void MainEditor::onOGLRendering(cpl::COpenGLView * view) noexcept
 	{
+		// as close to the last swap as it gets; nothing may block in here
+		framePacer.onFrame();
+		globalState->frameInterval = framePacer.getFrameInterval();
+
 		if (mtFlags.swapIntervalChanged.cas())
 		{
 			oglc.setSwapInterval(newc.swapInterval);
@@ -1531,6 +1593,9 @@ namespace Signalizer
 		khelp.bAddChangeListener(this);
 		krefreshState.bAddChangeListener(this);
 		kswapInterval.bAddFormatter(this);
+		kanalysisCores.bAddFormatter(this);
+		kanalysisCores.bSetInternal(normalizedAnalysisCores(AnalysisScheduler::instance().getMaxConcurrency()));
+		kanalysisCores.bAddChangeListener(this);
 		kstopProcessingOnSuspend.bAddChangeListener(this);
 		khideWidgets.bAddChangeListener(this);
 		krevealExceptionLog.bAddChangeListener(this);
@@ -1560,6 +1625,7 @@ namespace Signalizer
 		kgraphSerialization.bSetTitle("Sidechain saving");
 		kidle.setSingleText("Idle in back");
 		kswapInterval.bSetTitle("Swap interval");
+		kanalysisCores.bSetTitle("Analysis cores");
 		kstableFps.setSingleText("Stable FPS");
 		kvsync.setSingleText("Vertical Sync");
 		krevealExceptionLog.setSingleText("Reveal log");
@@ -1621,7 +1687,8 @@ namespace Signalizer
 		krefreshState.bSetDescription("Resets any processing state in the active view to the default.");
 		kmaxHistorySize.bSetDescription("The maximum audio history capacity, set in the respective views. No limit, so be careful!");
 		kswapInterval.bSetDescription("Determines the swap interval for the graphics context; a value of zero means the graphics will"
-			"update as fast as possible, a value of 1 means it updates synced to the vertical sync, a value of N means it updates every Nth vertical frame sync.");
+			" update at the refresh rate, paced by a timer instead of the driver, a value of 1 means it updates synced to the vertical sync, a value of N means it updates every Nth vertical frame sync.");
+		kanalysisCores.bSetDescription("The most cores used for analysis at once, shared by every Signalizer in this process. Lower it if many instances compete with the host for the CPU.");
 		khideTabs.bSetDescription("Auto-hides the top tabs and buttons when not used.");
 		kstopProcessingOnSuspend.bSetDescription("If set, only the selected running view will process audio - improves performance, but views are out of sync when frozen");
 		khideWidgets.bSetDescription("Hides widgets on the screen (frequency trackers, for instance) when the mouse leaves the editor");
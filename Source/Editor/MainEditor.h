@@ -43,6 +43,7 @@
 	#include <array>
 	#include <memory>
 	#include "../Common/MixGraphListener.h"
+	#include "../Common/FramePacer.h"
 
 	namespace Signalizer
 	{
@@ -155,7 +156,15 @@
 				cpl::weak_atomic<int> swapInterval = 1;
 			} newc;
 
+			FramePacer framePacer;
+
 			void setTabBarVisibility(bool toggle);
+			/// <summary>
+			/// The context only repaints continuously when synced and a swap interval paces it,
+			/// otherwise the timer triggers the repaints at the refresh rate.
+			/// </summary>
+			bool isRepaintingContinuously();
+			void updateRepaintMode();
 
 			// the z-ordering system ensures this is basically a FIFO system
 			void pushEditor(StateEditor * editor);
@@ -187,7 +196,7 @@
 			// Editor controls
 			cpl::CButton kstableFps, kvsync, krefreshState, kidle, khideTabs, khideWidgets, kstopProcessingOnSuspend, krevealExceptionLog;
 			cpl::CInputControl kmaxHistorySize;
-			cpl::CKnobSlider krefreshRate, kswapInterval;
+			cpl::CKnobSlider krefreshRate, kswapInterval, kanalysisCores;
 			cpl::CComboBox krenderEngine, kantialias, klegendChoice;
 			cpl::CValueComboBox kgraphSerialization;
 			cpl::CPresetWidget kpresets;
@@ -34,6 +34,7 @@
 	#include <cpl/simd.h>
 	#include <cpl/dsp/LinkwitzRileyNetwork.h>
 	#include <cpl/dsp/SmoothedParameterState.h>
+	#include "../Common/PeakTracker.h"
 
 	namespace Signalizer
 	{
@@ -124,9 +125,33 @@
 				auto finalCapacity = static_cast<std::size_t>(std::max(requiredSampleBufferSize, audioHistoryCapacity));
 
 				front.resizeStorage(requiredSampleBufferSize, finalCapacity);
-				back.resizeStorage(requiredSampleBufferSize, finalCapacity);
+
+				const auto backSize = requiredSampleBufferSize + backHeadroom;
+				back.resizeStorage(backSize, std::max(finalCapacity, backSize));
+			}
+
+			/// <summary>
+			/// Sizes the back buffer to hold an entire block of audio on top of the history of the front buffer,
+			/// so a block can be processed into it in one go and swapped from afterwards.
+			/// Hosts that don't anticipate their block size get a minimum, bigger blocks are processed in parts.
+			/// Allocates, so this is done when the stream changes and never from the audio thread.
+			/// </summary>
+			void setBackHeadroom(std::size_t blockSize)
+			{
+				backHeadroom = std::max(blockSize, MinimumBackHeadroom);
+
+				if (front.channels.empty())
+					return;
+
+				const auto backSize = front.defaultChannel().audioData.getSize() + backHeadroom;
+				back.resizeStorage(backSize, std::max(front.defaultChannel().audioData.getCapacity(), backSize));
 			}
 
+			/// <summary>
+			/// Zero until the headroom has been set, in which case the back buffer has no room for any audio.
+			/// </summary>
+			std::size_t getBackHeadroom() const noexcept { return backHeadroom; }
+
 			void resizeChannels(std::size_t newChannels)
 			{
 				for (auto buffer : { &back, &front })
@@ -142,7 +167,7 @@
 				}
 
 				filterStates.channels.resize(std::max(filterStates.channels.size(), newChannels));
-
+				peaks.resize(std::max(peaks.size(), newChannels));
 			}
 
 			void swapBuffers(std::size_t historySize, cpl::ssize_t offset)
@@ -178,6 +203,14 @@
 
 			FilterStates filterStates;
 			Buffer back, front;
+			/// <summary>
+			/// Peaks of the analysed signals for the auto-gain, over the size of the audio buffers.
+			/// What signal each tracks depends on peakMode.
+			/// </summary>
+			std::vector<PeakTracker> peaks;
+			OscChannels peakMode = OscChannels::Left;
+			static constexpr std::size_t MinimumBackHeadroom = 512;
+			std::size_t backHeadroom = 0;
 
 		};
 	};
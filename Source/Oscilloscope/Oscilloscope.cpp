@@ -61,6 +61,7 @@ namespace Signalizer
 		, content(params)
 	{
 		processor->streamState.lock()->content = content;
+		setFrameActivity(processor->activity.getVersion());
 
 		transformBuffer.resize(OscilloscopeContent::LookaheadSize);
 		temporaryBuffer.resize(OscilloscopeContent::LookaheadSize);
@@ -68,6 +69,7 @@ namespace Signalizer
 		setOpaque(true);
 		initPanelAndControls();
 		stream->addListener(processor);
+		content->getParameterSet().addRTListener(this, true);
 	}
 
 	void Oscilloscope::suspend()
@@ -78,6 +80,7 @@ namespace Signalizer
 	void Oscilloscope::resume()
 	{
 		processor->isSuspended = false;
+		invalidateFrame();
 	}
 
 	juce::Component * Oscilloscope::getWindow()
@@ -88,6 +91,7 @@ namespace Signalizer
 	Oscilloscope::~Oscilloscope()
 	{
 		audioStream->removeListener(processor);
+		content->getParameterSet().removeRTListener(this, true);
 		notifyDestruction();
 	}
 
@@ -205,6 +209,12 @@ namespace Signalizer
 		}
 	}
 
+	void Oscilloscope::parameterChangedRT(cpl::Parameters::Handle localHandle, cpl::Parameters::Handle globalHandle, ParameterSet::BaseParameter * param)
+	{
+		// everything else is polled every frame
+		invalidateFrame();
+	}
+
 	void Oscilloscope::mouseDrag(const juce::MouseEvent& event)
 	{
 		auto deltaDifference = event.position - currentMouse.getPoint();
@@ -366,7 +376,9 @@ namespace Signalizer
 		access->channelNames = source.getChannelNames();
 		access->historyCapacity = source.getInfo().audioHistoryCapacity;
 		access->sampleRate = source.getInfo().sampleRate;
+		access->channelData.setBackHeadroom(source.getInfo().anticipatedSize);
 		access->audioStreamChangeVersion.bump();
+		activity.touch();
 	}
 
 	Oscilloscope::StreamState::StreamState()
@@ -38,6 +38,12 @@
 	#include <cpl/dsp/SmoothedParameterState.h>
 	#include <utility>
 	#include "ChannelData.h"
+	#include "PolyphaseLanczos.h"
+	#include "../Common/StreamedGeometry.h"
+	#include "../Common/CachedGeometry.h"
+	#include "../Common/OverlayLayer.h"
+	#include "../Common/RetainedFrame.h"
+	#include "../Common/AnalysisScheduler.h"
 	#include <cpl/gui/CViews.h>
 
 	namespace cpl
@@ -64,6 +70,7 @@
 		class Oscilloscope final
 			: public GraphicsWindow
 			, private AudioStream::Listener
+			, private ParameterSet::RTListener
 		{
 		public:
 
@@ -85,6 +92,7 @@
 			
 			// OpenGLRender overrides
 			void onOpenGLRendering() override;
+			void closeOpenGL() override;
 			// View overrides
 			juce::Component * getWindow() override;
 			void suspend() override;
@@ -135,6 +143,8 @@
 				OscilloscopeContent::TimeMode timeMode;
 				ChangeVersion::Listener audioStreamChanged;
 				LegendCache legend;
+				ChangeVersion::Listener legendChanged;
+				ConcurrentChangeVersion::Listener audioChanged;
 
 			} state {};
 
@@ -212,6 +222,11 @@
 
 				OscilloscopeContent::TriggeringMode triggerMode;
 				ChangeVersion audioStreamChangeVersion;
+				/// <summary>
+				/// Whether every channel of the block being processed is silent, and whether the
+				/// colour filters have settled on silence as well (see AudioActivity).
+				/// </summary>
+				bool isSilentBlock = false, isSettledBlock = false;
 
 				template<typename ISA>
 				void preAnalyseAudio(AudioStream::ListenerContext& ctx, AFloat** buffer, std::size_t numChannels, std::size_t numSamples);
@@ -230,7 +245,7 @@
 				);
 
 				template<typename ISA>
-				void audioEntryPoint(AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples);
+				void audioEntryPoint(const AudioActivity& activity, AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples);
 			};
 
 			void deserialize(cpl::CSerializer::Builder & builder, cpl::Version version) override {};
@@ -241,6 +256,8 @@
 				template<typename ISA> static void dispatch(Oscilloscope & o) { o.vectorGLRendering<ISA>(); }
 			};
 
+			void parameterChangedRT(cpl::Parameters::Handle localHandle, cpl::Parameters::Handle globalHandle, ParameterSet::BaseParameter * param) override;
+
 
 			std::size_t getEffectiveChannels() const noexcept;
 
@@ -251,12 +268,37 @@
 			template<typename ISA, typename Eval>
 				void drawWavePlot(cpl::OpenGLRendering::COpenGLStack &, const EvaluatorParams& params, StreamState& cs);
 
+			/// <summary>
+			/// Affine mapping from sample index and value into normalized device coordinates.
+			/// </summary>
+			struct SpanTransform
+			{
+				GLfloat xScale, xOffset, yScale, yOffset;
+			};
+
+			/// <summary>
+			/// Generates interleaved x/y vertices into vertexBuffer for the next samples of the evaluator,
+			/// resolved as contiguous spans. If HoldSamples is set, every sample emits a horizontal step.
+			/// Returns the amount of vertices written.
+			/// </summary>
+			template<typename ISA, typename Eval, bool HoldSamples>
+				std::size_t generateSpanVertices(const Eval& eval, std::size_t samples, const SpanTransform& transform);
+
+			/// <summary>
+			/// Evaluates the next samples of the evaluator into a linear buffer, resolved as contiguous spans.
+			/// Returns the amount of samples written.
+			/// </summary>
+			template<typename ISA, typename Eval>
+				std::size_t evaluateSpans(const Eval& eval, std::size_t samples, AFloat* output);
+
 			template<typename ISA>
 				void drawWireFrame(juce::Graphics & g, juce::Rectangle<float> rect, float gain);
 
 			template<typename ISA>
 				void drawTimeDivisions(juce::Graphics & g, juce::Rectangle<float> rect);
 
+			void layoutTimeDivisions(juce::Rectangle<float> rect);
+
 			template<typename ISA, typename Eval>
 				void calculateFundamentalPeriod(const EvaluatorParams& params);
 
@@ -272,6 +314,12 @@
 			template<typename ISA>
 				void paint2DGraphics(juce::Graphics & g);
 
+			/// <summary>
+			/// Paints the 2D graphics that only change with the view (axes and legend), into the overlay layer.
+			/// </summary>
+			template<typename ISA>
+				void paintOverlay(juce::Graphics & g, bool showLegend);
+
 			bool checkAndInformInvalidCombinations(Oscilloscope::StreamState&);
 
 			void initPanelAndControls();
@@ -289,6 +337,10 @@
 				std::shared_ptr<const SharedBehaviour> globalBehaviour;
 				CriticalSection<StreamState> streamState;
 				cpl::relaxed_atomic<bool> isSuspended;
+				/// <summary>
+				/// Bumped when incoming audio can change the display.
+				/// </summary>
+				AudioActivity activity;
 
 				void onStreamAudio(AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples) override;
 				void onStreamPropertiesChanged(AudioStream::ListenerContext& source, const AudioStream::AudioStreamInfo& before) override;
@@ -303,7 +355,8 @@
 			{
 				template<typename ISA> static void dispatch(ProcessorShell& shell, AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples)
 				{
-					shell.streamState.lock()->audioEntryPoint<ISA>(source, buffer, numChannels, numSamples);
+					shell.activity.onAudio<ISA>(buffer, numChannels, numSamples, source.getInfo());
+					shell.streamState.lock()->audioEntryPoint<ISA>(shell.activity, source, buffer, numChannels, numSamples);
 				}
 			};
 
@@ -314,12 +367,36 @@
 				BinRecord record{};
 			};
 
+			/// <summary>
+			/// Division lines and labels of an axis, relative to the rectangle they are drawn in.
+			/// Only laid out again when the key changes.
+			/// </summary>
+			struct AxisLayout
+			{
+				struct Line { float position, thickness; };
+				struct Label { float x, y; juce::String text; };
+
+				CacheKey key;
+				std::vector<Line> lines;
+				std::vector<Label> labels;
+
+				void clear() { lines.clear(); labels.clear(); }
+			};
+
 			using VO = OscilloscopeContent::ViewOffsets;
 			std::shared_ptr<OscilloscopeContent> content;
 			std::shared_ptr<AudioStream::Output> audioStream;
 
 			cpl::aligned_vector<std::complex<double>, 32> transformBuffer;
 			cpl::aligned_vector<double, 16> temporaryBuffer;
+			cpl::aligned_vector<GLfloat, 32> vertexBuffer;
+			cpl::aligned_vector<AFloat, 32> interpolationBuffer;
+			cpl::aligned_vector<ChannelData::PixelType, 16> colourBuffer;
+			PolyphaseLanczos<AFloat> lanczosTable;
+			StreamedGeometry geometry;
+			AxisLayout amplitudeAxis, timeAxis;
+			OverlayLayer overlay;
+			RetainedFrame retainedFrame;
 			std::shared_ptr<const SharedBehaviour> globalBehaviour;
 			std::size_t medianPos;
 			std::array<MedianData, MedianData::FilterSize> medianTriggerFilter;
@@ -337,6 +414,16 @@
 				typedef ChannelData::AudioBuffer::ProxyView::value_type AudioT;
 				typedef ChannelData::ColourBuffer::ProxyView::value_type ColourT;
 
+				/// <summary>
+				/// A contiguous run of samples inside the circular audio buffers.
+				/// Evaluators combining two channels read from both first and second,
+				/// otherwise they are identical.
+				/// </summary>
+				struct SampleSpan
+				{
+					AudioIt first, second;
+					std::size_t size;
+				};
 			};
 
 			template<OscChannels ChannelConfiguration>
@@ -325,13 +325,17 @@ namespace Signalizer
 		if (numChannels == 1)
 			localMode = OscChannels::Left;
 
+		using namespace cpl::simd;
+		typedef typename ISA::V V;
+
 		if (numChannels == 1)
 		{
 			// currently unreachable
-			for (std::size_t n = 0; n < numSamples; ++n)
-			{
-				ana.process(buffer[0][n]);
-			}
+			const auto channel = buffer[0];
+			ana.processSpan(
+				[=](std::size_t n) { return loadu<V>(channel + n); },
+				[=](std::size_t n) { return channel[n]; }
+			);
 		}
 		else
 		{
@@ -350,35 +354,43 @@ namespace Signalizer
 				triggerPair = triggerSeparate & ~0x1;
 			}
 
+			// the pair is only complete if the trigger isn't on the last of an odd amount of channels
+			const auto rightOfPair = std::min(triggerPair + 1, numChannels - 1);
+			const auto left = buffer[triggerPair];
+			const auto right = buffer[rightOfPair];
+
 			switch (localMode)
 			{
-			case OscChannels::Right: triggerPair++;
+			case OscChannels::Right: triggerPair = rightOfPair;
 			case OscChannels::Left:
 			{
 				const auto channel = buffer[triggerPair];
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(channel[n]);
-				}
+				ana.processSpan(
+					[=](std::size_t n) { return loadu<V>(channel + n); },
+					[=](std::size_t n) { return channel[n]; }
+				);
 				break;
 			}
 			case OscChannels::Separate:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(buffer[triggerSeparate][n]);
-				}
+			{
+				const auto channel = buffer[triggerSeparate];
+				ana.processSpan(
+					[=](std::size_t n) { return loadu<V>(channel + n); },
+					[=](std::size_t n) { return channel[n]; }
+				);
 				break;
+			}
 			case OscChannels::Mid:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(0.5f * (buffer[triggerPair + 0][n] + buffer[triggerPair + 1][n]));
-				}
+				ana.processSpan(
+					[=](std::size_t n) { return consts<V>::half * (loadu<V>(left + n) + loadu<V>(right + n)); },
+					[=](std::size_t n) { return 0.5f * (left[n] + right[n]); }
+				);
 				break;
 			case OscChannels::Side:
-				for (std::size_t n = 0; n < numSamples; ++n)
-				{
-					ana.process(0.5f * (buffer[triggerPair + 0][n] - buffer[triggerPair + 1][n]));
-				}
+				ana.processSpan(
+					[=](std::size_t n) { return consts<V>::half * (loadu<V>(left + n) - loadu<V>(right + n)); },
+					[=](std::size_t n) { return 0.5f * (left[n] - right[n]); }
+				);
 				break;
 			}
 		}
@@ -401,11 +413,17 @@ namespace Signalizer
 	}
 
 	template<typename ISA>
-	void Oscilloscope::StreamState::audioEntryPoint(AudioStream::ListenerContext& ctx, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples)
+	void Oscilloscope::StreamState::audioEntryPoint(const AudioActivity& activity, AudioStream::ListenerContext& ctx, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples)
 	{
 		if (numSamples == 0 || numChannels == 0)
 			return;
 
+		isSilentBlock = activity.allSilent();
+		isSettledBlock = isSilentBlock;
+
+		for (std::size_t c = 0; c < numChannels && isSettledBlock; ++c)
+			isSettledBlock = activity.isSettled(c);
+
 		channelData.resizeChannels(numChannels);
 
 		cpl::variable_array<float*> localBuffers(buffer, buffer + numChannels);
@@ -507,8 +525,27 @@ namespace Signalizer
 
 				std::size_t offset = 0;
 
+				// silence only decays the envelopes, which is a single power of the pole for the whole block
+				if (envelopeMode != EnvelopeModes::None && isSilentBlock)
+				{
+					const auto decay = std::pow(envelopeCoeff, static_cast<AFloat>(numSamples));
+
+					for (std::size_t c = 0; c < numChannels; ++c)
+						filterEnv[c] *= decay;
+
+					if (mode == OscChannels::MidSide)
+					{
+						for (std::size_t c = 2; c < numChannels; ++c)
+							filterEnv[c] = filterEnv[fs::Right];
+					}
+					else if (mode != OscChannels::Separate)
+					{
+						for (std::size_t c = 1; c < numChannels; ++c)
+							filterEnv[c] = filterEnv[fs::Left];
+					}
+				}
 				// process envelopes so we're not thrashing the icache
-				if (envelopeMode != EnvelopeModes::None)
+				else if (envelopeMode != EnvelopeModes::None)
 				{
 					switch (mode)
 					{
@@ -555,13 +592,19 @@ namespace Signalizer
 						break;
 
 					case OscChannels::Separate:
-						for (std::size_t n = 0; n < numSamples; ++n)
+						// a channel at a time, so the state stays in a register and the input is read contiguously
+						for (std::size_t c = 0; c < numChannels; ++c)
 						{
-							for (std::size_t c = 0; c < numChannels; ++c)
+							const auto channel = buffer[c];
+							auto state = filterEnv[c];
+
+							for (std::size_t n = 0; n < numSamples; ++n)
 							{
-								const auto sample = cpl::Math::square(buffer[c][n]);
-								filterEnv[c] = sample + envelopeCoeff * (filterEnv[c] - sample);
-							} 
+								const auto sample = cpl::Math::square(channel[n]);
+								state = sample + envelopeCoeff * (state - sample);
+							}
+
+							filterEnv[c] = state;
 						}
 
 						break;
@@ -607,9 +650,12 @@ namespace Signalizer
 
 				CPL_RUNTIME_ASSERTION((numChannels % 2) == 0);
 
-				// Process colours for each channel pair
-				for (std::size_t channelPair = 0; channelPair < numChannels; channelPair += 2)
+				// Process colours for each channel pair. Every pair has its own filters and colour buffers,
+				// so wide layouts spread the pairs over the cores.
+				auto processPair = [&](std::size_t pairIndex)
 				{
+					const auto channelPair = pairIndex * 2;
+
 					auto& leftMid = channelData.filterStates.channels[channelPair + fs::Left];
 					auto& rightSide = channelData.filterStates.channels[channelPair + fs::Right];
 
@@ -631,6 +677,26 @@ namespace Signalizer
 					const ChannelData::PixelType leftColour = leftMid.defaultKey;
 					const ChannelData::PixelType rightColour = rightSide.defaultKey;
 
+					if (isSettledBlock)
+					{
+						// the crossovers and smoothing filters decayed over the whole history already, so the colours hold still
+						const auto
+							left = accumulateColour(smLeft, leftColour, blend),
+							right = accumulateColour(smRight, rightColour, blend),
+							mid = accumulateColour(smMid, leftColour, blend),
+							side = accumulateColour(smSide, rightColour, blend);
+
+						for (std::size_t n = 0; n < numSamples; ++n)
+						{
+							cwLeft.setHeadAndAdvance(left);
+							cwRight.setHeadAndAdvance(right);
+							cwMid.setHeadAndAdvance(mid);
+							cwSide.setHeadAndAdvance(side);
+						}
+
+						return;
+					}
+
 					for (std::size_t n = 0; n < numSamples; ++n)
 					{
 						auto leftBands = netLeft.process(buffer[channelPair + fs::Left][n], channelData.networkCoeffs);
@@ -650,7 +716,12 @@ namespace Signalizer
 						cwSide.setHeadAndAdvance(accumulateColour(smSide, rightColour, blend));
 
 					}
-				}
+				};
+
+				if (numChannels > 2)
+					AnalysisScheduler::instance().parallel_for(numChannels / 2, processPair);
+				else
+					processPair(0);
 
 			}
 			else if (numChannels == 1)
@@ -660,7 +731,17 @@ namespace Signalizer
 				auto && lw = target.channels[fs::Left].colourData.createWriter();
 				auto leftSmoothState = channelData.filterStates.channels[fs::Left].smoothFilters;
 
-				for (std::size_t n = 0; n < numSamples; n++)
+				if (isSettledBlock)
+				{
+					filterEnv[fs::Left] *= std::pow(envelopeCoeff, static_cast<AFloat>(numSamples));
+
+					const auto settledColour = accumulateColour(leftSmoothState, colour, blend);
+
+					for (std::size_t n = 0; n < numSamples; n++)
+						lw.setHeadAndAdvance(settledColour);
+				}
+
+				for (std::size_t n = 0; n < (isSettledBlock ? 0 : numSamples); n++)
 				{
 					const auto left = buffer[fs::Left][n];
 					const auto lSquared = left * left;
@@ -680,6 +761,47 @@ namespace Signalizer
 
 			}
 
+			if (envelopeMode == EnvelopeModes::PeakDecay)
+			{
+				const auto window = target.defaultChannel().audioData.getSize();
+				auto& peaks = channelData.peaks;
+
+				if (channelData.peakMode != mode)
+				{
+					for (auto& p : peaks)
+						p.reset();
+
+					channelData.peakMode = mode;
+				}
+
+				for (auto& p : peaks)
+					p.setWindow(window);
+
+				if (isSilentBlock)
+				{
+					for (auto& p : peaks)
+						p.writeSilence(numSamples);
+				}
+				else
+				{
+					switch (mode)
+					{
+						case OscChannels::Left: peaks[0].write<ISA>(buffer[fs::Left], numSamples); break;
+						case OscChannels::Right: peaks[0].write<ISA>(buffer[fs::Right], numSamples); break;
+						case OscChannels::Mid: peaks[0].write<ISA>(buffer[fs::Left], buffer[fs::Right], numSamples, std::plus<>()); break;
+						case OscChannels::Side: peaks[0].write<ISA>(buffer[fs::Left], buffer[fs::Right], numSamples, std::minus<>()); break;
+						case OscChannels::Separate:
+							for (std::size_t c = 0; c < numChannels; ++c)
+								peaks[c].write<ISA>(buffer[c], numSamples);
+							break;
+						case OscChannels::MidSide:
+							peaks[fs::Mid].write<ISA>(buffer[fs::Left], buffer[fs::Right], numSamples, std::plus<>());
+							peaks[fs::Side].write<ISA>(buffer[fs::Left], buffer[fs::Right], numSamples, std::minus<>());
+							break;
+					}
+				}
+			}
+
 			// store calculated envelope
 			if (envelopeMode == EnvelopeModes::RMS)
 			{
@@ -712,24 +834,12 @@ namespace Signalizer
 	template<typename ISA>
 		void Oscilloscope::runPeakFilter(ChannelData& data)
 		{
-			// there is a number of optimisations we can do here, mostly that we actually don't care about
-			// timing, we are only interested in the current largest value in the set.
-			using namespace cpl;
-			using namespace cpl::simd;
-			using cpl::simd::load;
-
-			typedef typename ISA::V V;
-
+			// the peaks over the buffers are tracked as the audio is written (see audioProcessing),
+			// so all that's left here is to decay the envelopes.
 			auto smoothEnvelopeState = [&](std::size_t i) -> AFloat& { return data.filterStates.channels[i].envelope; };
+			auto peak = [&](std::size_t i) -> double { return data.peaks[i].getPeak(); };
 
-			V
-				vLMax = zero<V>(),
-				vRMax = zero<V>(),
-				vSign = consts<V>::sign_mask;
-
-			auto const loopIncrement = elements_of<V>::value;
-
-			auto const vHalf = consts<V>::half;
+			auto const loopIncrement = cpl::simd::elements_of<typename ISA::V>::value;
 
 			auto const numChannels = data.front.channels.size();
 
@@ -737,9 +847,9 @@ namespace Signalizer
 
 			auto const numSamples = data.front.channels.begin()->audioData.getSize();
 
-			auto stop = numSamples - (numSamples & (loopIncrement - 1));
-			if (stop <= 0)
-				stop = 0;
+			// the producer hasn't caught up with a mode change yet
+			if (data.peakMode != channelMode || data.peaks.size() < numChannels)
+				return;
 
 			// since this runs in every frame, we need to scale the coefficient by how often this function runs
 			// (and the amount of samples)
@@ -748,68 +858,15 @@ namespace Signalizer
 
 			if (channelMode <= OscChannels::OffsetForMono)
 			{
-				auto && view = data.front.channels[0].audioData.createProxyView();
-
-				const auto * leftBuffer = view.begin();
-
-				if (channelMode == OscChannels::Left)
-				{
-					for (std::size_t i = 0; i < stop; i += loopIncrement)
-					{
-						auto const vLInput = load<V>(leftBuffer + i);
-						vLMax = max(vand(vLInput, vSign), vLMax);
-					}
-				}
-				else
-				{
-					auto && rightView = data.front.channels[1].audioData.createProxyView();
-					const auto * rightBuffer = rightView.begin();
-
-					switch (channelMode)
-					{
-					case OscChannels::Right:
-
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vLInput = load<V>(rightBuffer + i);
-							vLMax = max(vand(vLInput, vSign), vLMax);
-						}
-						break;
-					case OscChannels::Mid:
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vInput = load<V>(leftBuffer + i) + load<V>(rightBuffer + i);
-							vLMax = max(vand(vInput * vHalf, vSign), vLMax);
-						}
-						break;
-					case OscChannels::Side:
-
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vInput = load<V>(leftBuffer + i) - load<V>(rightBuffer + i);
-							vLMax = max(vand(vInput * vHalf, vSign), vLMax);
-						}
-						break;
-					}
-				}
-
-				vRMax = vLMax;
-
-				// TODO: remainder?
-
-				suitable_container<V> lmax = vLMax, rmax = vRMax;
+				const auto highest = peak(0);
 
-				double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-				double highestRight = *std::max_element(rmax.begin(), rmax.end());
-
-				smoothEnvelopeState(0) = std::max(smoothEnvelopeState(0) * coeff, highestLeft  * highestLeft);
-				smoothEnvelopeState(1) = std::max(smoothEnvelopeState(1) * coeff, highestRight * highestRight);
+				smoothEnvelopeState(0) = std::max(smoothEnvelopeState(0) * coeff, highest * highest);
+				smoothEnvelopeState(1) = std::max(smoothEnvelopeState(1) * coeff, highest * highest);
 
 				for (std::size_t c = 2; c < numChannels; ++c)
 				{
 					smoothEnvelopeState(c) = smoothEnvelopeState(1);
 				}
-
 			}
 			else
 			{
@@ -817,22 +874,10 @@ namespace Signalizer
 				{
 					case OscChannels::Separate:
 					{
-	
 						for (std::size_t c = 0; c < numChannels; ++c)
 						{
-							auto&& view = data.front.channels[c].audioData.createProxyView();
-							auto buffer = view.begin();
-
-							for (std::size_t i = 0; i < stop; i += loopIncrement)
-							{
-								auto const vInput = load<V>(buffer + i);
-								vLMax = max(vand(vInput, vSign), vLMax);
-							}
-
-							suitable_container<V> lmax = vLMax;
-							auto highestValue = *std::max_element(lmax.begin(), lmax.end());
-
-							smoothEnvelopeState(c) = std::max<float>(smoothEnvelopeState(c) * coeff, highestValue * highestValue);
+							const auto highest = peak(c);
+							smoothEnvelopeState(c) = std::max<float>(smoothEnvelopeState(c) * coeff, highest * highest);
 						}
 
 						break;
@@ -840,30 +885,10 @@ namespace Signalizer
 
 					case OscChannels::MidSide:
 					{
-						ChannelData::AudioBuffer::ProxyView views[2] = { data.front.channels[0].audioData.createProxyView(), data.front.channels[1].audioData.createProxyView() };
-
-						const auto * leftBuffer = views[0].begin();
-						const auto * rightBuffer = views[1].begin();
-
-						for (std::size_t i = 0; i < stop; i += loopIncrement)
-						{
-							auto const vLInput = load<V>(leftBuffer + i);
-							auto const vRInput = load<V>(rightBuffer + i);
-
-							auto const a = vLInput + vRInput;
-							auto const b = vLInput - vRInput;
-
-							vLMax = max(vand(a * vHalf, vSign), vLMax);
-							vRMax = max(vand(b * vHalf, vSign), vRMax);
-						}
-
-						suitable_container<V> lmax = vLMax, rmax = vRMax;
-
-						double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-						double highestRight = *std::max_element(rmax.begin(), rmax.end());
+						const auto highestMid = peak(ChannelData::Mid), highestSide = peak(ChannelData::Side);
 
-						smoothEnvelopeState(ChannelData::Left) = std::max(smoothEnvelopeState(0) * coeff, highestLeft  * highestLeft);
-						smoothEnvelopeState(ChannelData::Right) = std::max(smoothEnvelopeState(1) * coeff, highestRight * highestRight);
+						smoothEnvelopeState(ChannelData::Left) = std::max(smoothEnvelopeState(0) * coeff, highestMid * highestMid);
+						smoothEnvelopeState(ChannelData::Right) = std::max(smoothEnvelopeState(1) * coeff, highestSide * highestSide);
 
 						for (std::size_t c = 2; c < numChannels; ++c)
 						{
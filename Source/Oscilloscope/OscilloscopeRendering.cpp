@@ -39,6 +39,14 @@
 
 namespace Signalizer
 {
+	/// <summary>
+	/// Sample counts as the time axis labels them, in hundredths. Keying on these instead of the raw values
+	/// keeps the axis from being laid out again every frame, as the tracked cycle length jitters.
+	/// </summary>
+	static double displayedSamples(double samples)
+	{
+		return std::round(samples * 100);
+	}
 
 	struct VerticalScreenSplitter
 	{
@@ -85,34 +93,8 @@ namespace Signalizer
 	};
 
 	template<typename ISA>
-	void Oscilloscope::paint2DGraphics(juce::Graphics & g)
+	void Oscilloscope::paintOverlay(juce::Graphics & g, bool showLegend)
 	{
-		if (content->diagnostics.getNormalizedValue() > 0.5)
-		{
-			g.setColour(juce::Colours::blue);
-
-			const auto perf = audioStream->getPerfMeasures();
-
-			float averageFps, averageCpu;
-			computeAverageStats(averageFps, averageCpu);
-
-			char textbuf[1024];
-
-			cpl::sprintfs(textbuf, "%dx%d: %.1f fps - %.1f%% cpu, deltaG = %f, deltaO = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%), qHZ: %.5f - HZ: %.5f - PHASE: %.5f",
-				getWidth(), getHeight(), averageFps, averageCpu, graphicsDeltaTime(), openGLDeltaTime(),
-				100 * perf.producerUsage,
-				100 * perf.producerOverhead,
-				100 * perf.consumerUsage,
-				100 * perf.consumerOverhead,
-				(double)triggerState.record.index,
-				triggerState.fundamental,
-				triggerState.sampleOffset
-			);
-
-			g.drawSingleLineText(textbuf, 10, 20);
-
-		}
-
 		auto bounds = getLocalBounds().toFloat();
 
 		if (state.colourAxis.getAlpha() != 0)
@@ -147,12 +129,44 @@ namespace Signalizer
 			}
 		}
 
-		auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
-
-		if (globalBehaviour->showLegend && mouseCheck)
+		if (showLegend)
 		{
 			state.legend.paint(g, state.colourWidget, state.colourBackground);
 		}
+	}
+
+	template<typename ISA>
+	void Oscilloscope::paint2DGraphics(juce::Graphics & g)
+	{
+		if (content->diagnostics.getNormalizedValue() > 0.5)
+		{
+			g.setColour(juce::Colours::blue);
+
+			const auto perf = audioStream->getPerfMeasures();
+
+			float averageFps, averageCpu;
+			computeAverageStats(averageFps, averageCpu);
+
+			char textbuf[1024];
+
+			cpl::sprintfs(textbuf, "%dx%d: %.1f fps - %.1f%% cpu, deltaG = %f, deltaO = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%), qHZ: %.5f - HZ: %.5f - PHASE: %.5f, quality: %s",
+				getWidth(), getHeight(), averageFps, averageCpu, graphicsDeltaTime(), openGLDeltaTime(),
+				100 * perf.producerUsage,
+				100 * perf.producerOverhead,
+				100 * perf.consumerUsage,
+				100 * perf.consumerOverhead,
+				(double)triggerState.record.index,
+				triggerState.fundamental,
+				triggerState.sampleOffset,
+				governor.getLevelName()
+			);
+
+			g.drawSingleLineText(textbuf, 10, 20);
+
+		}
+
+		auto bounds = getLocalBounds().toFloat();
+		auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
 
 		if (state.drawCursorTracker && mouseCheck && getEffectiveChannels() > 0 /* HACK */)
 		{
@@ -241,6 +255,16 @@ namespace Signalizer
 		cpl::simd::dynamic_isa_dispatch<float, RenderingDispatcher>(*this);
 	}
 
+	void Oscilloscope::closeOpenGL()
+	{
+		geometry.release();
+		overlay.release();
+		retainedFrame.release();
+		// nothing is retained in the next context
+		invalidateFrame();
+		governor.reset();
+	}
+
 	bool Oscilloscope::checkAndInformInvalidCombinations(Oscilloscope::StreamState& cs)
 	{
 		if (state.timeMode == OscilloscopeContent::TimeMode::Cycles && cs.triggerMode != OscilloscopeContent::TriggeringMode::Spectral)
@@ -263,6 +287,19 @@ namespace Signalizer
 		void Oscilloscope::vectorGLRendering()
 		{
             CPL_DEBUGCHECKGL();
+
+			auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
+			const bool showDynamicGraphics = (state.drawCursorTracker && mouseCheck) || content->diagnostics.getNormalizedValue() > 0.5;
+
+			// nothing changed since the last frame, so present it again
+			const bool hasChanged = state.audioChanged.consumeChanges(processor->activity.getVersion()) | frameChanged.cas() | showDynamicGraphics;
+
+			if (!retainedFrame.begin(hasChanged, { (double)getWidth(), (double)getHeight(), oglc->getRenderingScale(), (double)globalBehaviour->showLegend, (double)mouseCheck }))
+			{
+				postFrame(false);
+				return;
+			}
+
 			{
 				auto cs = processor->streamState.lock();
 				auto& streamState = *cs;
@@ -285,9 +322,11 @@ namespace Signalizer
 				// set up openGL
 				openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
 				openGLStack.loadIdentityMatrix();
-				state.antialias ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
+				state.antialias && !governor.isReduced(QualityGovernor::NoMultisampling) ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
 				openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
 				openGLStack.setPointSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
+				// waveforms are antialiased by the line shader, which doesn't depend on multisampling
+				geometry.setAntialiasedLineWidth(state.antialias ? static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize : 0);
 
 
 				CPL_DEBUGCHECKGL();
@@ -363,14 +402,42 @@ namespace Signalizer
 				CPL_DEBUGCHECKGL();
 			}
 
-			renderGraphics(
+			const bool showLegend = globalBehaviour->showLegend && mouseCheck;
+
+			if (state.legendChanged.consumeChanges(state.legend.getVersion()))
+				overlay.invalidate();
+
+			overlay.setRefreshInterval(governor.isReduced(QualityGovernor::ReducedOverlay) ? 8 : 1);
+			overlay.render(
+				getWidth(), getHeight(), oglc->getRenderingScale(),
+				{
+					getGain(), state.viewOffsets[VO::Left], state.viewOffsets[VO::Right], state.viewOffsets[VO::Top], state.viewOffsets[VO::Bottom],
+					content->pctForDivision.getNormalizedValue(), (double)state.timeMode, (double)state.triggerMode,
+					displayedSamples(state.effectiveWindowSize), state.sampleRate,
+					state.timeMode == OscilloscopeContent::TimeMode::Cycles ? displayedSamples(triggerState.cycleSamples) : 0.0,
+					(double)shared.overlayChannels.load(), (double)shared.channelMode.load(), (double)getEffectiveChannels(), (double)showLegend,
+					(double)state.colourAxis.getARGB(), (double)state.colourWidget.getARGB(), (double)state.colourBackground.getARGB()
+				},
 				[&](juce::Graphics & g)
 				{
-					// draw graph and wireframe
-					paint2DGraphics<ISA>(g);
+					// draw wireframe and legend
+					paintOverlay<ISA>(g, showLegend);
 				}
 			);
 
+			retainedFrame.retain();
+
+			// only the cursor tracker and diagnostics change every frame
+			if (showDynamicGraphics)
+			{
+				renderGraphics(
+					[&](juce::Graphics & g)
+					{
+						paint2DGraphics<ISA>(g);
+					}
+				);
+			}
+
 			postFrame();
 		}
 
@@ -380,72 +447,119 @@ namespace Signalizer
 			const auto xoff = rect.getX();
 			const auto yoff = rect.getY();
 
-			const auto verticalDelta = state.viewOffsets[VO::Bottom] - state.viewOffsets[VO::Top];
+			auto& layout = amplitudeAxis;
 
-			auto const minSpacing = (rect.getHeight() / 50) / verticalDelta;
-			// quantize to multiples of 3
-			auto const numLines = 2 * (std::size_t)(1.5 + 0.5 * (1 - content->pctForDivision.getNormalizedValue()) * minSpacing) - 1;
+			const bool isStale = layout.key.update({
+				rect.getWidth(), rect.getHeight(), gain,
+				state.viewOffsets[VO::Top], state.viewOffsets[VO::Bottom],
+				content->pctForDivision.getNormalizedValue()
+			});
 
-			g.setColour(state.colourAxis);
+			if (isStale)
+			{
+				layout.clear();
 
-			const auto offset = gain;
-			char textBuf[200];
+				const auto verticalDelta = state.viewOffsets[VO::Bottom] - state.viewOffsets[VO::Top];
 
-			auto viewTransform = [&](auto pos) {
-				return (pos + (state.viewOffsets[VO::Bottom] - 1)) / verticalDelta;
-			};
+				auto const minSpacing = (rect.getHeight() / 50) / verticalDelta;
+				// quantize to multiples of 3
+				auto const numLines = 2 * (std::size_t)(1.5 + 0.5 * (1 - content->pctForDivision.getNormalizedValue()) * minSpacing) - 1;
 
-			auto drawMarkerAt = [&](auto where, auto size) {
+				const auto offset = gain;
+				char textBuf[200];
 
-				auto const transformedPos = viewTransform(where);
-				auto const coord = transformedPos * rect.getHeight();
+				auto viewTransform = [&](auto pos) {
+					return (pos + (state.viewOffsets[VO::Bottom] - 1)) / verticalDelta;
+				};
 
-				auto const waveSpace = std::abs(2 * where - 1);
+				auto addMarkerAt = [&](auto where, auto size) {
 
-				auto const y = coord;
-				auto const dBs = 20 * std::log10(waveSpace / offset);
+					auto const transformedPos = viewTransform(where);
+					auto const coord = transformedPos * rect.getHeight();
 
-				cpl::sprintfs(textBuf, "%.3f dB", dBs);
+					auto const waveSpace = std::abs(2 * where - 1);
 
-				g.drawSingleLineText(textBuf, xoff + 5, yoff + rect.getHeight() - (y - 15), juce::Justification::left);
+					auto const y = coord;
+					auto const dBs = 20 * std::log10(waveSpace / offset);
 
-				g.drawLine(xoff, yoff + rect.getHeight() - y, xoff + rect.getWidth(), yoff + rect.getHeight() - y, size);
-			};
+					cpl::sprintfs(textBuf, "%.3f dB", dBs);
 
-			// -300 dB
-			auto const zeroDBEpsilon = 0.000000000000001;
+					layout.labels.push_back({ 5.0f, static_cast<float>(rect.getHeight() - (y - 15)), textBuf });
+					layout.lines.push_back({ static_cast<float>(rect.getHeight() - y), size });
+				};
 
-			auto
-				inc = 1.0 / (numLines - 1),
-				end = 1 - state.viewOffsets[VO::Top];
+				// -300 dB
+				auto const zeroDBEpsilon = 0.000000000000001;
 
-			auto start = cpl::Math::roundToNextMultiplier(1 - state.viewOffsets[VO::Bottom], inc);
+				auto
+					inc = 1.0 / (numLines - 1),
+					end = 1 - state.viewOffsets[VO::Top];
 
-			auto unitSpacePos = start + inc;
+				auto start = cpl::Math::roundToNextMultiplier(1 - state.viewOffsets[VO::Bottom], inc);
 
+				auto unitSpacePos = start + inc;
 
-			while (unitSpacePos < end)
-			{
-				if(std::abs(unitSpacePos - 0.5) > zeroDBEpsilon)
-					drawMarkerAt(unitSpacePos, 1.5f);
 
-				unitSpacePos += inc;
+				while (unitSpacePos < end)
+				{
+					if(std::abs(unitSpacePos - 0.5) > zeroDBEpsilon)
+						addMarkerAt(unitSpacePos, 1.5f);
+
+					unitSpacePos += inc;
+				}
+
+				if(start < 0.5 && end > 0.5)
+					addMarkerAt(0.5, 1.5f);
 			}
 
-			if(start < 0.5 && end > 0.5)
-				drawMarkerAt(0.5, 1.5f);
+			g.setColour(state.colourAxis);
+
+			for (auto& label : layout.labels)
+				g.drawSingleLineText(label.text, xoff + label.x, yoff + label.y, juce::Justification::left);
+
+			for (auto& line : layout.lines)
+				g.drawLine(xoff, yoff + line.position, xoff + rect.getWidth(), yoff + line.position, line.thickness);
 		}
 
 	template<typename ISA>
 	void Oscilloscope::drawTimeDivisions(juce::Graphics & g, juce::Rectangle<float> rect)
+	{
+		const auto xoff = rect.getX();
+		const auto yoff = rect.getY();
+
+		auto& layout = timeAxis;
+
+		const bool isStale = layout.key.update({
+			rect.getWidth(), rect.getHeight(),
+			state.viewOffsets[VO::Left], state.viewOffsets[VO::Right],
+			content->pctForDivision.getNormalizedValue(),
+			(double)state.timeMode, (double)state.triggerMode,
+			displayedSamples(state.effectiveWindowSize), state.sampleRate,
+			// only the cycle divisions depend on the cycle length
+			state.timeMode == OscilloscopeContent::TimeMode::Cycles ? displayedSamples(triggerState.cycleSamples) : 0.0
+		});
+
+		if (isStale)
+		{
+			layout.clear();
+			layoutTimeDivisions(rect);
+		}
+
+		g.setColour(state.colourAxis);
+
+		for (auto& line : layout.lines)
+			g.drawLine(xoff + line.position, yoff, xoff + line.position, rect.getHeight(), line.thickness);
+
+		for (auto& label : layout.labels)
+			g.drawSingleLineText(label.text, std::floor(xoff + label.x), yoff + label.y, juce::Justification::left);
+	}
+
+	void Oscilloscope::layoutTimeDivisions(juce::Rectangle<float> rect)
 	{
 		auto const horizontalDelta = (state.viewOffsets[VO::Right] - state.viewOffsets[VO::Left]);
 		auto const minVerticalSpacing = (rect.getWidth() / (state.timeMode == OscilloscopeContent::TimeMode::Time ? 75 : 110)) / horizontalDelta;
 		auto const wantedVerticalLines = (std::size_t)(0.5 + (1 - content->pctForDivision.getNormalizedValue()) * minVerticalSpacing);
 
-		const auto xoff = rect.getX();
-		const auto yoff = rect.getY();
-
 		if (wantedVerticalLines > 0)
 		{
 			char textBuf[200];
@@ -476,9 +590,6 @@ namespace Signalizer
 				msIncrease = windowSize / roundedPower;
 			}
 
-
-			g.setColour(state.colourAxis);
-
 			auto transformView = [&](auto x) {
 				return (x - state.viewOffsets[VO::Left]) / horizontalDelta;
 			};
@@ -506,16 +617,16 @@ namespace Signalizer
 				double moduloI = std::fmod(i, roundedPower) + 1;
 
 				auto const fraction = (currentMsPos + offset) / windowSize;
-				auto const x = xoff + transformView(fraction) * rect.getWidth();
+				auto const x = static_cast<float>(transformView(fraction) * rect.getWidth());
 				auto const samples = 1e-3 * currentMsPos * state.sampleRate;
 
-				g.drawLine(x, yoff, x, rect.getHeight(), samples == 0 ? 1.5f : 1.0f);
+				timeAxis.lines.push_back({ x, samples == 0 ? 1.5f : 1.0f });
 
 				float offset = 10;
 
 				auto textOut = [&](auto format, auto... args) {
 					cpl::sprintfs(textBuf, format, args...);
-					g.drawSingleLineText(textBuf, std::floor(x + 5), yoff + rect.getHeight() - offset, juce::Justification::left);
+					timeAxis.labels.push_back({ x + 5, rect.getHeight() - offset, textBuf });
 					offset += 15;
 				};
 
@@ -548,13 +659,111 @@ namespace Signalizer
 		}
 	}
 
+	template<typename ISA, typename Eval, bool HoldSamples>
+		std::size_t Oscilloscope::generateSpanVertices(const Eval& eval, std::size_t samples, const SpanTransform& transform)
+		{
+			using namespace cpl::simd;
+			typedef typename ISA::V V;
+
+			constexpr std::size_t lanes = elements_of<V>::value;
+			constexpr std::size_t verticesPerSample = HoldSamples ? 2 : 1;
+
+			typename Eval::SampleSpan spans[2];
+			const auto numSpans = eval.resolveSpans(samples, spans);
+
+			samples = spans[0].size + (numSpans > 1 ? spans[1].size : 0);
+			vertexBuffer.resize(samples * verticesPerSample * 2);
+
+			suitable_container<V> laneOffsets, outX, outY;
+
+			for (std::size_t c = 0; c < lanes; ++c)
+				laneOffsets[c] = static_cast<GLfloat>(c);
+
+			const V
+				vLaneX = laneOffsets.toType() * set1<V>(transform.xScale),
+				vYScale = set1<V>(transform.yScale),
+				vYOffset = set1<V>(transform.yOffset);
+
+			auto out = vertexBuffer.data();
+			std::size_t index = 0;
+
+			auto emit = [&](GLfloat x, GLfloat y)
+			{
+				*out++ = x;
+				*out++ = y;
+
+				if (HoldSamples)
+				{
+					*out++ = x + transform.xScale;
+					*out++ = y;
+				}
+			};
+
+			for (std::size_t s = 0; s < numSpans; ++s)
+			{
+				const auto& span = spans[s];
+				const auto stop = span.size - (span.size & (lanes - 1));
+
+				std::size_t i = 0;
+
+				for (; i < stop; i += lanes, index += lanes)
+				{
+					outY = Eval::template evaluateSpan<V>(span, i) * vYScale + vYOffset;
+					outX = set1<V>(transform.xOffset + transform.xScale * index) + vLaneX;
+
+					for (std::size_t c = 0; c < lanes; ++c)
+						emit(outX[c], outY[c]);
+				}
+
+				for (; i < span.size; ++i, ++index)
+				{
+					emit(transform.xOffset + transform.xScale * index, Eval::evaluateSpan(span, i) * transform.yScale + transform.yOffset);
+				}
+			}
+
+			return samples * verticesPerSample;
+		}
+
+	template<typename ISA, typename Eval>
+		std::size_t Oscilloscope::evaluateSpans(const Eval& eval, std::size_t samples, AFloat* output)
+		{
+			using namespace cpl::simd;
+			typedef typename ISA::V V;
+
+			constexpr std::size_t lanes = elements_of<V>::value;
+
+			typename Eval::SampleSpan spans[2];
+			const auto numSpans = eval.resolveSpans(samples, spans);
+
+			suitable_container<V> result;
+			auto out = output;
+
+			for (std::size_t s = 0; s < numSpans; ++s)
+			{
+				const auto& span = spans[s];
+				const auto stop = span.size - (span.size & (lanes - 1));
+
+				std::size_t i = 0;
+
+				for (; i < stop; i += lanes)
+				{
+					result = Eval::template evaluateSpan<V>(span, i);
+					out = std::copy(result.begin(), result.end(), out);
+				}
+
+				for (; i < span.size; ++i)
+					*out++ = Eval::evaluateSpan(span, i);
+			}
+
+			return static_cast<std::size_t>(out - output);
+		}
+
 	template<typename ISA, typename Evaluator>
 		void Oscilloscope::drawWavePlot(cpl::OpenGLRendering::COpenGLStack& openGLStack, const EvaluatorParams& params, Oscilloscope::StreamState& cs)
 		{
 
-			typedef cpl::OpenGLRendering::PrimitiveDrawer<1024> Renderer;
+			typedef StreamedGeometry::Batch Renderer;
 
-			cpl::OpenGLRendering::MatrixModification matrixMod;
 			// and apply the gain:
 			const auto gain = static_cast<GLfloat>(getGain());
 
@@ -584,6 +793,10 @@ namespace Signalizer
 			{
 				interpolation = SubSampleInterpolation::Linear;
 			}
+			else if (interpolation == SubSampleInterpolation::Lanczos && governor.isReduced(QualityGovernor::LinearInterpolation))
+			{
+				interpolation = SubSampleInterpolation::Linear;
+			}
 
 			if (triggerMode == OscilloscopeContent::TriggeringMode::Window)
 			{
@@ -600,52 +813,81 @@ namespace Signalizer
 			}
 			else
 			{
-				// TODO: FIX. This causes an extra cycle to be rendered for lanczos so it has more to eat from the edges.
-				auto const cycleBuffers = interpolation == SubSampleInterpolation::Lanczos ? 2 : 1;
 				// calculate fractionate offsets used for sample-space rendering
 				if (state.triggerMode != OscilloscopeContent::TriggeringMode::None)
 				{
 					quantizedCycleSamples = static_cast<cpl::ssize_t>(std::ceil(triggerState.cycleSamples));
-					subSampleOffset = cycleBuffers * (quantizedCycleSamples - triggerState.cycleSamples) + (roundedWindow - state.effectiveWindowSize);
+					subSampleOffset = (quantizedCycleSamples - triggerState.cycleSamples) + (roundedWindow - state.effectiveWindowSize);
 					offset = -triggerState.sampleOffset / sizeMinusOne;
 				}
-				bufferOffset = roundedWindow + cycleBuffers * quantizedCycleSamples;
+				bufferOffset = roundedWindow + quantizedCycleSamples;
 				offset += (1 - subSampleOffset) / sizeMinusOne;
 			}
 
 
 			roundedWindow = std::max<cpl::ssize_t>(2, roundedWindow);
 
-			// modify the horizontal axis into [0, 1] instead of [-1, 1]
-			matrixMod.translate(-1, 0, 0);
-			matrixMod.scale(2, 1, 1);
-
-			// apply horizontal transformation
-			matrixMod.scale(1 / (horizontalDelta), 1, 1);
-			matrixMod.translate(-left, 0, 0);
-
-			// apply vertical transformation
-			matrixMod.scale(1, 1.0 / verticalDelta, 0);
-			matrixMod.translate(0, top + (bottom - 1), 0);
-			matrixMod.scale(1, gain, 0);
+			// only immediate rendering uses the matrix stack, span rendering bakes the equivalent transform (see spanTransform)
+			auto applyViewTransform = [&](cpl::OpenGLRendering::MatrixModification& matrixMod)
+			{
+				// modify the horizontal axis into [0, 1] instead of [-1, 1]
+				matrixMod.translate(-1, 0, 0);
+				matrixMod.scale(2, 1, 1);
+
+				// apply horizontal transformation
+				matrixMod.scale(1 / (horizontalDelta), 1, 1);
+				matrixMod.translate(-left, 0, 0);
+
+				// apply vertical transformation
+				matrixMod.scale(1, 1.0 / verticalDelta, 0);
+				matrixMod.translate(0, top + (bottom - 1), 0);
+				matrixMod.scale(1, gain, 0);
+			};
 
 			const GLfloat endCondition = static_cast<GLfloat>(roundedWindow + quantizedCycleSamples /* + 2 */);
 
 			auto renderSampleSpace = [&](auto kernel, GLint primitive, cpl::ssize_t sampleOffset = 0)
 			{
 				cpl::OpenGLRendering::MatrixModification m;
+				applyViewTransform(m);
 				// translate triggering offset + 1
-				matrixMod.translate(offset - sampleDisplacement, 0, 0);
+				m.translate(offset - sampleDisplacement, 0, 0);
 				// scale to sample/pixels space
-				matrixMod.scale(sampleDisplacement, 1, 1);
+				m.scale(sampleDisplacement, 1, 1);
+
+				Evaluator eval(params);
+				if (!eval.isWellDefined())
+					return;
+
+				eval.startFrom(-(bufferOffset + sampleOffset), -(bufferOffset + sampleOffset));
+				kernel(eval, geometry.begin(3));
+				geometry.draw(primitive);
+			};
+
+			// equivalent of applyViewTransform and the sample space transform in renderSampleSpace, applied directly to the vertices
+			const SpanTransform spanTransform
+			{
+				static_cast<GLfloat>(2 * sampleDisplacement / horizontalDelta),
+				static_cast<GLfloat>(2 * (offset - sampleDisplacement - left) / horizontalDelta - 1),
+				static_cast<GLfloat>(gain / verticalDelta),
+				static_cast<GLfloat>((top + bottom - 1) / verticalDelta)
+			};
 
+			// single coloured sample space rendering, without any per-sample wrapping
+			auto renderSampleSpans = [&](auto holdSamples, GLint primitive, cpl::ssize_t sampleOffset = 0)
+			{
 				Evaluator eval(params);
 				if (!eval.isWellDefined())
 					return;
 
 				eval.startFrom(-(bufferOffset + sampleOffset), -(bufferOffset + sampleOffset));
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, primitive);
-				kernel(eval, drawer);
+
+				const auto vertices = generateSpanVertices<ISA, Evaluator, decltype(holdSamples)::value>(eval, static_cast<std::size_t>(endCondition), spanTransform);
+
+				const auto key = eval.getDefaultKey();
+				glColor4ub(key.pixel.r, key.pixel.g, key.pixel.b, key.pixel.a);
+
+				geometry.draw(primitive, 2, vertexBuffer.data(), vertices);
 			};
 
 			auto dotSamples = [&] (cpl::ssize_t offset)
@@ -679,19 +921,7 @@ namespace Signalizer
 				}
 				else
 				{
-					renderSampleSpace(
-						[&] (Evaluator & evaluator, Renderer & drawer)
-						{
-							drawer.addColour(evaluator.getDefaultKey());
-
-							for (GLfloat i = 0; i < endCondition; i += 1)
-							{
-								drawer.addVertex(i, evaluator.evaluateSampleInc(), 0);
-							}
-						},
-						GL_POINTS,
-						offset
-					);
+					renderSampleSpans(std::false_type(), GL_POINTS, offset);
 				}
 				openGLStack.setPointSize(oldPointSize);
 			};
@@ -727,18 +957,7 @@ namespace Signalizer
 					}
 					else
 					{
-						renderSampleSpace(
-							[&] (auto & evaluator, auto & drawer)
-							{
-								drawer.addColour(evaluator.getDefaultKey());
-
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									drawer.addVertex(i, evaluator.evaluateSampleInc(), 0);
-								}
-							},
-							GL_LINE_STRIP
-						);
+						renderSampleSpans(std::false_type(), GL_LINE_STRIP);
 					}
 
 					break;
@@ -771,27 +990,13 @@ namespace Signalizer
 					}
 					else
 					{
-						renderSampleSpace(
-							[&](auto & evaluator, auto & drawer)
-							{
-								drawer.addColour(evaluator.getDefaultKey());
-								for (GLfloat i = 0; i < endCondition; i += 1)
-								{
-									const auto vertex = evaluator.evaluateSampleInc();
-									drawer.addVertex(i, vertex, 0);
-									drawer.addVertex(i + 1, vertex, 0);
-								}
-							},
-							GL_LINE_STRIP
-						);
+						renderSampleSpans(std::true_type(), GL_LINE_STRIP);
 					}
 					break;
 				}
 				case SubSampleInterpolation::Lanczos:
 				{
-
-					auto const KernelSize = OscilloscopeContent::InterpolationKernelSize;
-					auto const KernelBufferSize = KernelSize * 2 + 1;
+					lanczosTable.setKernelSize(OscilloscopeContent::InterpolationKernelSize);
 
 					double samplePos = 0;
 
@@ -805,87 +1010,97 @@ namespace Signalizer
 					}
 					else
 					{
-						// TODO: possible small graphic glitch here if the interpolation eats into the next cycle.
 						// calculations different here, depending on how you interpret phase information in the frequency domain
-						samplePos = triggerState.cycleSamples * 2 + state.effectiveWindowSize - triggerState.sampleOffset;
+						samplePos = triggerState.cycleSamples + state.effectiveWindowSize - triggerState.sampleOffset;
 					}
 
 					// otherwise we will have a discontinuity as the interpolation kernel moves past T = 0
 					if (triggerMode == OscilloscopeContent::TriggeringMode::None || triggerMode == OscilloscopeContent::TriggeringMode::Window)
 					{
 						samplePos = std::ceil(samplePos);
-						//if (state.timeMode == OscilloscopeContent::TimeMode::Time)
-						//	samplePos += KernelSize;
 					}
 
 					// adjust for left
 					double inc = horizontalDelta / (oglc->getRenderingScale() * (getWidth() - 1));
-					double unitSpacePos = left;
 					double samplesPerPixel = 1.0 / (pixelsPerSample);
 
-					samplePos += -unitSpacePos / inc * samplesPerPixel;
-					double currentSample = std::floor(samplePos);
+					samplePos += -left / inc * samplesPerPixel;
+
+					// vertex k interpolates the sample at origin + k * samplesPerPixel, relative to the cursor
+					const auto origin = -samplePos;
+					const auto numVertices = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((right + inc - left) / inc)));
+					const auto integralOrigin = static_cast<cpl::ssize_t>(std::floor(origin));
+					const auto firstSample = integralOrigin + lanczosTable.getTapOrigin();
+					const auto endSample = static_cast<cpl::ssize_t>(std::floor(origin + (numVertices - 1) * samplesPerPixel)) + lanczosTable.getTapOrigin() + static_cast<cpl::ssize_t>(lanczosTable.getTaps());
 
 					Evaluator eval(params);
 
 					if (!eval.isWellDefined())
 						return;
 
-					eval.startFrom(-static_cast<cpl::ssize_t>(std::floor(samplePos)) - (int)KernelSize, 2 - KernelBufferSize - static_cast<cpl::ssize_t>(std::floor(samplePos)));
-
-					AFloat kernel[KernelBufferSize];
+					eval.startFrom(firstSample, integralOrigin);
 
-					typename Evaluator::ColourT currentColour, nextColour;
+					// samples past the cursor haven't arrived yet, so the kernel holds the newest sample there
+					interpolationBuffer.resize(endSample - firstSample);
+					const auto available = static_cast<std::size_t>(std::max<cpl::ssize_t>(0, std::min<cpl::ssize_t>(0, endSample) - firstSample));
+					const auto evaluated = evaluateSpans<ISA>(eval, available, interpolationBuffer.data());
+					std::fill(interpolationBuffer.begin() + evaluated, interpolationBuffer.end(), evaluated ? interpolationBuffer[evaluated - 1] : 0);
 
-					auto get = [&]() {
-						auto data = eval.evaluate();
-						eval.inc();
-						currentColour = nextColour;
-						nextColour = data.second;
+					const auto xScale = static_cast<GLfloat>(2 * inc / horizontalDelta);
+					const auto yScale = static_cast<GLfloat>(gain / verticalDelta);
+					const auto yOffset = static_cast<GLfloat>((top + bottom - 1) / verticalDelta);
 
-						return data.first;
-					};
+					vertexBuffer.resize(numVertices * 2);
 
-					auto insert = [&] (auto val) {
-						std::rotate(kernel, kernel + 1, kernel + KernelBufferSize);
-						kernel[KernelBufferSize - 1] = val;
-					};
+					for (std::size_t k = 0; k < numVertices; ++k)
+					{
+						const auto position = origin + k * samplesPerPixel;
+						const auto integral = std::floor(position);
+						const auto sample = lanczosTable.template interpolate<typename ISA::V>(
+							interpolationBuffer.data() + static_cast<std::size_t>(static_cast<cpl::ssize_t>(integral) - integralOrigin),
+							position - integral
+						);
 
-					std::for_each(std::begin(kernel), std::end(kernel), [&](auto & f) { f = get(); });
+						vertexBuffer[k * 2 + 0] = xScale * k - 1;
+						vertexBuffer[k * 2 + 1] = sample * yScale + yOffset;
+					}
 
+					if (state.colourChannelsByFrequency)
 					{
-						cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, GL_LINE_STRIP);
-						if (!state.colourChannelsByFrequency)
-							drawer.addColour(eval.getDefaultKey());
-						else
-							drawer.addColour(currentColour);
+						colourBuffer.resize(numVertices);
 
-						do
-						{
-							auto delta = currentSample - samplePos;
+						auto colourIndex = integralOrigin;
+						typename Evaluator::ColourT currentColour = eval.evaluateColourInc(), nextColour = eval.evaluateColourInc();
 
-							while (delta > 1)
-							{
-								samplePos += 1;
-								delta -= 1;
-								insert(get());
-							}
-
-							const auto interpolatedValue = cpl::dsp::lanczosFilter<double>(kernel, KernelBufferSize, (KernelSize) + delta, KernelSize);
+						for (std::size_t k = 0; k < numVertices; ++k)
+						{
+							const auto position = origin + k * samplesPerPixel;
+							const auto integral = static_cast<cpl::ssize_t>(std::floor(position));
 
-							if (state.colourChannelsByFrequency)
+							// don't step into colours past the cursor
+							while (colourIndex < integral && colourIndex + 2 < 0)
 							{
-								drawer.addColour(currentColour.lerp(nextColour, delta));
+								currentColour = nextColour;
+								nextColour = eval.evaluateColourInc();
+								colourIndex++;
 							}
 
-							drawer.addVertex(unitSpacePos, interpolatedValue, 0);
-							currentSample += samplesPerPixel;
-
-							unitSpacePos += inc;
-
-						} while (unitSpacePos < (right + inc));
+							colourBuffer[k] = currentColour.lerp(nextColour, std::min(1.0, position - colourIndex));
+						}
+					}
+					else
+					{
+						const auto key = eval.getDefaultKey();
+						glColor4ub(key.pixel.r, key.pixel.g, key.pixel.b, key.pixel.a);
 					}
 
+					geometry.draw(
+						GL_LINE_STRIP,
+						2,
+						vertexBuffer.data(),
+						numVertices,
+						state.colourChannelsByFrequency ? reinterpret_cast<const GLubyte*>(colourBuffer.data()) : nullptr
+					);
 
 					break;
 				}
@@ -0,0 +1,135 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:PolyphaseLanczos.h
+
+		Precomputed polyphase Lanczos kernel for sub-sample interpolation
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_POLYPHASE_LANCZOS_H
+	#define SIGNALIZER_POLYPHASE_LANCZOS_H
+
+	#include "Signalizer.h"
+	#include <cpl/simd.h>
+	#include <cmath>
+	#include <numeric>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// A Lanczos kernel sampled at a fixed amount of fractional phases.
+		/// Rows are zero-padded to a multiple of the widest vector, so interpolating a point
+		/// is a plain dot product of a row and the surrounding samples.
+		/// </summary>
+		template<typename T>
+		class PolyphaseLanczos
+		{
+		public:
+
+			static constexpr std::size_t Phases = 256;
+			static constexpr std::size_t TapAlignment = 8;
+
+			/// <summary>
+			/// Rebuilds the table, if the kernel size changed.
+			/// </summary>
+			void setKernelSize(std::size_t newKernelSize)
+			{
+				if (newKernelSize == kernelSize && !table.empty())
+					return;
+
+				kernelSize = newKernelSize;
+				taps = (2 * kernelSize + TapAlignment - 1) & ~(TapAlignment - 1);
+
+				// the last row is a full phase, so rounding the fraction never carries into the integer position
+				table.assign(taps * (Phases + 1), 0);
+
+				for (std::size_t p = 0; p <= Phases; ++p)
+				{
+					const auto fraction = static_cast<double>(p) / Phases;
+
+					for (std::size_t k = 0; k < 2 * kernelSize; ++k)
+					{
+						table[p * taps + k] = static_cast<T>(lanczos(fraction + kernelSize - 1 - static_cast<double>(k)));
+					}
+				}
+			}
+
+			std::size_t getKernelSize() const noexcept { return kernelSize; }
+
+			/// <summary>
+			/// The amount of samples read for every interpolated point, including padding.
+			/// </summary>
+			std::size_t getTaps() const noexcept { return taps; }
+
+			/// <summary>
+			/// The offset of the first tap, relative to the integral part of the interpolated position.
+			/// </summary>
+			cpl::ssize_t getTapOrigin() const noexcept { return 1 - static_cast<cpl::ssize_t>(kernelSize); }
+
+			/// <summary>
+			/// Interpolates the signal at data[-getTapOrigin() + fraction], where fraction is in [0, 1].
+			/// getTaps() samples are read from data.
+			/// </summary>
+			template<typename V>
+			T interpolate(const T* data, double fraction) const noexcept
+			{
+				using namespace cpl::simd;
+
+				const T* row = table.data() + static_cast<std::size_t>(fraction * Phases + 0.5) * taps;
+
+				V sum = zero<V>();
+
+				for (std::size_t k = 0; k < taps; k += elements_of<V>::value)
+				{
+					sum = sum + loadu<V>(data + k) * load<V>(row + k);
+				}
+
+				suitable_container<V> lanes = sum;
+
+				return std::accumulate(lanes.begin(), lanes.end(), static_cast<T>(0));
+			}
+
+		private:
+
+			double lanczos(double x) const noexcept
+			{
+				const auto a = static_cast<double>(kernelSize);
+
+				if (x == 0)
+					return 1;
+
+				if (std::abs(x) >= a)
+					return 0;
+
+				const auto pix = cpl::simd::consts<double>::pi * x;
+
+				return a * std::sin(pix) * std::sin(pix / a) / (pix * pix);
+			}
+
+			std::size_t kernelSize = 0, taps = 0;
+			cpl::aligned_vector<T, 32> table;
+		};
+	};
+
+#endif
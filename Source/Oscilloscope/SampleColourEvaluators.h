@@ -149,6 +149,36 @@
 				return ret;
 			}
 
+			/// <summary>
+			/// Resolves the next samples from the current position into at most two contiguous spans,
+			/// without moving the evaluator. Requests larger than the buffer are clamped.
+			/// Returns the amount of spans.
+			/// </summary>
+			std::size_t resolveSpans(std::size_t samples, SampleSpan (&spans)[2]) const noexcept
+			{
+				samples = std::min<std::size_t>(samples, audioView.size());
+				const auto head = std::min<std::size_t>(samples, std::distance<AudioIt>(audioPointer, audioView.end()));
+
+				spans[0] = { audioPointer, audioPointer, head };
+
+				if (head == samples)
+					return 1;
+
+				spans[1] = { audioView.begin(), audioView.begin(), samples - head };
+				return 2;
+			}
+
+			template<typename V>
+			static V evaluateSpan(const SampleSpan& span, std::size_t offset) noexcept
+			{
+				return cpl::simd::loadu<V>(span.first + offset);
+			}
+
+			static AudioT evaluateSpan(const SampleSpan& span, std::size_t offset) noexcept
+			{
+				return span.first[offset];
+			}
+
 		private:
 
 			juce::Colour defaultKey;
@@ -286,6 +316,37 @@
 					return ret;
 				}
 
+				/// <summary>
+				/// Resolves the next samples from the current position into at most two contiguous spans,
+				/// without moving the evaluator. Requests larger than the buffer are clamped.
+				/// Returns the amount of spans.
+				/// </summary>
+				std::size_t resolveSpans(std::size_t samples, SampleSpan (&spans)[2]) const noexcept
+				{
+					samples = std::min<std::size_t>(samples, audioViewLeft.size());
+					const auto head = std::min<std::size_t>(samples, std::distance<AudioIt>(audioPointerLeft, audioViewLeft.end()));
+
+					spans[0] = { audioPointerLeft, audioPointerRight, head };
+
+					if (head == samples)
+						return 1;
+
+					spans[1] = { audioViewLeft.begin(), audioViewRight.begin(), samples - head };
+					return 2;
+				}
+
+				template<typename V>
+				static V evaluateSpan(const SampleSpan& span, std::size_t offset) noexcept
+				{
+					using cpl::simd::loadu;
+					return cpl::simd::consts<V>::half * BinaryFunction()(loadu<V>(span.first + offset), loadu<V>(span.second + offset));
+				}
+
+				static AudioT evaluateSpan(const SampleSpan& span, std::size_t offset) noexcept
+				{
+					return static_cast<AudioT>(0.5) * BinaryFunction()(span.first[offset], span.second[offset]);
+				}
+
 			private:
 
 				ChannelData::AudioBuffer::ProxyView audioViewLeft, audioViewRight;
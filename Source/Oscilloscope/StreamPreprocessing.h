@@ -33,16 +33,57 @@
 
 	#include "Signalizer.h"
 	#include "Oscilloscope.h"
-	#include <queue>
+	#include <array>
+	#include <algorithm>
+	#include <cmath>
+	#include <cpl/lib/variable_array.h>
 
 	namespace Signalizer
 	{
+		/// <summary>
+		/// Fixed capacity FIFO, that never allocates. Pushing into a full ring is ignored.
+		/// </summary>
+		template<typename T, std::size_t Capacity>
+		class FixedRing
+		{
+		public:
+
+			static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+			bool push(const T& value) noexcept
+			{
+				if (count == Capacity)
+					return false;
+
+				data[(first + count++) & (Capacity - 1)] = value;
+				return true;
+			}
+
+			void pop() noexcept
+			{
+				first = (first + 1) & (Capacity - 1);
+				count--;
+			}
+
+			const T& front() const noexcept { return data[first]; }
+			const T& operator [] (std::size_t index) const noexcept { return data[(first + index) & (Capacity - 1)]; }
+			std::size_t size() const noexcept { return count; }
+			void clear() noexcept { first = count = 0; }
+
+		private:
+
+			std::array<T, Capacity> data;
+			std::size_t first = 0, count = 0;
+		};
+
 		class TriggeringProcessor
 		{
 		public:
 
 			template<typename ISA> friend class SignalStreamBaseProcessor;
 
+			typedef FixedRing<std::uint64_t, 4096> PeakQueue;
+
 			void setSettings(OscilloscopeContent::TriggeringMode triggerMode, double newWindowSize, double valueThreshold, double newHysteresis)
 			{
 				triggerType = triggerMode;
@@ -77,6 +118,36 @@
 
 			template<typename ISA>
 			void processMutating(Oscilloscope::StreamState &o, const AudioStream::ListenerContext& ctx, AFloat** localPointers, std::size_t numChannels, std::size_t numSamples)
+			{
+				// the back buffer is sized for the anticipated block size when the stream changes,
+				// so blocks bigger than promised are processed in parts instead of growing it here
+				const auto headroom = o.channelData.getBackHeadroom();
+
+				// no room reserved yet, the stream hasn't been set up
+				if (headroom == 0)
+					return;
+
+				if (numSamples <= headroom)
+				{
+					processBlock<ISA>(o, ctx, localPointers, numChannels, numSamples);
+					return;
+				}
+
+				cpl::variable_array<AFloat*> part(localPointers, localPointers + numChannels);
+
+				for (std::size_t offset = 0; offset < numSamples; offset += headroom)
+				{
+					for (std::size_t c = 0; c < numChannels; ++c)
+						part[c] = localPointers[c] + offset;
+
+					processBlock<ISA>(o, ctx, part.data(), numChannels, std::min(headroom, numSamples - offset));
+				}
+			}
+
+		private:
+
+			template<typename ISA>
+			void processBlock(Oscilloscope::StreamState &o, const AudioStream::ListenerContext& ctx, AFloat** localPointers, std::size_t numChannels, std::size_t numSamples)
 			{
 				if (frontOrigin + bufferedSamples < steadyClock)
 				{
@@ -87,12 +158,13 @@
 				auto ceilingSize = std::ceil(windowSize);
 				auto halfSize = ceilingSize / 2;
 
+				// the whole block is processed into the back buffer once. the peak windowing below only moves a marker through it,
+				// so numSamples is the amount of samples in the back buffer that are ahead of the marker.
+				o.audioProcessing<ISA>(ctx.getInfo(), ctx.getPlayhead(), localPointers, numChannels, numSamples, o.channelData.back);
+
 				auto processIntoBackBuffer = [&](auto samples)
 				{
-					o.audioProcessing<ISA>(ctx.getInfo(), ctx.getPlayhead(), localPointers, numChannels, samples, o.channelData.back);
 					numSamples -= samples;
-					for (std::size_t c = 0; c < numChannels; ++c)
-						localPointers[c] += samples;
 
 					auto oldSamples = bufferedSamples;
 					steadyClock += samples;
@@ -104,7 +176,7 @@
 
 				if (ceilingSize == 0 && peaks.size())
 				{
-					std::queue<std::uint64_t>().swap(peaks);
+					peaks.clear();
 				}
 
 				while (numSamples != 0)
@@ -116,6 +188,10 @@
 					}
 					else if (!isWorkingOnPeak)
 					{
+						// candidates that are superseded by a newer one already in the past will never be displayed,
+						// so jump straight to the newest of them.
+						while (peaks.size() > 1 && peaks[1] < steadyClock)
+							peaks.pop();
 
 						isWorkingOnPeak = true;
 
@@ -193,7 +269,7 @@
 
 						auto cappedSize = std::min<std::size_t>(bufferedSamples, std::ceil(amount + 1));
 						// 1
-						o.channelData.swapBuffers(cappedSize, -(cpl::ssize_t)bufferedSamples);
+						o.channelData.swapBuffers(cappedSize, -(cpl::ssize_t)(bufferedSamples + numSamples));
 						// 2
 						bufferedSamples -= std::min<std::uint64_t>(bufferedSamples, cappedSize);
 						// 3
@@ -215,11 +291,12 @@
 			OscilloscopeContent::TriggeringMode triggerType;
 			std::uint64_t crossOrigin;
 			bool isPeakHold;
+			bool isArmed;
 			std::uint64_t oldPeak;
 			std::uint64_t currentPeak, bufferedSamples;
 			std::uint64_t frontOrigin;
 			std::uint64_t steadyClock;
-			std::queue<std::uint64_t> peaks;
+			PeakQueue peaks;
 			bool isWorkingOnPeak;
 
 
@@ -241,6 +318,7 @@
 				, hysteresis(outsideState.hysteresis)
 				, peaks(outsideState.peaks)
 				, crossOrigin(outsideState.crossOrigin)
+				, isArmed(outsideState.isArmed)
 			{
 
 			}
@@ -250,16 +328,55 @@
 				outsideState.state = state;
 				outsideState.isPeakHold = isPeakHolding;
 				outsideState.crossOrigin = crossOrigin;
+				outsideState.isArmed = isArmed;
 			}
 
 		protected:
 
+			/// <summary>
+			/// Blocks are scanned in chunks of this size, to rule out trigger events for the whole chunk at once.
+			/// </summary>
+			static constexpr std::size_t ChunkSize = 64;
+
+			struct Range
+			{
+				double min, max;
+			};
+
+			/// <summary>
+			/// Returns the smallest and largest sample of the chunk at offset.
+			/// </summary>
+			template<typename VectorLoad>
+			Range scanRange(std::size_t offset, VectorLoad vectorLoad) const noexcept
+			{
+				using namespace cpl::simd;
+				typedef typename ISA::V V;
+
+				constexpr std::size_t lanes = elements_of<V>::value;
+				static_assert(ChunkSize % lanes == 0, "Chunks must be a multiple of the vector size");
+
+				V hi = vectorLoad(offset);
+				V lo = zero<V>() - hi;
+
+				for (std::size_t i = lanes; i < ChunkSize; i += lanes)
+				{
+					const V x = vectorLoad(offset + i);
+					hi = max(hi, x);
+					lo = max(lo, zero<V>() - x);
+				}
+
+				suitable_container<V> his = hi, los = lo;
+
+				return { -static_cast<double>(*std::max_element(los.begin(), los.end())), static_cast<double>(*std::max_element(his.begin(), his.end())) };
+			}
+
 			std::size_t numSamples;
 			const std::uint64_t steadyClock;
 			std::uint64_t crossOrigin;
 			TriggeringProcessor & outsideState;
-			std::queue<std::uint64_t> & peaks;
+			TriggeringProcessor::PeakQueue & peaks;
 			bool isPeakHolding;
+			bool isArmed;
 			const double threshold, hysteresis;
 			double state;
 			std::size_t processedSamples;
@@ -275,12 +392,44 @@
 		    using SignalStreamBaseProcessor<ISA>::isPeakHolding;
 		    using SignalStreamBaseProcessor<ISA>::hysteresis;
 		    using SignalStreamBaseProcessor<ISA>::steadyClock;
+		    using SignalStreamBaseProcessor<ISA>::numSamples;
+		    using SignalStreamBaseProcessor<ISA>::ChunkSize;
 
 		public:
 			std::size_t count = 0;
 
 			using SignalStreamBaseProcessor<ISA>::SignalStreamBaseProcessor;
 
+			template<typename VectorLoad, typename ScalarLoad>
+				void processSpan(VectorLoad vectorLoad, ScalarLoad scalarLoad) noexcept
+			{
+				static const double chunkDecay = std::pow(Decay, ChunkSize);
+				const double floor = threshold * threshold;
+
+				std::size_t n = 0;
+
+				for (; n + ChunkSize <= numSamples; n += ChunkSize)
+				{
+					const auto range = this->scanRange(n, vectorLoad);
+					const auto peak = std::max(range.min * range.min, range.max * range.max);
+					const auto decayed = std::max(floor, state * chunkDecay);
+
+					// every sample in the chunk only decays the envelope, and no held peak can be released
+					if (!isPeakHolding && peak < std::min(state, decayed))
+					{
+						state = decayed;
+						count += ChunkSize;
+						continue;
+					}
+
+					for (std::size_t i = 0; i < ChunkSize; ++i)
+						process(scalarLoad(n + i));
+				}
+
+				for (; n < numSamples; ++n)
+					process(scalarLoad(n));
+			}
+
 			inline void process(double sample) noexcept
 			{
 				sample *= sample;
@@ -288,7 +437,7 @@
 
 				if (delta < 0)
 				{
-					state *= 0.9999;
+					state *= Decay;
 
 					state = std::max(threshold * threshold, state);
 
@@ -310,6 +459,9 @@
 				count++;
 			}
 
+		private:
+
+			static constexpr double Decay = 0.9999;
 		};
 
 		template<typename ISA>
@@ -322,16 +474,53 @@
 		    using SignalStreamBaseProcessor<ISA>::hysteresis;
 		    using SignalStreamBaseProcessor<ISA>::steadyClock;
 		    using SignalStreamBaseProcessor<ISA>::crossOrigin;
+		    using SignalStreamBaseProcessor<ISA>::isArmed;
+		    using SignalStreamBaseProcessor<ISA>::numSamples;
+		    using SignalStreamBaseProcessor<ISA>::ChunkSize;
 
 		public:
 			std::size_t count = 0;
 
 			using SignalStreamBaseProcessor<ISA>::SignalStreamBaseProcessor;
 
+			template<typename VectorLoad, typename ScalarLoad>
+				void processSpan(VectorLoad vectorLoad, ScalarLoad scalarLoad) noexcept
+			{
+				std::size_t n = 0;
+
+				for (; n + ChunkSize <= numSamples; n += ChunkSize)
+				{
+					const auto range = this->scanRange(n, vectorLoad);
+
+					const bool mayCross = range.max > 0 && (range.min < 0 || state < 0);
+					const bool mayRelease = isPeakHolding && range.max > threshold;
+
+					if (!mayCross && !mayRelease)
+					{
+						// without a crossing, the order of arming within the chunk doesn't matter
+						isArmed = isArmed || range.min < armLevel();
+						state = scalarLoad(n + ChunkSize - 1);
+						count += ChunkSize;
+						continue;
+					}
+
+					for (std::size_t i = 0; i < ChunkSize; ++i)
+						process(scalarLoad(n + i));
+				}
+
+				for (; n < numSamples; ++n)
+					process(scalarLoad(n));
+			}
+
 			inline void process(double sample) noexcept
 			{
-				if (sample > 0 && state < 0)
+				// the signal has to swing below the hysteresis before another rising crossing counts
+				if (sample < armLevel())
+					isArmed = true;
+
+				if (isArmed && sample > 0 && state < 0)
 				{
+					isArmed = false;
 					isPeakHolding = true;
 					crossOrigin = steadyClock + count;
 				}
@@ -346,6 +535,9 @@
 				count++;
 			}
 
+		private:
+
+			double armLevel() const noexcept { return -hysteresis * threshold; }
 		};
 
 	};
@@ -41,7 +41,16 @@ namespace Signalizer
 	extern std::string MainPresetName;
 	extern std::string DefaultPresetName;
 
-	constexpr int supportedChannels = 2;
+	constexpr int supportedChannels = MaxInputChannels;
+
+	/// <summary>
+	/// The channels presented for a number of host inputs: whole pairs, at most <see cref="supportedChannels"/>.
+	/// </summary>
+	static int activeChannelsFor(int inputs)
+	{
+		const auto pairs = std::max(1, (inputs + 1) / 2);
+		return std::min(pairs * 2, supportedChannels);
+	}
 
 	AudioProcessor::AudioProcessor()
 		: AudioProcessor(AudioStream::create(true, 16))
@@ -55,7 +64,8 @@ namespace Signalizer
 	}
 
 	AudioProcessor::AudioProcessor(AudioStream::IO&& io)
-		: config(std::make_shared<ConcurrentConfig>())
+		: scheduler(AnalysisScheduler::acquire())
+		, config(std::make_shared<ConcurrentConfig>())
 		, realtimeInput(std::move(std::get<0>(io)))
 		, realtimeOutput(std::get<1>(io))
 		, graph(std::make_shared<HostGraph>(std::get<1>(io)))
@@ -106,7 +116,7 @@ namespace Signalizer
 		realtimeInput.initializeInfo(
 			[&](AudioStream::ProducerInfo& info) 
 			{
-				info.channels = supportedChannels;
+				info.channels = activeChannels;
 				info.anticipatedSize = 512;
 				info.sampleRate = 48000;
 			}
@@ -138,12 +148,21 @@ namespace Signalizer
 	{
 		lastRecordedInputCount = getNumInputChannels();
 		lastRecordedBufferSize = samplesPerBlock;
-		surrogateArray.resize(samplesPerBlock);
+		activeChannels = activeChannelsFor(lastRecordedInputCount);
+
+		// only needed to complete a pair
+		if (activeChannels > lastRecordedInputCount)
+			surrogateArray.assign(samplesPerBlock, 0);
+		else
+			surrogateArray.clear();
+
+		graph->setNumChannels(activeChannels);
 
+		// listeners are informed of the new layout from here, instead of the audio thread
 		realtimeInput.initializeInfo(
 			[&](AudioStream::ProducerInfo& info)
 			{
-				info.channels = supportedChannels;
+				info.channels = activeChannels;
 				info.anticipatedSize = samplesPerBlock;
 				info.sampleRate = sampleRate;
 			}
@@ -175,11 +194,12 @@ namespace Signalizer
 
 		if (realtimeInput.isAnyoneListening())
 		{
-			// TODO: Fix this when the mix graph listener supports dynamically changing channels
+			// only the channels the host actually has are sent (see prepareToPlay()), so history and copies scale with the layout.
 			std::array<const float*, supportedChannels> inputs;
+			CPL_RUNTIME_ASSERTION(activeChannels <= supportedChannels);
 			auto readPointers = buffer.getArrayOfReadPointers();
 
-			const auto available = std::min(getNumInputChannels(), supportedChannels);
+			const auto available = std::min(getNumInputChannels(), activeChannels);
 
 			int i = 0;
 			for (; i < available; ++i)
@@ -187,15 +207,15 @@ namespace Signalizer
 				inputs[i] = readPointers[i];
 			}
 
-			for (; i < supportedChannels; ++i)
+			for (; i < activeChannels; ++i)
 			{
 				inputs[i] = surrogateArray.data();
 			}
 
 			if (auto ph = getPlayHead())
-				realtimeInput.processIncomingRTAudio(inputs.data(), supportedChannels, buffer.getNumSamples(), *ph);
+				realtimeInput.processIncomingRTAudio(inputs.data(), activeChannels, buffer.getNumSamples(), *ph);
 			else
-				realtimeInput.processIncomingRTAudio(inputs.data(), supportedChannels, buffer.getNumSamples(), AudioStream::Playhead::empty());
+				realtimeInput.processIncomingRTAudio(inputs.data(), activeChannels, buffer.getNumSamples(), AudioStream::Playhead::empty());
 		}
 
 		// In case we have more outputs than inputs, we'll clear any output
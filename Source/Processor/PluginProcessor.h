@@ -40,6 +40,7 @@
 	#include "../Common/HostGraph.h"
 	#include <memory>
 	#include "../Common/ConcurrentConfig.h"
+	#include "../Common/AnalysisScheduler.h"
 
 	namespace Signalizer
 	{
@@ -121,12 +122,20 @@
 			//==============================================================================
 			JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioProcessor)
 
+			/// <summary>
+			/// Declared first, so every view is gone before the pool may be.
+			/// </summary>
+			std::shared_ptr<AnalysisScheduler> scheduler;
 			std::shared_ptr<ConcurrentConfig> config;
 			AudioStream::Input realtimeInput;
 			std::shared_ptr<AudioStream::Output> realtimeOutput;
 			std::vector<AFloat> surrogateArray;
 			bool hasAnyLayoutBeenApplied{};
 			int lastRecordedInputCount{}, lastRecordedBufferSize{};
+			/// <summary>
+			/// The channels sent to the realtime stream, changed only in prepareToPlay().
+			/// </summary>
+			int activeChannels = 2;
 			ParameterMap parameterMap;
 			DecoupledStateObject<MainEditor> dsoEditor;
 			std::mutex editorCreationMutex;
@@ -64,6 +64,7 @@ namespace Signalizer
 		setOpaque(true);
 
 		content->getParameterSet().addRTListener(this, true);
+		setFrameActivity(processor->activity.getVersion());
 
 		initPanelAndControls();
 
@@ -103,6 +104,7 @@ namespace Signalizer
 	void Spectrum::resume()
 	{
 		processor->isSuspended = false;
+		invalidateFrame();
 		if (oldWindowSize != -1)
 		{
 			//TODO: possibly unsynchronized. fix to have an internal size instead
@@ -291,6 +293,8 @@ namespace Signalizer
 	void Spectrum::parameterChangedRT(cpl::Parameters::Handle localHandle, cpl::Parameters::Handle globalHandle, ParameterSet::BaseParameter * param)
 	{
 		using namespace cpl;
+		invalidateFrame();
+
 		// TODO: create parameter indices and turn into switch statement
 		if (param == &content->windowSize.parameter)
 		{
@@ -402,7 +406,12 @@ namespace Signalizer
 				calculateLegend |= assignAndChanged(stream.constant.colourSpecs[i + 1], ColourRotation(content->specColours[i].getAsJuceColour(), pairs, false));
 			}
 
+			const auto oldRatios = stream.constant.normalizedSpecRatios;
 			calculateSpectrumColourRatios(stream.constant);
+
+			// the gradient is painted in the overlay
+			if (oldRatios != stream.constant.normalizedSpecRatios)
+				overlay.invalidate();
 		}
 
 
@@ -526,6 +535,8 @@ namespace Signalizer
 			dbGraph.setLowerDbs(dynRange.low);
 			dbGraph.setUpperDbs(dynRange.high);
 			dbGraph.compileDivisions();
+			dbGrid.invalidate();
+			overlay.invalidate();
 		}
 
 
@@ -603,6 +614,10 @@ namespace Signalizer
 				complexFrequencyGraph.setDivisionLimit(divLimit);
 				complexFrequencyGraph.compileGraph();
 			}
+
+			frequencyGrid.invalidate();
+			spectrogramGrid.invalidate();
+			overlay.invalidate();
 		}
 
 		if (flags.resetStateBuffers.cas())
@@ -47,6 +47,11 @@
 	#include <cpl/dsp/SmoothedParameterState.h>
 	#include "TransformConstant.h"
 	#include "TransformPair.h"
+	#include "../Common/StreamedGeometry.h"
+	#include "../Common/CachedGeometry.h"
+	#include "../Common/OverlayLayer.h"
+	#include "../Common/RetainedFrame.h"
+	#include "../Common/AnalysisScheduler.h"
 	#include <cpl/lib/LockFreeDataQueue.h>
 
 	namespace cpl
@@ -131,6 +136,10 @@
                 void vectorGLRendering();
 
 			virtual void paint2DGraphics(juce::Graphics & g, const Constant& constant, /*const*/ TransformPair& primaryTransform);
+			/// <summary>
+			/// Paints the 2D graphics that only change with the view (axis labels, gradient and legend), into the overlay layer.
+			/// </summary>
+			void paintOverlay(juce::Graphics & g, const Constant& constant, bool showLegend);
 
 			virtual void parameterChangedRT(cpl::Parameters::Handle localHandle, cpl::Parameters::Handle globalHandle, ParameterSet::BaseParameter * param) override;
 
@@ -281,6 +290,12 @@
 
 				bool drawLegend{ };
 				LegendCache legend;
+				ChangeVersion::Listener legendChanged;
+				ConcurrentChangeVersion::Listener audioChanged;
+				/// <summary>
+				/// Seconds the line graphs may still be decaying after the last audio change.
+				/// </summary>
+				double remainingDecay = 0;
 			} state;
 
 
@@ -366,6 +381,10 @@
 				cpl::CLockFreeDataQueue<FrameVector> frameQueue;
 				CriticalSection<StreamState> streamState;
 				cpl::relaxed_atomic<bool> isSuspended;
+				/// <summary>
+				/// Bumped when incoming audio can change the display.
+				/// </summary>
+				AudioActivity activity;
 
 				void onStreamAudio(AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples) override;
 				void onStreamPropertiesChanged(AudioStream::ListenerContext& source, const AudioStream::AudioStreamInfo& before) override;
@@ -378,6 +397,10 @@
 			std::shared_ptr<const SharedBehaviour> globalBehaviour;			
 			std::shared_ptr<const ConcurrentConfig> config;
 			cpl::OpenGLRendering::COpenGLImage oglImage;
+			StreamedGeometry geometry;
+			CachedGeometry frequencyGrid, spectrogramGrid, dbGrid;
+			OverlayLayer overlay;
+			RetainedFrame retainedFrame;
 			cpl::special::FrequencyAxis frequencyGraph, complexFrequencyGraph;
 			cpl::special::DBMeterAxis dbGraph;
 
@@ -64,6 +64,8 @@ namespace Signalizer
 		{
 			CPL_RUNTIME_ASSERTION(numChannels % 2 == 0);
 
+			shell.activity.onAudio<ISA>(buffer, numChannels, numSamples, source.getInfo());
+
 			auto access = shell.streamState.lock();
 
 			if (numChannels < 2 || access->pairs.empty())
@@ -80,7 +82,7 @@ namespace Signalizer
 
 			const auto authorityCounter = access->pairs[0].processedSamplesSinceLastFrame;
 
-			cpl::jobs::parallel_for(
+			AnalysisScheduler::instance().parallel_for(
 				numChannels / 2,
 				[&](auto i)
 				{
@@ -96,7 +98,8 @@ namespace Signalizer
 						access->constant, 
 						views,
 						{ buffer[i * 2], buffer[i * 2 + 1] },
-						numSamples
+						numSamples,
+						shell.activity.isSettled(i * 2) && shell.activity.isSettled(i * 2 + 1)
 					);
 				}
 			);
@@ -220,6 +223,7 @@ namespace Signalizer
 		auto access = streamState.lock();
 
 		access->audioStreamChangeVersion.bump();
+		activity.touch();
 		access->streamLocalSampleRate = source.getInfo().sampleRate;
 
 		access->pairs.resize(source.getInfo().channels / 2);
@@ -243,10 +247,10 @@ namespace Signalizer
 
 	double Spectrum::getOptimalFramesPerUpdate() const noexcept
 	{
-#pragma message cwarn("collect this somewhere.")
-		const double monitorRefreshRate = 60.0;
-		auto res = double(isOpenGL() ? (monitorRefreshRate / getSwapInterval()) : refreshRate) / getBlobSamples();
-		assert(std::isnormal(res));
+		// the measured frame interval already includes the swap interval, and any frame rate limit
+		const double frameInterval = isOpenGL() ? globalBehaviour->frameInterval.load() : refreshRate * 0.001;
+		auto res = frameInterval * getSampleRate() / getBlobSamples();
+		assert(std::isfinite(res));
 		return res;
 	}
 
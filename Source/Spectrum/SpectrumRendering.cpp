@@ -72,7 +72,7 @@ namespace Signalizer
 		return buf;
 	}
 
-	void Spectrum::paint2DGraphics(juce::Graphics & g, const Constant& constant, TransformPair& primaryTransform)
+	void Spectrum::paintOverlay(juce::Graphics & g, const Constant& constant, bool showLegend)
 	{
 		// ------- draw frequency graph
 
@@ -146,6 +146,12 @@ namespace Signalizer
 			g.fillRect(0.0f, 0.0f, gradientWidth, (float)getHeight());
 		}
 
+		if (showLegend)
+			state.legend.paint(g, state.colourWidget, state.colourBackground);
+	}
+
+	void Spectrum::paint2DGraphics(juce::Graphics & g, const Constant& constant, TransformPair& primaryTransform)
+	{
 		float averageFps, averageCpu;
 
 		computeAverageStats(averageFps, averageCpu);
@@ -154,9 +160,6 @@ namespace Signalizer
 
 		if (mouseCheck)
 		{
-			if(globalBehaviour->showLegend)
-				state.legend.paint(g, state.colourWidget, state.colourBackground);
-
 			drawFrequencyTracking(g, averageFps, constant, primaryTransform);
 		}
 		
@@ -167,14 +170,15 @@ namespace Signalizer
 
 			g.setColour(juce::Colours::blue);
 			//TODO: ensure format specifiers are correct always (%llu mostly)
-			cpl::sprintfs(text, "%dx%d {%.3f, %.3f}: %.1f fps - %.1f%% cpu, deltaG = %.4f, deltaO = %.4f (rt: %.2f%% - %.2f%%, d: %llu), (as: %.2f%% - %.2f%%)",
+			cpl::sprintfs(text, "%dx%d {%.3f, %.3f}: %.1f fps - %.1f%% cpu, deltaG = %.4f, deltaO = %.4f (rt: %.2f%% - %.2f%%, d: %llu), (as: %.2f%% - %.2f%%), quality: %s",
 				getWidth(), getHeight(), state.viewRect.left, state.viewRect.right,
 				averageFps, averageCpu, graphicsDeltaTime(), openGLDeltaTime(),
 				100 * perf.producerUsage,
 				100 * perf.producerOverhead,
 				perf.droppedFrames,
 				100 * perf.consumerUsage,
-				100 * perf.consumerOverhead
+				100 * perf.consumerOverhead,
+				governor.getLevelName()
 			);
 
 			auto old = g.getCurrentFont();
@@ -576,6 +580,15 @@ namespace Signalizer
 	void Spectrum::closeOpenGL()
 	{
 		oglImage.offload();
+		geometry.release();
+		frequencyGrid.release();
+		spectrogramGrid.release();
+		dbGrid.release();
+		overlay.release();
+		retainedFrame.release();
+		// nothing is retained in the next context
+		invalidateFrame();
+		governor.reset();
 	}
 
     void Spectrum::onOpenGLRendering()
@@ -586,6 +599,49 @@ namespace Signalizer
     template<typename ISA>
     void Spectrum::vectorGLRendering()
 	{
+		auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
+
+		const bool showTracker = mouseCheck
+			&& state.frequencyTrackingGraph != SpectrumContent::LineGraphs::None
+			&& state.displayMode == SpectrumContent::DisplayMode::LineGraph;
+
+		const bool showDynamicGraphics = showTracker || content->diagnostics.getTransformedValue() > 0.5;
+
+		{
+			bool hasChanged = frameChanged.cas() | showDynamicGraphics;
+
+			if (state.audioChanged.consumeChanges(processor->activity.getVersion()))
+			{
+				double longestDecay = 0;
+
+				for (std::size_t i = 0; i < SpectrumContent::LineEnd; ++i)
+					longestDecay = std::max<double>(longestDecay, content->lines[i].decay.getTransformedValue());
+
+				// decays are specified to 10%, this is down to -120 dB
+				state.remainingDecay = 6 * longestDecay;
+				hasChanged = true;
+			}
+
+			if (state.displayMode == SpectrumContent::DisplayMode::LineGraph)
+			{
+				// the line graphs are filtered per frame, so they keep moving for a while after the audio settles
+				hasChanged |= state.remainingDecay > 0;
+				state.remainingDecay -= openGLDeltaTime();
+			}
+			else
+			{
+				// the colour spectrum scrolls as long as frames arrive, even if they are silent
+				hasChanged |= !state.isFrozen && getApproximateStoredFrames() > 0;
+			}
+
+			// nothing changed since the last frame, so present it again
+			if (!retainedFrame.begin(hasChanged, { (double)getWidth(), (double)getHeight(), oglc->getRenderingScale(), (double)globalBehaviour->showLegend, (double)mouseCheck }))
+			{
+				postFrame(false);
+				return;
+			}
+		}
+
         {
             // starting from a clean slate?
             CPL_DEBUGCHECKGL();
@@ -619,7 +675,12 @@ namespace Signalizer
 				{
 					auto views = audioStream->getAudioBufferViews();
 
-					cpl::jobs::parallel_for(
+					// a transform that can't start before the next frame is due keeps showing its last result
+					const auto deadline = AnalysisScheduler::Clock::now() + std::chrono::duration_cast<AnalysisScheduler::Clock::duration>(
+						std::chrono::duration<double>(globalBehaviour->frameInterval.load())
+					);
+
+					AnalysisScheduler::instance().parallel_for(
 						access->pairs.size(),
 						[&](std::size_t index)
 						{
@@ -630,7 +691,9 @@ namespace Signalizer
 								pair.mapToLinearSpace<ISA>(access->constant);
 								pair.postProcessStdTransform(access->constant);
 							}
-						}
+						},
+						1,
+						deadline
 					);
 				}
 
@@ -660,7 +723,27 @@ namespace Signalizer
 
             }
             
-			renderGraphics([&](juce::Graphics& g) { paint2DGraphics(g, access->constant, access->pairs[0]); });
+			const bool showLegend = mouseCheck && globalBehaviour->showLegend;
+
+			if (state.legendChanged.consumeChanges(state.legend.getVersion()))
+				overlay.invalidate();
+
+			// the axes invalidate the overlay as well, when they are recompiled
+			overlay.setRefreshInterval(governor.isReduced(QualityGovernor::ReducedOverlay) ? 8 : 1);
+			overlay.render(
+				getWidth(), getHeight(), oglc->getRenderingScale(),
+				{
+					(double)state.displayMode, (double)state.configuration, (double)showLegend,
+					(double)state.colourGrid.getARGB(), (double)state.colourWidget.getARGB(), (double)state.colourBackground.getARGB()
+				},
+				[&](juce::Graphics& g) { paintOverlay(g, access->constant, showLegend); }
+			);
+
+			retainedFrame.retain();
+
+			// only the frequency tracker and diagnostics change every frame
+			if (showDynamicGraphics)
+				renderGraphics([&](juce::Graphics& g) { paint2DGraphics(g, access->constant, access->pairs[0]); });
         }
 
 
@@ -685,7 +768,8 @@ namespace Signalizer
 				std::size_t processedFrames = 0;
 				auto approximateFrames = processedFrames + getApproximateStoredFrames();
 				localFrameZ1 = approximateFrames + content->frameUpdateSmoothing.getTransformedValue() * (framesPerUpdate - approximateFrames);
-				auto framesThisTime = cpl::Math::round<std::size_t>(framesPerUpdate);
+				// keep up with the rate frames arrive at for the display's frame rate, the smoothing only has to absorb jitter
+				auto framesThisTime = cpl::Math::round<std::size_t>(std::max(framesPerUpdate, getOptimalFramesPerUpdate()));
 
 				// if there's no buffer smoothing at all, we just capture every frame possible.
 				bool shouldCap = content->frameUpdateSmoothing.getTransformedValue() != 0.0;
@@ -766,27 +850,31 @@ namespace Signalizer
 
 		float gradientOffset = gradientWidth / getWidth() - 1.0f;
 
-		OpenGLRendering::PrimitiveDrawer<128> lineDrawer(ogs, GL_LINES);
-
-		lineDrawer.addColour(state.colourGrid.withMultipliedBrightness(0.5f));
-
-		for (auto dline : lines)
+		// the divisions themselves invalidate the grid when they are recompiled
+		if (auto lineDrawer = spectrogramGrid.rebuild(3, { (double)getWidth(), (double)getHeight(), (double)state.colourGrid.getARGB() }))
 		{
-			auto line = norm(dline);
-			lineDrawer.addVertex(gradientOffset, line, 0.0f);
-			lineDrawer.addVertex(gradientOffset + baseWidth * 0.7f, line, 0.0f);
-		}
+			lineDrawer->addColour(state.colourGrid.withMultipliedBrightness(0.5f));
+
+			for (auto dline : lines)
+			{
+				auto line = norm(dline);
+				lineDrawer->addVertex(gradientOffset, line, 0.0f);
+				lineDrawer->addVertex(gradientOffset + baseWidth * 0.7f, line, 0.0f);
+			}
 
-		lineDrawer.addColour(state.colourGrid);
-		const auto& divs = frequencyGraph.getDivisions();
+			lineDrawer->addColour(state.colourGrid);
+			const auto& divs = frequencyGraph.getDivisions();
 
-		for (auto& sdiv : divs)
-		{
-			auto line = norm(sdiv.coord);
-			lineDrawer.addVertex(gradientOffset, line, 0.0f);
-			lineDrawer.addVertex(gradientOffset + baseWidth, line, 0.0f);
+			for (auto& sdiv : divs)
+			{
+				auto line = norm(sdiv.coord);
+				lineDrawer->addVertex(gradientOffset, line, 0.0f);
+				lineDrawer->addVertex(gradientOffset + baseWidth, line, 0.0f);
+			}
 		}
 
+		spectrogramGrid.draw(GL_LINES);
+
 		CPL_DEBUGCHECKGL();
 	}
 
@@ -803,6 +891,29 @@ namespace Signalizer
 
 		// removes most of the weird black lines on flood fills.
 		ogs.disable(GL_MULTISAMPLE);
+		geometry.setAntialiasedLineWidth(0);
+
+		// the transform keeps its resolution, only fewer of the points are drawn.
+		// the last point is always included, so the graphs still reach the edge
+		const bool isDecimated = governor.isReduced(QualityGovernor::ReducedResolution);
+		const std::size_t stride = isDecimated ? 2 : 1;
+
+		auto forEachPoint = [&](auto&& f)
+		{
+			if (state.axisPoints == 0)
+				return;
+
+			std::size_t i = 0;
+
+			for (; i < state.axisPoints; i += stride)
+				f(i);
+
+			if (i - stride != state.axisPoints - 1)
+				f(state.axisPoints - 1);
+		};
+
+		// vertical lines would leave gaps between the decimated points, so they are filled as a strip instead
+		const GLenum fillMode = isDecimated ? GL_TRIANGLE_STRIP : GL_LINES;
 
 		if (state.alphaFloodFill != 0.0f)
 		{
@@ -818,15 +929,19 @@ namespace Signalizer
 				case SpectrumChannels::Phase:
 				case SpectrumChannels::Separate:
 				{
-					OpenGLRendering::PrimitiveDrawer<512> lineDrawer(ogs, GL_LINES);
+					auto & lineDrawer = geometry.begin(3);
 					lineDrawer.addColour(two[k].withAlpha(state.alphaFloodFill));
 					const auto&& results = transform.lineGraphs[k].getResults(state.axisPoints);
 
-					for (std::size_t i = 0; i < state.axisPoints; ++i)
-					{
-						lineDrawer.addVertex(i, results[i].rightMagnitude, -0.5);
-						lineDrawer.addVertex(i, endPoint, -0.5);
-					}
+					forEachPoint(
+						[&](std::size_t i)
+						{
+							lineDrawer.addVertex(i, results[i].rightMagnitude, -0.5);
+							lineDrawer.addVertex(i, endPoint, -0.5);
+						}
+					);
+
+					geometry.draw(fillMode);
 				}
 				// (fall-through intentional)
 				case SpectrumChannels::Left:
@@ -835,15 +950,19 @@ namespace Signalizer
 				case SpectrumChannels::Side:
 				case SpectrumChannels::Complex:
 				{
-					OpenGLRendering::PrimitiveDrawer<512> lineDrawer(ogs, GL_LINES);
+					auto & lineDrawer = geometry.begin(3);
 					lineDrawer.addColour(one[k].withAlpha(state.alphaFloodFill));
 					const auto&& results = transform.lineGraphs[k].getResults(state.axisPoints);
 
-					for (std::size_t i = 0; i < state.axisPoints; ++i)
-					{
-						lineDrawer.addVertex(i, results[i].leftMagnitude, 0);
-						lineDrawer.addVertex(i, endPoint, 0);
-					}
+					forEachPoint(
+						[&](std::size_t i)
+						{
+							lineDrawer.addVertex(i, results[i].leftMagnitude, 0);
+							lineDrawer.addVertex(i, endPoint, 0);
+						}
+					);
+
+					geometry.draw(fillMode);
 				}
 				default:
 					break;
@@ -851,11 +970,12 @@ namespace Signalizer
 			}
 		}
 
-		state.antialias ? ogs.enable(GL_MULTISAMPLE) : ogs.disable(GL_MULTISAMPLE);
+		state.antialias && !governor.isReduced(QualityGovernor::NoMultisampling) ? ogs.enable(GL_MULTISAMPLE) : ogs.disable(GL_MULTISAMPLE);
 
 		// render the line graphs
 		ogs.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
 		ogs.setLineSize(std::max(0.001f, static_cast<float>(oglc->getRenderingScale() * state.primitiveSize)));
+		geometry.setAntialiasedLineWidth(state.antialias ? std::max(0.001f, static_cast<float>(oglc->getRenderingScale() * state.primitiveSize)) : 0);
 		// draw back to front
 		for (int k = SpectrumContent::LineGraphs::LineEnd - 1; k >= 0; --k)
 		{
@@ -865,14 +985,13 @@ namespace Signalizer
 			case SpectrumChannels::Phase:
 			case SpectrumChannels::Separate:
 			{
-				OpenGLRendering::PrimitiveDrawer<256> lineDrawer(ogs, GL_LINE_STRIP);
+				auto & lineDrawer = geometry.begin(3);
 				lineDrawer.addColour(two[k]);
 				const auto&& results = transform.lineGraphs[k].getResults(state.axisPoints);
 
-				for (std::size_t i = 0; i < state.axisPoints; ++i)
-				{
-					lineDrawer.addVertex(i, results[i].rightMagnitude, -0.5);
-				}
+				forEachPoint([&](std::size_t i) { lineDrawer.addVertex(i, results[i].rightMagnitude, -0.5); });
+
+				geometry.draw(GL_LINE_STRIP);
 			}
 			// (fall-through intentional)
 			case SpectrumChannels::Left:
@@ -881,14 +1000,13 @@ namespace Signalizer
 			case SpectrumChannels::Side:
 			case SpectrumChannels::Complex:
 			{
-				OpenGLRendering::PrimitiveDrawer<256> lineDrawer(ogs, GL_LINE_STRIP);
+				auto & lineDrawer = geometry.begin(3);
 				lineDrawer.addColour(one[k]);
 				const auto&& results = transform.lineGraphs[k].getResults(state.axisPoints);
 
-				for (std::size_t i = 0; i < state.axisPoints; ++i)
-				{
-					lineDrawer.addVertex(i, results[i].leftMagnitude, 0);
-				}
+				forEachPoint([&](std::size_t i) { lineDrawer.addVertex(i, results[i].leftMagnitude, 0); });
+
+				geometry.draw(GL_LINE_STRIP);
 			}
 			default:
 				break;
@@ -913,12 +1031,13 @@ namespace Signalizer
 		//ogs.setBlender(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		ogs.setLineSize(std::max(0.001f, static_cast<float>(oglc->getRenderingScale())));
 
-		{
-			const float cscale = state.configuration == SpectrumChannels::Complex ? 2 : 1;
-			const float width = getWidth();
+		const float cscale = state.configuration == SpectrumChannels::Complex ? 2 : 1;
+		const float width = getWidth();
 
-			OpenGLRendering::PrimitiveDrawer<128> lineDrawer(ogs, GL_LINES);
-			lineDrawer.addColour(state.colourGrid.withMultipliedBrightness(0.5f));
+		// the divisions themselves invalidate the grids when they are recompiled
+		if (auto lineDrawer = frequencyGrid.rebuild(3, { (double)cscale, (double)width, (double)state.colourGrid.getARGB() }))
+		{
+			lineDrawer->addColour(state.colourGrid.withMultipliedBrightness(0.5f));
 
 			// draw vertical lines.
 			const auto& lines = frequencyGraph.getLines();
@@ -927,50 +1046,54 @@ namespace Signalizer
 			for (auto dline : lines)
 			{
 				auto line = cscale * static_cast<float>(dline);
-				lineDrawer.addVertex(line, -1.0f, 0.0f);
-				lineDrawer.addVertex(line, 1.0f, 0.0f);
+				lineDrawer->addVertex(line, -1.0f, 0.0f);
+				lineDrawer->addVertex(line, 1.0f, 0.0f);
 			}
 
 			for (auto dline : clines)
 			{
 				auto line = static_cast<float>(width - cscale * dline);
-				lineDrawer.addVertex(line, -1.0f, 0.0f);
-				lineDrawer.addVertex(line, 1.0f, 0.0f);
+				lineDrawer->addVertex(line, -1.0f, 0.0f);
+				lineDrawer->addVertex(line, 1.0f, 0.0f);
 			}
 
-			lineDrawer.addColour(state.colourGrid);
+			lineDrawer->addColour(state.colourGrid);
 			const auto& divs = frequencyGraph.getDivisions();
 			const auto& cdivs = complexFrequencyGraph.getDivisions();
 
 			for (auto& sdiv : divs)
 			{
 				auto line = cscale * static_cast<float>(sdiv.coord);
-				lineDrawer.addVertex(line, -1.0f, 0.0f);
-				lineDrawer.addVertex(line, 1.0f, 0.0f);
+				lineDrawer->addVertex(line, -1.0f, 0.0f);
+				lineDrawer->addVertex(line, 1.0f, 0.0f);
 			}
 
 			for (auto& sdiv : cdivs)
 			{
 				auto line = static_cast<float>(width - cscale * sdiv.coord);
-				lineDrawer.addVertex(line, -1.0f, 0.0f);
-				lineDrawer.addVertex(line, 1.0f, 0.0f);
+				lineDrawer->addVertex(line, -1.0f, 0.0f);
+				lineDrawer->addVertex(line, 1.0f, 0.0f);
 			}
 		}
 
+		frequencyGrid.draw(GL_LINES);
 
 		m.loadIdentityMatrix();
 
-		OpenGLRendering::PrimitiveDrawer<128> lineDrawer(ogs, GL_LINES);
-
-		lineDrawer.addColour(state.colourGrid.withMultipliedBrightness(0.5f));
-
-		// draw horizontal lines:
-		for (auto& dbDiv : dbGraph.getDivisions())
+		if (auto lineDrawer = dbGrid.rebuild(3, { (double)state.colourGrid.getARGB() }))
 		{
-			auto line = 1 - (float)dbDiv.fraction * 2;
-			lineDrawer.addVertex(-1.0f, line, 0.0f);
-			lineDrawer.addVertex(1.0f, line, 0.0f);
+			lineDrawer->addColour(state.colourGrid.withMultipliedBrightness(0.5f));
+
+			// draw horizontal lines:
+			for (auto& dbDiv : dbGraph.getDivisions())
+			{
+				auto line = 1 - (float)dbDiv.fraction * 2;
+				lineDrawer->addVertex(-1.0f, line, 0.0f);
+				lineDrawer->addVertex(1.0f, line, 0.0f);
+			}
 		}
+
+		dbGrid.draw(GL_LINES);
 	}
 
 };
@@ -1162,8 +1162,14 @@ namespace Signalizer
 
 	template<typename T>
 	template<typename ISA>
-	inline void TransformPair<T>::audioEntryPoint(const Constant& constant, const std::optional<AudioPair>& views, std::array<AFloat*, 2> buffer, std::size_t numSamples)
+	inline void TransformPair<T>::audioEntryPoint(const Constant& constant, const std::optional<AudioPair>& views, std::array<AFloat*, 2> buffer, std::size_t numSamples, bool isSettled)
 	{
+		// silence only decays the resonators further, so clear them once instead of running them
+		if (isSettled && !isResonatorCleared)
+			cresonator.resetState();
+
+		isResonatorCleared = isSettled;
+
 		if (constant.displayMode == SpectrumContent::DisplayMode::ColourSpectrum)
 		{
 			std::int64_t n = numSamples;
@@ -1175,7 +1181,7 @@ namespace Signalizer
 				const auto availableSamples = numRemainingSamples + std::min(std::int64_t(0), n - numRemainingSamples);
 
 				// do some resonation
-				if (constant.algo == SpectrumContent::TransformAlgorithm::RSNT)
+				if (constant.algo == SpectrumContent::TransformAlgorithm::RSNT && !isSettled)
 				{
 					resonatingDispatch<ISA>(constant, { buffer[0] + offset, buffer[1] + offset }, availableSamples);
 				}
@@ -1189,8 +1195,17 @@ namespace Signalizer
 					{
 						// the abstract timeline consists of the old data in the audio stream, with the following audio presented in this function.
 						// thus, the more we include of the buffer ('offbuf') the newer the data segment gets.
-						if ((transformReady = prepareTransform(constant, *views, buffer, availableSamples)))
+						if (isSettled)
+						{
+							// the transform of silence, without windowing and transforming it
+							auto transform = getAudioMemory<std::complex<T>>(constant.transformSize + 1);
+							for (std::size_t i = 0; i < constant.transformSize + 1; ++i)
+								transform[i] = 0;
+						}
+						else if ((transformReady = prepareTransform(constant, *views, buffer, availableSamples)))
+						{
 							doTransform(constant);
+						}
 					}
 
 					if (transformReady)
@@ -1203,7 +1218,7 @@ namespace Signalizer
 				n -= availableSamples;
 			}
 		}
-		else if (constant.algo == SpectrumContent::TransformAlgorithm::RSNT)
+		else if (constant.algo == SpectrumContent::TransformAlgorithm::RSNT && !isSettled)
 		{
 			resonatingDispatch<ISA>(constant, buffer, numSamples);
 		}
@@ -112,8 +112,12 @@ namespace Signalizer
 		template<typename ISA>
 		void resonatingDispatch(const Constant& constant, std::array<AFloat*, 2> buffer, std::size_t numSamples);
 
+		/// <summary>
+		/// If the pair is settled (see AudioActivity), the input and the audio history are known to be silent:
+		/// the resonator is cleared once and then left alone, and transforms of the history are known to be zero.
+		/// </summary>
 		template<typename ISA>
-		void audioEntryPoint(const Constant& constant, const std::optional<AudioPair>& pairs, std::array<AFloat*, 2> buffer, std::size_t numSamples);
+		void audioEntryPoint(const Constant& constant, const std::optional<AudioPair>& pairs, std::array<AFloat*, 2> buffer, std::size_t numSamples, bool isSettled);
 
 		/// <summary>
 		/// Maps the current resonating system according to the current model (linear/logarithmic) and the current
@@ -242,6 +246,10 @@ namespace Signalizer
 		/// </summary>
 		cpl::aligned_vector<std::complex<T>, 32> audioMemory;
 		cpl::dsp::CComplexResonator<T, 2> cresonator;
+		/// <summary>
+		/// Whether the resonator was cleared since the pair settled.
+		/// </summary>
+		bool isResonatorCleared = false;
 
 	};
 }
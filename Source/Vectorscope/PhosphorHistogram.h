@@ -0,0 +1,249 @@
+/*************************************************************************************
+
+	Signalizer - cross-platform audio visualization plugin - v. 0.x.y
+
+	Copyright (C) 2016 Janus Lynggaard Thorborg (www.jthorborg.com)
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	See \licenses\ for additional details on licenses associated with this program.
+
+**************************************************************************************
+
+	file:PhosphorHistogram.h
+
+		Decaying 2D intensity histograms of stereo pairs, for the phosphor display
+
+*************************************************************************************/
+
+#ifndef SIGNALIZER_PHOSPHORHISTOGRAM_H
+	#define SIGNALIZER_PHOSPHORHISTOGRAM_H
+
+	#include "Signalizer.h"
+	#include <cpl/simd.h>
+	#include <vector>
+	#include <algorithm>
+	#include <cmath>
+
+	namespace Signalizer
+	{
+		/// <summary>
+		/// A square grid of bins per stereo pair, covering [-1, 1] in both axes, that samples are accumulated into.
+		/// The histograms decay exponentially with time. Instead of decaying every bin for every sample,
+		/// new samples are weighted progressively heavier, and the grids are renormalized once the weight grows too large.
+		/// Not thread safe.
+		/// </summary>
+		class PhosphorHistogram
+		{
+		public:
+
+			static constexpr std::size_t Resolution = 256;
+
+			/// <summary>
+			/// How samples are placed in the grid. Lissajous mode rotates the (right, left) point,
+			/// polar mode wraps it around a half circle like VectorScope::drawPolarPlot.
+			/// </summary>
+			struct Mapping
+			{
+				AFloat gain, cosine, sine;
+				bool isPolar;
+			};
+
+			void resize(std::size_t pairs)
+			{
+				if (pairs == grids.size())
+					return;
+
+				grids.resize(pairs);
+
+				for (auto& grid : grids)
+					grid.resize(Resolution * Resolution);
+
+				clear();
+			}
+
+			void clear() noexcept
+			{
+				for (auto& grid : grids)
+					std::fill(grid.begin(), grid.end(), 0.0f);
+
+				weight = 1;
+			}
+
+			/// <summary>
+			/// Sets the time constant of the decay in samples.
+			/// </summary>
+			void setDecay(std::size_t samples) noexcept
+			{
+				growth = static_cast<AFloat>(std::exp(1.0 / std::max<std::size_t>(1, samples)));
+			}
+
+			std::size_t getNumPairs() const noexcept { return grids.size(); }
+
+			/// <summary>
+			/// Rows from the bottom (y = -1) and up.
+			/// </summary>
+			const AFloat* getBins(std::size_t pair) const noexcept { return grids[pair].data(); }
+
+			/// <summary>
+			/// Multiply bins by this to get the decayed intensity, in samples.
+			/// </summary>
+			AFloat getScale() const noexcept { return 1 / weight; }
+
+			/// <summary>
+			/// Accumulates a block of a stereo pair. Call advance() once every pair of the block has been accumulated.
+			/// </summary>
+			template<typename ISA>
+			void accumulate(std::size_t pair, const AFloat* left, const AFloat* right, std::size_t numSamples, const Mapping& mapping)
+			{
+				using namespace cpl::simd;
+				using cpl::simd::abs;
+				typedef typename ISA::V V;
+
+				constexpr std::size_t lanes = elements_of<V>::value;
+
+				auto& grid = grids[pair];
+
+				const V vHalfResolution = set1<V>(Resolution * 0.5f);
+				const V vGain = set1<V>(mapping.gain);
+				const V vCosine = set1<V>(mapping.cosine);
+				const V vSine = set1<V>(mapping.sine);
+				const V vPolarCosine = consts<V>::sqrt_half_two_minus;
+				const V vPolarSine = consts<V>::sqrt_half_two;
+				const V vZero = zero<V>();
+
+				suitable_container<V> weights, xs, ys;
+
+				for (std::size_t i = 0; i < lanes; ++i)
+					weights[i] = weight * std::pow(growth, static_cast<AFloat>(i));
+
+				V vWeight = weights;
+				const V vGrowth = set1<V>(std::pow(growth, static_cast<AFloat>(lanes)));
+
+				auto scatter = [&](AFloat x, AFloat y, AFloat w)
+				{
+					// written to also reject nans
+					if (!(x >= 0 && y >= 0 && x < Resolution && y < Resolution))
+						return;
+
+					grid[static_cast<std::size_t>(y) * Resolution + static_cast<std::size_t>(x)] += w;
+				};
+
+				std::size_t n = 0;
+
+				for (; n + lanes <= numSamples; n += lanes)
+				{
+					V vLeft = loadu<V>(left + n);
+					V vRight = loadu<V>(right + n);
+					V vX, vY;
+
+					if (!mapping.isPolar)
+					{
+						vX = vRight * vCosine - vLeft * vSine;
+						vY = vRight * vSine + vLeft * vCosine;
+					}
+					else
+					{
+						// see drawPolarPlot
+						const V vLength = max(abs(vLeft), abs(vRight));
+
+						vY = vLeft * vPolarCosine - vRight * vPolarSine;
+						vX = vLeft * vPolarSine + vRight * vPolarCosine;
+
+						vLeft = (vLeft == vZero);
+						vRight = (vRight == vZero);
+						const auto vMask = vnot(vand(vLeft, vRight));
+
+						const auto vAngle = vand(vMask, atan(vX / vY));
+						sincos(vAngle, &vX, &vY);
+
+						vX = vX * vLength;
+						vY = vY * vLength;
+					}
+
+					// to bin coordinates
+					xs = (vX * vGain + consts<V>::one) * vHalfResolution;
+					ys = (vY * vGain + consts<V>::one) * vHalfResolution;
+					weights = vWeight;
+
+					for (std::size_t i = 0; i < lanes; ++i)
+						scatter(xs[i], ys[i], weights[i]);
+
+					vWeight = vWeight * vGrowth;
+				}
+
+				weights = vWeight;
+				AFloat w = weights[0];
+
+				for (; n < numSamples; ++n)
+				{
+					AFloat x, y;
+
+					if (!mapping.isPolar)
+					{
+						x = right[n] * mapping.cosine - left[n] * mapping.sine;
+						y = right[n] * mapping.sine + left[n] * mapping.cosine;
+					}
+					else
+					{
+						const auto cosine = consts<AFloat>::sqrt_half_two_minus;
+						const auto sine = consts<AFloat>::sqrt_half_two;
+						const auto length = std::max(std::abs(left[n]), std::abs(right[n]));
+
+						const auto rotatedY = left[n] * cosine - right[n] * sine;
+						const auto rotatedX = left[n] * sine + right[n] * cosine;
+
+						auto angle = std::atan(rotatedX / rotatedY);
+						angle = (left[n] == 0 && right[n] == 0) ? 0 : angle;
+
+						x = std::sin(angle) * length;
+						y = std::cos(angle) * length;
+					}
+
+					scatter((x * mapping.gain + 1) * Resolution * 0.5f, (y * mapping.gain + 1) * Resolution * 0.5f, w);
+					w *= growth;
+				}
+			}
+
+			/// <summary>
+			/// Moves time forward by a block.
+			/// </summary>
+			void advance(std::size_t numSamples) noexcept
+			{
+				weight *= std::pow(growth, static_cast<AFloat>(numSamples));
+
+				if (weight < RenormalizationLimit)
+					return;
+
+				const auto scale = 1 / weight;
+
+				for (auto& grid : grids)
+				{
+					for (auto& bin : grid)
+						bin *= scale;
+				}
+
+				weight = 1;
+			}
+
+		private:
+
+			static constexpr AFloat RenormalizationLimit = 1e12f;
+
+			std::vector<cpl::aligned_vector<AFloat, 32>> grids;
+			AFloat weight = 1, growth = 1;
+		};
+	};
+
+#endif
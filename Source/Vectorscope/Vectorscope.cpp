@@ -46,6 +46,7 @@ namespace Signalizer
 
 	const double VectorScope::lowerAutoGainBounds = cpl::Math::dbToFraction(-120.0);
 	const double VectorScope::higherAutoGainBounds = cpl::Math::dbToFraction(120.0);
+	constexpr std::size_t VectorScope::MaxPairs;
 
 
 	VectorScope::VectorScope(
@@ -64,6 +65,7 @@ namespace Signalizer
 	{
 		mtFlags.firstRun = true;
 		setOpaque(true);
+		setFrameActivity(processor->activity.getVersion());
 
 		initPanelAndControls();
 		stream->addListener(processor);
@@ -79,6 +81,7 @@ namespace Signalizer
 	{
 		mtFlags.initiateWindowResize = true;
 		processor->isSuspended = false;
+		invalidateFrame();
 	}
 
 	juce::Component * VectorScope::getWindow()
@@ -186,6 +189,8 @@ namespace Signalizer
 
 	void VectorScope::parameterChangedRT(cpl::Parameters::Handle localHandle, cpl::Parameters::Handle globalHandle, ParameterSet::BaseParameter * param)
 	{
+		invalidateFrame();
+
 		if (param == &content->windowSize.parameter)
 		{
 			mtFlags.initiateWindowResize = true;
@@ -211,6 +216,12 @@ namespace Signalizer
 		state.userGain = content->inputGain.getTransformedValue();
 		state.drawLegend = content->showLegend.getTransformedValue() > 0.5;
 		state.scalePolar = content->scalePolarModeToFill.getTransformedValue() > 0.5;
+		state.phosphor = content->phosphorDisplay.getTransformedValue() > 0.5;
+
+		processor->isPhosphor = state.phosphor;
+		processor->isPolar = state.isPolar;
+		processor->rotation = state.rotation;
+		processor->userGain = static_cast<float>(state.userGain);
 
 		calculateLegend |= assignAndChanged(state.colourWaveform, content->waveformColour.getAsJuceColour());
 		state.colourWire = content->wireframeColour.getAsJuceColour();
@@ -249,6 +260,50 @@ namespace Signalizer
 			recalculateLegend();
 	}
 
+	void VectorScope::AudioSnapshot::copyFrom(const AudioStream::AudioBufferAccess& access, bool copySamples, std::size_t stride)
+	{
+		numChannels = access.getNumChannels();
+		numSamples = numChannels ? access.getView(0).size() : 0;
+
+		if (!copySamples)
+			return;
+
+		channels.resize(std::max(channels.size(), numChannels));
+
+		for (std::size_t c = 0; c < numChannels; ++c)
+		{
+			const auto view = access.getView(c);
+			auto& channel = channels[c];
+
+			channel.resize(numSamples);
+
+			std::size_t position = 0;
+
+			for (std::size_t section = 0; section < AudioStream::bufferIndices; ++section)
+			{
+				const auto range = static_cast<std::size_t>(view.getItRange(section));
+				std::copy(view.getItIndex(section), view.getItIndex(section) + range, channel.begin() + position);
+				position += range;
+			}
+		}
+
+		if (stride <= 1 || numSamples == 0)
+			return;
+
+		const auto first = (numSamples - 1) % stride;
+		const auto decimated = (numSamples - 1) / stride + 1;
+
+		for (std::size_t c = 0; c < numChannels; ++c)
+		{
+			auto& channel = channels[c];
+
+			for (std::size_t n = 0; n < decimated; ++n)
+				channel[n] = channel[first + n * stride];
+		}
+
+		numSamples = decimated;
+	}
+
 	void VectorScope::recalculateLegend()
 	{
 		state.legend.reset({ 10, 10 });
@@ -266,7 +321,7 @@ namespace Signalizer
 
 
 	template<typename ISA>
-		void VectorScope::Processor::audioProcessing(AudioStream::DataType ** buffer, std::size_t numChannels, std::size_t numSamples)
+		void VectorScope::Processor::audioProcessing(AudioStream::DataType ** buffer, std::size_t numChannels, std::size_t numSamples, std::size_t historySize)
 		{
 			typedef typename ISA::V V;
 			using namespace cpl::simd;
@@ -274,104 +329,287 @@ namespace Signalizer
 			if (numChannels < 2)
 				return;
 
-			T filterEnv[2] { filters.envelope[0], filters.envelope[1] };
-			T balance[2][2]{ { filters.balance[0][0], filters.balance[0][1] }, { filters.balance[1][0], filters.balance[1][1] } };
-			T phase[2] { filters.phase[0], filters.phase[1] };
+			const std::size_t pairs = std::min(numChannels / 2, MaxPairs);
+			numPairs = pairs;
+
+			if (envelopeMode == EnvelopeModes::PeakDecay)
+			{
+				for (std::size_t c = 0; c < pairs * 2; ++c)
+				{
+					peakTrackers[c].setWindow(historySize);
+
+					if (activity.isSilent(c))
+						peakTrackers[c].writeSilence(numSamples);
+					else
+						peakTrackers[c].write<ISA>(buffer[c], numSamples);
+
+					filters[c / 2].peak[c % 2] = peakTrackers[c].getPeak();
+				}
+			}
+
+			if (isPhosphor)
+			{
+				// don't display whatever was left from the last time
+				if (!wasPhosphor)
+					phosphor.clear();
+
+				phosphor.setDecay(historySize);
+
+				const auto angle = rotation * consts<T>::tau;
+
+				const PhosphorHistogram::Mapping mapping {
+					static_cast<AFloat>(envelopeGain * userGain), std::cos(angle), std::sin(angle), isPolar
+				};
+
+				const auto histograms = std::min(pairs, phosphor.getNumPairs());
+
+				for (std::size_t p = 0; p < histograms; ++p)
+					phosphor.accumulate<ISA>(p, buffer[p * 2], buffer[p * 2 + 1], numSamples, mapping);
+
+				phosphor.advance(numSamples);
+
+				if (isPhosphorFrameWanted)
+				{
+					std::unique_lock<std::mutex> lock(phosphorMutex, std::try_to_lock);
+
+					if (lock.owns_lock())
+					{
+						constexpr std::size_t numBins = PhosphorHistogram::Resolution * PhosphorHistogram::Resolution;
+						auto& frame = phosphorFrame;
+
+						frame.numPairs = std::min(histograms, frame.bins.size() / numBins);
+						frame.scale = phosphor.getScale();
+
+						for (std::size_t p = 0; p < frame.numPairs; ++p)
+							std::copy(phosphor.getBins(p), phosphor.getBins(p) + numBins, frame.bins.begin() + p * numBins);
+
+						isPhosphorFrameWanted = false;
+					}
+				}
+			}
+
+			wasPhosphor = isPhosphor;
+
+			using fs = FilterStates;
 
 			const T stereoPoles[2] = { stereoCoeff, std::pow(stereoCoeff, secondStereoFilterSpeed) };
-			const T envelope = envelopeCoeff;
+			const V vEnvelope = set1<V>(envelopeCoeff);
+			const V vSlowPole = set1<V>(stereoPoles[fs::Slow]);
+			const V vFastPole = set1<V>(stereoPoles[fs::Fast]);
 			const V vMatrixReal = consts<V>::sqrt_half_two_minus;
 			const V vMatrixImag = consts<V>::sqrt_half_two;
 
 			const V vDummyAngle = consts<V>::pi_quarter;
 			const V vZero = zero<V>();
 
-			auto const loopIncrement = elements_of<V>::value;
+			constexpr std::size_t lanes = elements_of<V>::value;
+			constexpr std::size_t chunkSize = ScratchChunk;
 
 			// ensure a perfect multiple and no buffer overrun
-			numSamples -= numSamples & (loopIncrement - 1);
+			numSamples -= numSamples & (lanes - 1);
 
-			suitable_container<V> outputPhases;
+			const std::size_t groups = (pairs + lanes - 1) / lanes;
+			const std::size_t scratchSize = 3 * chunkSize * lanes;
 
-			for (std::size_t n = 0; n < numSamples; n += loopIncrement)
-			{
-				// some of the heavy math done in vector mode..
-				const V vLeft = loadu<V>(buffer[0] + n);
-				const V vRight = loadu<V>(buffer[1] + n);
-
-				// rotate 235 degrees...
-				const V vX = vLeft * vMatrixReal - vRight * vMatrixImag;
-				const V vY = vRight * vMatrixImag + vLeft * vMatrixReal;
+			static_assert(lanes <= MaxLanes && MaxLanes % lanes == 0, "Scratch space isn't sized for this vector width");
 
-				// check if both axes are zero
-				const V vZeroAxes = vand((V)(vX == vZero), (V)(vY == vZero));
+			if (!NONTERMINAL_ASSUMPTION(pairScratch.size() >= scratchSize * groups))
+				return;
 
-				// compute the phase angle and replace the zero vector elements with the dummy angle (to avoid nans, +/-infs are defined)
-				const V vRadians = atan(vY / vX);
-				const V vPhaseAngle = vselect(vDummyAngle, vRadians, vZeroAxes);
+			T highestEnvelope = 0;
 
-				// the phase angle is discontinuous around PI, so we take the cosine
-				// to avoid the discontinuity and give a small smoothing
+			// silent input only decays the filters, which is a single power of the poles for the whole block
+			const bool isSilent = activity.allSilent();
 
-				outputPhases = cos(vPhaseAngle * consts<V>::two);
+			if (isSilent)
+			{
+				const auto samples = static_cast<T>(numSamples);
+				const T envelopeDecay = std::pow(static_cast<T>(envelopeCoeff), samples);
+				const T stereoDecays[2] = { std::pow(stereoPoles[fs::Slow], samples), std::pow(stereoPoles[fs::Fast], samples) };
 
-				// scalar code segment for recursive IIR filters..
-				for (std::size_t i = 0; i < loopIncrement; ++i)
+				for (std::size_t p = 0; p < pairs; ++p)
 				{
-					auto const z = n + i;
-					// collect squared inputs (really just a cheap abs)
-					const auto lSquared = buffer[0][z] * buffer[0][z];
-					const auto rSquared = buffer[1][z] * buffer[1][z];
+					auto& f = filters[p];
+
+					for (std::size_t i = 0; i < 2; ++i)
+					{
+						f.phase[i] = f.phase[i] * stereoDecays[i];
+						for (std::size_t j = 0; j < 2; ++j)
+							f.balance[i][j] = f.balance[i][j] * stereoDecays[i];
+					}
+
+					if (envelopeMode == EnvelopeModes::RMS && normalizeGain)
+					{
+						for (std::size_t i = 0; i < 2; ++i)
+						{
+							f.envelope[i] = f.envelope[i] * envelopeDecay;
+							highestEnvelope = std::max<T>(highestEnvelope, f.envelope[i]);
+						}
+					}
+				}
+			}
 
-					// average envelope
-					filterEnv[0] = lSquared + envelope * (filterEnv[0] - lSquared);
-					filterEnv[1] = rSquared + envelope * (filterEnv[1] - rSquared);
+			cpl::variable_array<T> groupEnvelopes(groups);
+
+			// the recursive filters of a group of pairs run side by side, one pair in each lane.
+			// groups share nothing but the input, so wide layouts run the groups on separate cores.
+			auto processGroup = [&](std::size_t groupIndex)
+			{
+				const std::size_t group = groupIndex * lanes;
+				const std::size_t groupPairs = std::min(lanes, pairs - group);
 
-					// balance average source
+				T * const leftSquares = pairScratch.data() + groupIndex * scratchSize;
+				T * const rightSquares = leftSquares + chunkSize * lanes;
+				T * const phases = rightSquares + chunkSize * lanes;
 
-					using fs = FilterStates;
+				T groupEnvelope = 0;
 
-					balance[fs::Slow][fs::Left]  = lSquared + stereoPoles[fs::Slow] * (balance[fs::Slow][fs::Left]  - lSquared);
-					balance[fs::Slow][fs::Right] = rSquared + stereoPoles[fs::Slow] * (balance[fs::Slow][fs::Right] - rSquared);
-					balance[fs::Fast][fs::Left]  = lSquared + stereoPoles[fs::Fast] * (balance[fs::Fast][fs::Left]  - lSquared);
-					balance[fs::Fast][fs::Right] = rSquared + stereoPoles[fs::Fast] * (balance[fs::Fast][fs::Right] - rSquared);
+				suitable_container<V> envelopes[2], balances[2][2], phaseStates[2];
 
-					// phase averaging
-					phase[fs::Slow] = outputPhases[i] + stereoPoles[fs::Slow] * (phase[fs::Slow] - outputPhases[i]);
-					phase[fs::Fast] = outputPhases[i] + stereoPoles[fs::Fast] * (phase[fs::Fast] - outputPhases[i]);
+				for (std::size_t l = 0; l < lanes; ++l)
+				{
+					const bool isActive = l < groupPairs;
+					const auto& f = filters[isActive ? group + l : 0];
+
+					for (std::size_t i = 0; i < 2; ++i)
+					{
+						envelopes[i][l] = isActive ? f.envelope[i] : 0;
+						phaseStates[i][l] = isActive ? f.phase[i] : 0;
+						for (std::size_t j = 0; j < 2; ++j)
+							balances[i][j][l] = isActive ? f.balance[i][j] : 0;
+					}
 				}
 
-			}
+				V vEnvelopes[2] { envelopes[fs::Left], envelopes[fs::Right] };
+				V vBalances[2][2] {
+					{ balances[fs::Slow][fs::Left], balances[fs::Slow][fs::Right] },
+					{ balances[fs::Fast][fs::Left], balances[fs::Fast][fs::Right] }
+				};
+				V vPhases[2] { phaseStates[fs::Slow], phaseStates[fs::Fast] };
 
-			// store calculated envelope
-			if (envelopeMode == EnvelopeModes::RMS && normalizeGain)
-			{
-				// we end up calculating envelopes even though its not possibly needed, but the overhead
-				// is negligible
-				double currentEnvelope = 1.0 / (std::max(std::sqrt(filterEnv[0]), std::sqrt(filterEnv[1])));
+				// lanes without a pair are never stored, but keep them free of garbage
+				std::fill(leftSquares, leftSquares + scratchSize, T(0));
+
+				for (std::size_t offset = 0; offset < numSamples; offset += chunkSize)
+				{
+					const auto chunk = std::min(chunkSize, numSamples - offset);
+
+					for (std::size_t l = 0; l < groupPairs; ++l)
+					{
+						const T * left = buffer[(group + l) * 2] + offset;
+						const T * right = buffer[(group + l) * 2 + 1] + offset;
+
+						for (std::size_t n = 0; n < chunk; n += lanes)
+						{
+							// some of the heavy math done in vector mode..
+							const V vLeft = loadu<V>(left + n);
+							const V vRight = loadu<V>(right + n);
+
+							// rotate 235 degrees...
+							const V vX = vLeft * vMatrixReal - vRight * vMatrixImag;
+							const V vY = vRight * vMatrixImag + vLeft * vMatrixReal;
+
+							// check if both axes are zero
+							const V vZeroAxes = vand((V)(vX == vZero), (V)(vY == vZero));
+
+							// compute the phase angle and replace the zero vector elements with the dummy angle (to avoid nans, +/-infs are defined)
+							const V vRadians = atan(vY / vX);
+							const V vPhaseAngle = vselect(vDummyAngle, vRadians, vZeroAxes);
+
+							// the phase angle is discontinuous around PI, so we take the cosine
+							// to avoid the discontinuity and give a small smoothing
+							suitable_container<V>
+								outputPhases = cos(vPhaseAngle * consts<V>::two),
+								// collect squared inputs (really just a cheap abs)
+								outputLeft = vLeft * vLeft,
+								outputRight = vRight * vRight;
+
+							// transpose into the lane of this pair
+							for (std::size_t i = 0; i < lanes; ++i)
+							{
+								leftSquares[(n + i) * lanes + l] = outputLeft[i];
+								rightSquares[(n + i) * lanes + l] = outputRight[i];
+								phases[(n + i) * lanes + l] = outputPhases[i];
+							}
+						}
+					}
+
+					// recursive IIR filters, every pair at once
+					for (std::size_t n = 0; n < chunk; ++n)
+					{
+						const V lSquared = load<V>(leftSquares + n * lanes);
+						const V rSquared = load<V>(rightSquares + n * lanes);
+						const V vPhase = load<V>(phases + n * lanes);
+
+						// average envelope
+						vEnvelopes[fs::Left] = lSquared + vEnvelope * (vEnvelopes[fs::Left] - lSquared);
+						vEnvelopes[fs::Right] = rSquared + vEnvelope * (vEnvelopes[fs::Right] - rSquared);
+
+						// balance average source
+						vBalances[fs::Slow][fs::Left]  = lSquared + vSlowPole * (vBalances[fs::Slow][fs::Left]  - lSquared);
+						vBalances[fs::Slow][fs::Right] = rSquared + vSlowPole * (vBalances[fs::Slow][fs::Right] - rSquared);
+						vBalances[fs::Fast][fs::Left]  = lSquared + vFastPole * (vBalances[fs::Fast][fs::Left]  - lSquared);
+						vBalances[fs::Fast][fs::Right] = rSquared + vFastPole * (vBalances[fs::Fast][fs::Right] - rSquared);
+
+						// phase averaging
+						vPhases[fs::Slow] = vPhase + vSlowPole * (vPhases[fs::Slow] - vPhase);
+						vPhases[fs::Fast] = vPhase + vFastPole * (vPhases[fs::Fast] - vPhase);
+					}
+				}
 
-				// only envelope filters if this mode is on.
 				for (std::size_t i = 0; i < 2; ++i)
 				{
-					filters.envelope[i] = filterEnv[i];
-					filters.phase[i] = phase[i];
+					envelopes[i] = vEnvelopes[i];
+					phaseStates[i] = vPhases[i];
 					for (std::size_t j = 0; j < 2; ++j)
-						filters.balance[i][j] = balance[i][j];
+						balances[i][j] = vBalances[i][j];
 				}
-				
-				if (std::isnormal(currentEnvelope))
+
+				for (std::size_t l = 0; l < groupPairs; ++l)
 				{
-					envelopeGain = currentEnvelope;
+					auto& f = filters[group + l];
+
+					for (std::size_t i = 0; i < 2; ++i)
+					{
+						f.phase[i] = phaseStates[i][l];
+						for (std::size_t j = 0; j < 2; ++j)
+							f.balance[i][j] = balances[i][j][l];
+					}
+
+					// only envelope filters if this mode is on.
+					if (envelopeMode == EnvelopeModes::RMS && normalizeGain)
+					{
+						for (std::size_t i = 0; i < 2; ++i)
+						{
+							f.envelope[i] = envelopes[i][l];
+							groupEnvelope = std::max(groupEnvelope, envelopes[i][l]);
+						}
+					}
 				}
+
+				groupEnvelopes[groupIndex] = groupEnvelope;
+			};
+
+			if (!isSilent)
+			{
+				if (groups > 1)
+					AnalysisScheduler::instance().parallel_for(groups, processGroup);
+				else
+					processGroup(0);
+
+				for (std::size_t g = 0; g < groups; ++g)
+					highestEnvelope = std::max(highestEnvelope, groupEnvelopes[g]);
 			}
-			else
+
+			// store calculated envelope
+			if (envelopeMode == EnvelopeModes::RMS && normalizeGain)
 			{
-				// only envelope filters if this mode is on.
-				for (std::size_t i = 0; i < 2; ++i)
+				// every pair is drawn with the same gain, so the loudest one decides it
+				double currentEnvelope = 1.0 / std::sqrt(highestEnvelope);
+
+				if (std::isnormal(currentEnvelope))
 				{
-					filters.phase[i] = phase[i];
-					for (std::size_t j = 0; j < 2; ++j)
-						filters.balance[i][j] = balance[i][j];
+					envelopeGain = currentEnvelope;
 				}
 			}
 		}
@@ -381,15 +619,29 @@ namespace Signalizer
 		if (isSuspended && globalBehaviour->stopProcessingOnSuspend)
 			return;
 
-		cpl::simd::dynamic_isa_dispatch<AFloat, AudioDispatcher>(*this, buffer, numChannels, numSamples);
+		cpl::simd::dynamic_isa_dispatch<AFloat, AudioDispatcher>(*this, source, buffer, numChannels, numSamples);
 	}
 
 	void VectorScope::Processor::onStreamPropertiesChanged(AudioStream::ListenerContext& ctx, const AudioStream::AudioStreamInfo & before)
 	{
 		streamPropertiesChanged = true;
+		activity.touch();
 		auto stream = streamState.lock();
 		stream->channelNames = ctx.getChannelNames();
 		stream->numChannels = ctx.getInfo().channels;
+
+		// sized here, so the audio processing never allocates
+		const auto pairs = std::min(stream->numChannels / 2, MaxPairs);
+
+		phosphor.resize(pairs);
+
+		// rounding the pairs up to the widest vector covers the groups of any narrower one as well
+		pairScratch.resize(3 * ScratchChunk * MaxLanes * ((pairs + MaxLanes - 1) / MaxLanes));
+
+		std::lock_guard<std::mutex> lock(phosphorMutex);
+		phosphorFrame.bins.resize(pairs * PhosphorHistogram::Resolution * PhosphorHistogram::Resolution);
+		phosphorFrame.numPairs = 0;
+		isPhosphorFrameWanted = true;
 	}
 
 };
@@ -35,6 +35,13 @@
 	#include <memory>
 	#include <cpl/simd.h>
 	#include "../Common/ConcurrentConfig.h"
+	#include "../Common/PeakTracker.h"
+	#include "../Common/StreamedGeometry.h"
+	#include "../Common/CachedGeometry.h"
+	#include "../Common/OverlayLayer.h"
+	#include "../Common/RetainedFrame.h"
+	#include "../Common/AnalysisScheduler.h"
+	#include "PhosphorHistogram.h"
 
 	namespace cpl
 	{
@@ -88,12 +95,29 @@
 
 			void paint2DGraphics(juce::Graphics & g, std::size_t numChannels);
 			/// <summary>
+			/// Paints the 2D graphics that only change with the view, into the overlay layer.
+			/// </summary>
+			void paintOverlay(juce::Graphics & g);
+			/// <summary>
 			/// Handles all set flags in mtFlags.
 			/// </summary>
 			void handleFlagUpdates();
 
 		private:
 
+			static constexpr std::size_t MaxPairs = MaxInputChannels / 2;
+			/// <summary>
+			/// Samples of the pairs transposed at a time in the stereo analysis.
+			/// </summary>
+			static constexpr std::size_t ScratchChunk = 64;
+			/// <summary>
+			/// The widest vector the stereo analysis is dispatched for, the scratch space is sized for it.
+			/// </summary>
+			static constexpr std::size_t MaxLanes = 8;
+
+			/// <summary>
+			/// Envelope, balance and phase filters of a stereo pair
+			/// </summary>
 			struct FilterStates
 			{
 				enum Entry
@@ -107,7 +131,24 @@
 				cpl::relaxed_atomic<AudioStream::DataType> envelope[2];
 				cpl::relaxed_atomic<AudioStream::DataType> balance[2][2];
 				cpl::relaxed_atomic<AudioStream::DataType> phase[2];
+				/// <summary>
+				/// Peaks of the audio history, published from the peak trackers
+				/// </summary>
+				cpl::relaxed_atomic<AudioStream::DataType> peak[2];
+			};
 
+			/// <summary>
+			/// Private copy of the audio history, so drawing doesn't hold on to the audio stream.
+			/// Every channel is contiguous, from the oldest sample to the newest.
+			/// With a stride, only every stride'th sample is kept, ending with the newest.
+			/// </summary>
+			struct AudioSnapshot
+			{
+				std::vector<cpl::aligned_vector<AFloat, 32>> channels;
+				std::size_t numChannels = 0, numSamples = 0;
+
+				void copyFrom(const AudioStream::AudioBufferAccess& access, bool copySamples, std::size_t stride = 1);
+				const AFloat* getChannel(std::size_t channel) const noexcept { return channels[channel].data(); }
 			};
 
 			struct StreamState
@@ -119,7 +160,12 @@
 			struct Processor : public AudioStream::Listener
 			{
 				Signalizer::CriticalSection<StreamState> streamState;
-				FilterStates filters{};
+				FilterStates filters[MaxPairs]{};
+				PeakTracker peakTrackers[MaxPairs * 2];
+				/// <summary>
+				/// The amount of pairs the filters are running for
+				/// </summary>
+				cpl::relaxed_atomic<std::size_t> numPairs;
 				cpl::relaxed_atomic<double> envelopeGain;
 				cpl::relaxed_atomic<float> 
 					stereoCoeff, 
@@ -132,31 +178,74 @@
 				cpl::relaxed_atomic<bool> isSuspended, normalizeGain;
 				cpl::relaxed_atomic<EnvelopeModes> envelopeMode;
 
+				/// <summary>
+				/// The histograms as of some block, handed to the renderer.
+				/// </summary>
+				struct PhosphorFrame
+				{
+					std::vector<AFloat> bins;
+					std::size_t numPairs = 0;
+					AFloat scale = 1;
+				};
+
+				/// <summary>
+				/// Density of the audio history for the phosphor display, accumulated as audio arrives. Only touched by the audio thread,
+				/// and sized in onStreamPropertiesChanged().
+				/// The waveform transforms are mirrored here, since they decide where samples land.
+				/// </summary>
+				PhosphorHistogram phosphor;
+				/// <summary>
+				/// Copied from the histograms once the renderer asks for a new frame. The audio thread only ever tries to lock it,
+				/// and skips the copy if the renderer holds it.
+				/// </summary>
+				PhosphorFrame phosphorFrame;
+				std::mutex phosphorMutex;
+				cpl::relaxed_atomic<bool> isPhosphor, isPolar, isPhosphorFrameWanted;
+				cpl::relaxed_atomic<float> rotation, userGain;
+				bool wasPhosphor = false;
+
 				/// <summary>
 				/// Set this if the audio buffer window size was changed from somewhere else.
 				/// </summary>
 				cpl::ABoolFlag streamPropertiesChanged;
+				/// <summary>
+				/// Bumped when incoming audio can change the display.
+				/// </summary>
+				AudioActivity activity;
 				std::shared_ptr<const SharedBehaviour> globalBehaviour;
+				/// <summary>
+				/// Squared inputs and phases of a chunk, transposed so every SIMD lane holds a pair.
+				/// Every group of pairs has its own slice, so groups can be processed concurrently.
+				/// Sized in onStreamPropertiesChanged() for the widest vectors.
+				/// </summary>
+				cpl::aligned_vector<AFloat, 32> pairScratch;
 
 				void onStreamAudio(AudioStream::ListenerContext& source, AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples) override;
 				void onStreamPropertiesChanged(AudioStream::ListenerContext& source, const AudioStream::AudioStreamInfo& before) override;
 
 				template<typename ISA>
-				void audioProcessing(AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples);
+				void audioProcessing(AudioStream::DataType** buffer, std::size_t numChannels, std::size_t numSamples, std::size_t historySize);
 
 				Processor(std::shared_ptr<const SharedBehaviour>& behaviour)
 					: globalBehaviour(behaviour)
 					, secondStereoFilterSpeed(0.25f)
 					, envelopeGain(1)
+					, numPairs(0)
+					, isPhosphor(false)
+					, isPolar(false)
+					, isPhosphorFrameWanted(true)
+					, rotation(0)
+					, userGain(1)
 				{
 				}
 			};
 
 			struct AudioDispatcher
 			{
-				template<typename ISA> static void dispatch(Processor& v, AFloat** buffer, std::size_t numChannels, std::size_t numSamples)
+				template<typename ISA> static void dispatch(Processor& v, AudioStream::ListenerContext& source, AFloat** buffer, std::size_t numChannels, std::size_t numSamples)
 				{
-					v.audioProcessing<ISA>(buffer, numChannels, numSamples);
+					v.activity.onAudio<ISA>(buffer, numChannels, numSamples, source.getInfo());
+					v.audioProcessing<ISA>(buffer, numChannels, numSamples, source.getInfo().audioHistorySize);
 				}
 			};
 
@@ -177,22 +266,25 @@
 
 			// vector-accelerated drawing, rendering and processing
 			template<typename ISA, typename ColourArray>
-				void drawPolarPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &, std::size_t offset, const ColourArray&);
+				void drawPolarPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioSnapshot &, std::size_t offset, const ColourArray&);
 
 			template<typename ISA, typename ColourArray>
-				void drawRectPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &, std::size_t, const ColourArray&);
+				void drawRectPlot(cpl::OpenGLRendering::COpenGLStack &, const AudioSnapshot &, std::size_t, const ColourArray&);
+
+			template<typename ISA, typename ColourArray>
+				void drawPhosphor(cpl::OpenGLRendering::COpenGLStack &, const ColourArray&);
 
 			template<typename ISA>
 				void drawWireFrame(cpl::OpenGLRendering::COpenGLStack &);
 
 			template<typename ISA>
-				void drawGraphText(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+				void drawGraphText(cpl::OpenGLRendering::COpenGLStack &);
 
-			template<typename ISA>
-				void drawStereoMeters(cpl::OpenGLRendering::COpenGLStack &, const AudioStream::AudioBufferAccess &);
+			template<typename ISA, typename ColourArray>
+				void drawStereoMeters(cpl::OpenGLRendering::COpenGLStack &, const ColourArray&);
 
 			template<typename ISA>
-				void runPeakFilter(const AudioStream::AudioBufferAccess &);
+				void runPeakFilter(const AudioSnapshot &);
 
 			void initPanelAndControls();
 
@@ -210,11 +302,13 @@
 			// contains non-atomic structures
 			struct StateOptions
 			{
-				bool isPolar, isFrozen, fillPath, fadeHistory, antialias, diagnostics, drawLegend, scalePolar;
+				bool isPolar, isFrozen, fillPath, fadeHistory, antialias, diagnostics, drawLegend, scalePolar, phosphor;
 				float primitiveSize, rotation;
 				juce::Colour colourBackground, colourWire, colourAxis, colourWaveform, colourMeter, colourWidget;
 				cpl::ValueT userGain;
 				LegendCache legend;
+				ChangeVersion::Listener legendChanged;
+				ConcurrentChangeVersion::Listener audioChanged;
 			} state;
 
 			std::shared_ptr<VectorScopeContent> content;
@@ -224,6 +318,15 @@
 			std::shared_ptr<const SharedBehaviour> globalBehaviour;
 
 			std::vector<std::unique_ptr<juce::OpenGLTexture>> textures;
+
+			AudioSnapshot snapshot;
+			std::unique_ptr<juce::OpenGLTexture> phosphorTexture;
+			std::vector<AFloat> phosphorBins, phosphorColours;
+			std::vector<juce::PixelARGB> phosphorPixels;
+			StreamedGeometry geometry;
+			CachedGeometry wireFrame;
+			OverlayLayer overlay;
+			RetainedFrame retainedFrame;
 		};
 
 	};
@@ -63,6 +63,7 @@ namespace Signalizer
 			, kpresets(&valueSerializer, "vectorscope")
 			, kwidgetColour(&parentValue.widgetColour)
 			, kscalePolar(&parentValue.scalePolarModeToFill)
+			, kphosphor(&parentValue.phosphorDisplay)
 			, editorSerializer(
 				*this,
 				[](auto & oc, auto & se, auto version) { oc.serializeEditorSettings(se, version); },
@@ -114,6 +115,8 @@ namespace Signalizer
 			kshowLegend.setToggleable(true);
 			kscalePolar.bSetTitle("Scale polar");
 			kscalePolar.setToggleable(true);
+			kphosphor.setSingleText("Phosphor display");
+			kphosphor.setToggleable(true);
 
 			// design
 			kopMode.bSetTitle("Operational mode");
@@ -142,6 +145,7 @@ namespace Signalizer
 			kshowLegend.bSetDescription("Display a legend of the channels and assigned colours.");
 			kwidgetColour.bSetDescription("Colour of widgets on the screen (like legends).");
 			kscalePolar.bSetDescription("Scale the height of the polar mode to fill the screen.");
+			kphosphor.bSetDescription("Displays the density of the audio history like an analog phosphor screen, instead of drawing every sample. Rendering cost is independent of the window size.");
 		}
 
 		void initUI()
@@ -178,6 +182,7 @@ namespace Signalizer
 					section->addControl(&kantiAlias, 0);
 					section->addControl(&kfadeOld, 1);
 					section->addControl(&kdrawLines, 2);
+					section->addControl(&kphosphor, 0);
 					//section->addControl(&kshowLegend, 3);
 					page->addSection(section, "Options");
 				}
@@ -236,6 +241,7 @@ namespace Signalizer
 			archive << kshowLegend;
 			archive << kwidgetColour;
 			archive << kscalePolar;
+			archive << kphosphor;
 		}
 
 		void deserializeEditorSettings(cpl::CSerializer::Archiver & builder, cpl::Version version)
@@ -271,6 +277,11 @@ namespace Signalizer
 				builder >> kwidgetColour;
 				builder >> kscalePolar;
 			}
+
+			if (version >= cpl::Version(0, 4, 4))
+			{
+				builder >> kphosphor;
+			}
 		}
 
 		// entrypoints for completely storing values and settings in independant blobs (the preset widget)
@@ -306,7 +317,7 @@ namespace Signalizer
 			}
 		}
 
-		cpl::CButton kantiAlias, kfadeOld, kdrawLines, kdiagnostics, kshowLegend, kscalePolar;
+		cpl::CButton kantiAlias, kfadeOld, kdrawLines, kdiagnostics, kshowLegend, kscalePolar, kphosphor;
 		cpl::CValueKnobSlider kwindow, krotation, kgain, kprimitiveSize, kenvelopeSmooth, kstereoSmooth;
 		cpl::CColourControl kwaveformColour, kaxisColour, kbackgroundColour, kwireframeColour, kmeterColour, kwidgetColour;
 		cpl::CTransformWidget ktransform;
@@ -68,6 +68,7 @@
 				, primitiveSize("PixelSize", ptsRange, ptsFormatter)
 				, showLegend("Legend", boolRange, boolFormatter)
 				, scalePolarModeToFill("PolarScale", boolRange, boolFormatter)
+				, phosphorDisplay("Phosphor", boolRange, boolFormatter)
 
 				, colourBehaviour()
 				, waveformColour(colourBehaviour, "Draw.")
@@ -106,6 +107,9 @@
 				parameterSet.registerSingleParameter(scalePolarModeToFill.generateUpdateRegistrator());
 				parameterSet.registerParameterBundle(&widgetColour, widgetColour.getBundleName());
 
+				// v. 0.4.4
+				parameterSet.registerSingleParameter(phosphorDisplay.generateUpdateRegistrator());
+
 				parameterSet.seal();
 
 				postParameterInitialization();
@@ -159,6 +163,7 @@
 				archive << scalePolarModeToFill;
 				archive << showLegend;
 				archive << widgetColour;
+				archive << phosphorDisplay;
 			}
 
 			virtual void deserialize(cpl::CSerializer::Builder & builder, cpl::Version v) override
@@ -188,6 +193,11 @@
 					builder >> showLegend;
 					builder >> widgetColour;
 				}
+
+				if (v >= cpl::Version(0, 4, 4))
+				{
+					builder >> phosphorDisplay;
+				}
 			}
 
 			AudioHistoryTransformatter<ParameterSet::ParameterView> audioHistoryTransformatter;
@@ -226,7 +236,8 @@
 				primitiveSize,
 				// serialized, but not used yet (controlled by MainEditor::klegendChoice)
 				showLegend,
-				scalePolarModeToFill;
+				scalePolarModeToFill,
+				phosphorDisplay;
 
 			ChoiceParameter
 				autoGain,
@@ -71,24 +71,23 @@ namespace Signalizer
 
 			auto scale = oglc->getRenderingScale();
 
-			cpl::sprintfs(textbuf, "%dx%d (%.2f): %.1f fps - %.1f%% cpu, deltaT = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%)",
+			cpl::sprintfs(textbuf, "%dx%d (%.2f): %.1f fps - %.1f%% cpu, deltaT = %f (rt: %.2f%% - %.2f%%), (as: %.2f%% - %.2f%%), quality: %s",
 				getWidth(), getHeight(), scale, averageFps, averageCpu, openGLDeltaTime(),
 				100 * perf.producerUsage,
 				100 * perf.producerOverhead,
 				100 * perf.consumerUsage,
-				100 * perf.consumerOverhead
+				100 * perf.consumerOverhead,
+				governor.getLevelName()
 			);
 
 			g.drawSingleLineText(textbuf, 10, 20);
 
 		}
+	}
 
-		auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
-
-		if (globalBehaviour->showLegend && mouseCheck)
-		{
-			state.legend.paint(g, state.colourWidget, state.colourBackground);
-		}
+	void VectorScope::paintOverlay(juce::Graphics & g)
+	{
+		state.legend.paint(g, state.colourWidget, state.colourBackground);
 	}
 
 	void VectorScope::initOpenGL()
@@ -117,6 +116,14 @@ namespace Signalizer
 	void VectorScope::closeOpenGL()
 	{
 		textures.clear();
+		phosphorTexture.reset();
+		geometry.release();
+		wireFrame.release();
+		overlay.release();
+		retainedFrame.release();
+		// nothing is retained in the next context
+		invalidateFrame();
+		governor.reset();
 	}
 
 	void VectorScope::onOpenGLRendering()
@@ -127,81 +134,122 @@ namespace Signalizer
 	template<typename ISA>
 		void VectorScope::vectorGLRendering()
 		{
-			std::size_t numChannels;
 			CPL_DEBUGCHECKGL();
-            {
-                auto && lockedView = audioStream->getAudioBufferViews();
-                handleFlagUpdates();
-
-                juce::OpenGLHelpers::clear(state.colourBackground);
-				numChannels = lockedView.getNumChannels();
-
-				if(numChannels >= 2)
-                {
-                    cpl::OpenGLRendering::COpenGLStack openGLStack;
-                    // set up openGL
-                    openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-                    openGLStack.loadIdentityMatrix();
-                    cpl::GraphicsND::Transform3D<GLfloat> transform(1);
-                    content->transform.fillTransform3D(transform);
-                    openGLStack.applyTransform3D(transform);
-                    state.antialias ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
-
-                    // the peak filter has to run on the whole buffer each time.
-                    if (processor->envelopeMode == EnvelopeModes::PeakDecay)
-                    {
-                        runPeakFilter<ISA>(lockedView);
-                    }
-                    else if (processor->envelopeMode == EnvelopeModes::None)
-                    {
-						processor->envelopeGain = 1;
-                    }
-
-                    openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
-                    openGLStack.setPointSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
-
-					numChannels = lockedView.getNumChannels();
-
-                    // draw actual stereoscopic plot
-
-					ColourRotation rotation(state.colourWaveform, lockedView.getNumChannels(), true);
 
+			auto mouseCheck = globalBehaviour->hideWidgetsOnMouseExit ? isMouseInside.load() : true;
+			const bool showDiagnostics = content->diagnostics.getNormalizedValue() > 0.5;
+
+			// nothing changed since the last frame, so present it again
+			const bool hasChanged = state.audioChanged.consumeChanges(processor->activity.getVersion()) | frameChanged.cas() | showDiagnostics;
+
+			if (!retainedFrame.begin(hasChanged, { (double)getWidth(), (double)getHeight(), oglc->getRenderingScale(), (double)globalBehaviour->showLegend, (double)mouseCheck }))
+			{
+				postFrame(false);
+				return;
+			}
+
+			{
+				auto && lockedView = audioStream->getAudioBufferViews();
+				handleFlagUpdates();
+				// copy out the history, so the stream isn't held up by any of the drawing.
+				// the phosphor display only needs the size of it.
+				snapshot.copyFrom(lockedView, !state.phosphor, governor.isReduced(QualityGovernor::ReducedDensity) ? 2 : 1);
+			}
+
+			const std::size_t numChannels = snapshot.numChannels;
+
+			juce::OpenGLHelpers::clear(state.colourBackground);
+
+			if (numChannels >= 2)
+			{
+				cpl::OpenGLRendering::COpenGLStack openGLStack;
+				// set up openGL
+				openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
+				openGLStack.loadIdentityMatrix();
+				cpl::GraphicsND::Transform3D<GLfloat> transform(1);
+				content->transform.fillTransform3D(transform);
+				openGLStack.applyTransform3D(transform);
+				const bool multisample = !governor.isReduced(QualityGovernor::NoMultisampling);
+				state.antialias && multisample ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
+
+				// only decays the envelope towards the peaks tracked on the audio thread, the buffer isn't scanned here.
+				if (processor->envelopeMode == EnvelopeModes::PeakDecay)
+				{
+					runPeakFilter<ISA>(snapshot);
+				}
+				else if (processor->envelopeMode == EnvelopeModes::None)
+				{
+					processor->envelopeGain = 1;
+				}
+
+				openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
+				openGLStack.setPointSize(static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize);
+				// paths are antialiased by the line shader, which doesn't depend on multisampling
+				geometry.setAntialiasedLineWidth(state.antialias ? static_cast<float>(oglc->getRenderingScale()) * state.primitiveSize : 0);
+
+				// draw actual stereoscopic plot
+
+				ColourRotation rotation(state.colourWaveform, numChannels, true);
+
+				if (state.phosphor)
+				{
+					drawPhosphor<ISA>(openGLStack, rotation);
+				}
+				else
+				{
 					for (std::size_t c = 0; c < numChannels; c += 2)
 					{
 						if (state.isPolar)
 						{
-							drawPolarPlot<ISA>(openGLStack, lockedView, c, rotation);
+							drawPolarPlot<ISA>(openGLStack, snapshot, c, rotation);
 						}
 						else // is Lissajous
 						{
-							drawRectPlot<ISA>(openGLStack, lockedView, c, rotation);
+							drawRectPlot<ISA>(openGLStack, snapshot, c, rotation);
 						}
 					}
+				}
 
-                    CPL_DEBUGCHECKGL();
+				CPL_DEBUGCHECKGL();
+
+				openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * 2.0f);
+				multisample ? openGLStack.enable(GL_MULTISAMPLE) : openGLStack.disable(GL_MULTISAMPLE);
+				// draw graph and wireframe
+				drawWireFrame<ISA>(openGLStack);
+				CPL_DEBUGCHECKGL();
+				// draw channel text(ures)
+				drawGraphText<ISA>(openGLStack);
+				CPL_DEBUGCHECKGL();
+				// draw 2d stuff (like stereo meters)
+				drawStereoMeters<ISA>(openGLStack, rotation);
+				CPL_DEBUGCHECKGL();
+			}
+
+			if (state.legendChanged.consumeChanges(state.legend.getVersion()))
+				overlay.invalidate();
+
+			if (globalBehaviour->showLegend && mouseCheck)
+			{
+				overlay.setRefreshInterval(governor.isReduced(QualityGovernor::ReducedOverlay) ? 8 : 1);
+				overlay.render(
+					getWidth(), getHeight(), oglc->getRenderingScale(),
+					{ (double)state.colourWidget.getARGB(), (double)state.colourBackground.getARGB() },
+					[&](juce::Graphics & g) { paintOverlay(g); }
+				);
+			}
 
-                    openGLStack.setLineSize(static_cast<float>(oglc->getRenderingScale()) * 2.0f);
-					openGLStack.enable(GL_MULTISAMPLE);
-                    // draw graph and wireframe
-                    drawWireFrame<ISA>(openGLStack);
-                    CPL_DEBUGCHECKGL();
-                    // draw channel text(ures)
-                    drawGraphText<ISA>(openGLStack, lockedView);
-                    CPL_DEBUGCHECKGL();
-                    // draw 2d stuff (like stereo meters)
-                    drawStereoMeters<ISA>(openGLStack, lockedView);
-                    CPL_DEBUGCHECKGL();
-                }
-            }
+			retainedFrame.retain();
 
-			renderGraphics([&](juce::Graphics & g) { paint2DGraphics(g, numChannels); });
+			// only the diagnostics change every frame
+			if (showDiagnostics)
+				renderGraphics([&](juce::Graphics & g) { paint2DGraphics(g, numChannels); });
 
 			postFrame();
 		}
 
 
 	template<typename ISA>
-		void VectorScope::drawGraphText(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & view)
+		void VectorScope::drawGraphText(cpl::OpenGLRendering::COpenGLStack & openGLStack)
 		{
 			openGLStack.enable(GL_TEXTURE_2D);
 			openGLStack.setBlender(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -299,150 +347,243 @@ namespace Signalizer
 			cpl::Utility::LazyStackPointer<cpl::OpenGLRendering::MatrixModification> m;
 		};
 
-	template<typename ISA>
-		void VectorScope::drawWireFrame(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+	template<typename ISA, typename ColourArray>
+		void VectorScope::drawPhosphor(cpl::OpenGLRendering::COpenGLStack & openGLStack, const ColourArray& colours)
 		{
-			openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-			Conditional01To11HeightTransform m(state.scalePolar && state.isPolar);
-			cpl::OpenGLRendering::PrimitiveDrawer<128> drawer(openGLStack, GL_LINES);
+			constexpr std::size_t resolution = PhosphorHistogram::Resolution;
+			constexpr std::size_t numBins = resolution * resolution;
+
+			std::size_t numPairs;
+			AFloat scale;
 
-			// draw skeleton graph
-			if (!state.isPolar)
+			// copy out the last frame the audio thread handed over, and ask for the next one.
+			// the audio thread skips handing over while this is held, instead of waiting for it
 			{
-				drawer.addColour(state.colourWire);
-				int nlines = 14;
-				auto rel = 1.0f / nlines;
+				std::lock_guard<std::mutex> lock(processor->phosphorMutex);
+				auto& frame = processor->phosphorFrame;
 
-				// front vertival
-				for (int i = 0; i <= nlines; ++i)
-				{
-					drawer.addVertex(i * rel * 2 - 1, -1.f, 0.0f);
-					drawer.addVertex(i * rel * 2 - 1, 1.f, 0.0f);
-				}
-				// front horizontal
-				for (int i = 0; i <= nlines; ++i)
-				{
-					drawer.addVertex(-1.0f, i * rel * 2 - 1, 0.0f);
-					drawer.addVertex(1.0f, i * rel * 2 - 1, 0.0f);
-				}
-				// back vertical
-				for (int i = 0; i <= nlines; ++i)
-				{
-					drawer.addVertex(i * rel * 2 - 1, -1.f, -1.0f);
-					drawer.addVertex(i * rel * 2 - 1, 1.f, -1.0f);
-				}
-				// back horizontal
-				for (int i = 0; i <= nlines; ++i)
+				numPairs = frame.numPairs;
+				scale = frame.scale;
+				phosphorBins.resize(numPairs * numBins);
+				std::copy(frame.bins.begin(), frame.bins.begin() + numPairs * numBins, phosphorBins.begin());
+
+				processor->isPhosphorFrameWanted = true;
+			}
+
+			phosphorColours.assign(numBins * 3, 0);
+
+			for (std::size_t p = 0; p < numPairs; ++p)
+			{
+				const auto bins = phosphorBins.data() + p * numBins;
+				const auto peak = *std::max_element(bins, bins + numBins) * scale;
+
+				if (peak <= 0)
+					continue;
+
+				// tone map relative to the densest bin, so sparse traces still glow while dense regions saturate
+				const auto knee = peak * 0.05f;
+				const auto colour = colours[p * 2];
+				const AFloat rgb[3] = { colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue() };
+
+				for (std::size_t i = 0; i < numBins; ++i)
 				{
-					drawer.addVertex(-1.0f, i * rel * 2 - 1, -1.0f);
-					drawer.addVertex(1.0f, i * rel * 2 - 1, -1.0f);
+					const auto intensity = bins[i] * scale;
+					const auto mapped = intensity / (intensity + knee);
+
+					phosphorColours[i * 3 + 0] += mapped * rgb[0];
+					phosphorColours[i * 3 + 1] += mapped * rgb[1];
+					phosphorColours[i * 3 + 2] += mapped * rgb[2];
 				}
 			}
-			else
+
+			phosphorPixels.resize(numBins);
+
+			auto toComponent = [](AFloat x) { return static_cast<juce::uint8>(std::min<AFloat>(x, 1) * 255); };
+
+			for (std::size_t i = 0; i < numBins; ++i)
 			{
-				typedef typename ISA::V V;
+				phosphorPixels[i] = juce::PixelARGB(
+					255,
+					toComponent(phosphorColours[i * 3 + 0]),
+					toComponent(phosphorColours[i * 3 + 1]),
+					toComponent(phosphorColours[i * 3 + 2])
+				);
+			}
 
-				using namespace cpl::simd;
-				using cpl::simd::abs;
-				typedef typename scalar_of<V>::type Ty;
-				constexpr ssize_t lanes = elements_of<V>::value;
+			if (!phosphorTexture)
+				phosphorTexture = std::make_unique<juce::OpenGLTexture>();
 
-				const auto angularResolution = static_cast<int>(4 * std::sqrt(getWidth() * getHeight()) / 75.0);
+			phosphorTexture->loadARGB(phosphorPixels.data(), static_cast<int>(resolution), static_cast<int>(resolution));
 
-				const auto step = (consts<Ty>::pi_half) / (angularResolution);
+			// the histograms cover the same space as the waveform plots
+			Conditional01To11HeightTransform m(state.scalePolar && state.isPolar);
 
-				suitable_container<V> phases, sines, cosines;
-				drawer.addColour(state.colourWire);
+			openGLStack.enable(GL_TEXTURE_2D);
+			openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
 
-				Ty oldX = 1, oldY = 0;
+			{
+				cpl::OpenGLRendering::ImageDrawer image(openGLStack, *phosphorTexture);
+				image.setColour(juce::Colours::white);
+				image.drawAt({ -1.0f, -1.0f, 2.0f, 2.0f });
+			}
 
-				int i = 1;
+			openGLStack.disable(GL_TEXTURE_2D);
+		}
 
-				auto emitXY = [&](float newX, float newY)
-				{
-					drawer.addVertex(oldX, oldY, 0);
-					drawer.addVertex(newX, newY, 0);
-					drawer.addVertex(oldX, oldY, -1);
-					drawer.addVertex(newX, newY, -1);
-
-					// left part
-					drawer.addVertex(-oldX, oldY, 0);
-					drawer.addVertex(-newX, newY, 0);
-					drawer.addVertex(-oldX, oldY, -1);
-					drawer.addVertex(-newX, newY, -1);
-
-					oldX = newX;
-					oldY = newY;
-				};
-
-				for (; i < angularResolution && i + lanes < angularResolution; i += lanes)
+	template<typename ISA>
+		void VectorScope::drawWireFrame(cpl::OpenGLRendering::COpenGLStack & openGLStack)
+		{
+			openGLStack.setBlender(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
+			Conditional01To11HeightTransform m(state.scalePolar && state.isPolar);
+
+			const auto angularResolution = static_cast<int>(4 * std::sqrt(getWidth() * getHeight()) / 75.0);
+
+			auto batch = wireFrame.rebuild(3,
+				{ (double)state.isPolar, (double)angularResolution, (double)state.colourWire.getARGB(), (double)state.colourAxis.getARGB() }
+			);
+
+			if (batch)
+			{
+				auto & drawer = *batch;
+
+				// draw skeleton graph
+				if (!state.isPolar)
 				{
-					auto baseAngle = i * step;
+					drawer.addColour(state.colourWire);
+					int nlines = 14;
+					auto rel = 1.0f / nlines;
 
-					for (std::size_t c = 0; c < lanes; ++c)
+					// front vertival
+					for (int i = 0; i <= nlines; ++i)
+					{
+						drawer.addVertex(i * rel * 2 - 1, -1.f, 0.0f);
+						drawer.addVertex(i * rel * 2 - 1, 1.f, 0.0f);
+					}
+					// front horizontal
+					for (int i = 0; i <= nlines; ++i)
 					{
-						phases[c] = baseAngle + step * c;
+						drawer.addVertex(-1.0f, i * rel * 2 - 1, 0.0f);
+						drawer.addVertex(1.0f, i * rel * 2 - 1, 0.0f);
 					}
+					// back vertical
+					for (int i = 0; i <= nlines; ++i)
+					{
+						drawer.addVertex(i * rel * 2 - 1, -1.f, -1.0f);
+						drawer.addVertex(i * rel * 2 - 1, 1.f, -1.0f);
+					}
+					// back horizontal
+					for (int i = 0; i <= nlines; ++i)
+					{
+						drawer.addVertex(-1.0f, i * rel * 2 - 1, -1.0f);
+						drawer.addVertex(1.0f, i * rel * 2 - 1, -1.0f);
+					}
+				}
+				else
+				{
+					typedef typename ISA::V V;
+
+					using namespace cpl::simd;
+					using cpl::simd::abs;
+					typedef typename scalar_of<V>::type Ty;
+					constexpr ssize_t lanes = elements_of<V>::value;
+
+					const auto step = (consts<Ty>::pi_half) / (angularResolution);
 
-					V vSines, vCosines;
+					suitable_container<V> phases, sines, cosines;
+					drawer.addColour(state.colourWire);
 
-					sincos(phases.toType(), &vSines, &vCosines);
+					Ty oldX = 1, oldY = 0;
 
-					sines = vSines;
-					cosines = vCosines;
+					int i = 1;
 
-					for (std::size_t c = 0; c < lanes; ++c)
+					auto emitXY = [&](float newX, float newY)
 					{
-						emitXY(cosines[c], sines[c]);
+						drawer.addVertex(oldX, oldY, 0);
+						drawer.addVertex(newX, newY, 0);
+						drawer.addVertex(oldX, oldY, -1);
+						drawer.addVertex(newX, newY, -1);
+
+						// left part
+						drawer.addVertex(-oldX, oldY, 0);
+						drawer.addVertex(-newX, newY, 0);
+						drawer.addVertex(-oldX, oldY, -1);
+						drawer.addVertex(-newX, newY, -1);
+
+						oldX = newX;
+						oldY = newY;
+					};
+
+					for (; i < angularResolution && i + lanes < angularResolution; i += lanes)
+					{
+						auto baseAngle = i * step;
+
+						for (std::size_t c = 0; c < lanes; ++c)
+						{
+							phases[c] = baseAngle + step * c;
+						}
+
+						V vSines, vCosines;
+
+						sincos(phases.toType(), &vSines, &vCosines);
+
+						sines = vSines;
+						cosines = vCosines;
+
+						for (std::size_t c = 0; c < lanes; ++c)
+						{
+							emitXY(cosines[c], sines[c]);
+						}
 					}
-				}
 
-				// scalar loop
-				for (; i < angularResolution; i++)
-				{
-					Ty sine, cosine;
+					// scalar loop
+					for (; i < angularResolution; i++)
+					{
+						Ty sine, cosine;
 
-					sincos(i * step, &sine, &cosine);
-					emitXY(cosine, sine);
-				}
+						sincos(i * step, &sine, &cosine);
+						emitXY(cosine, sine);
+					}
 
-				// connect half circles to final coordinates
-				emitXY(0, 1); 
+					// connect half circles to final coordinates
+					emitXY(0, 1); 
 
-				// add front and back horizontal lines.
-				drawer.addVertex(-1.0f, 0.0f, 0.0f);
-				drawer.addVertex(1.0f, 0.0f, 0.0f);
-				drawer.addVertex(-1.0f, 0.0f, -1.0f);
-				drawer.addVertex(1.0f, 0.0f, -1.0f);
+					// add front and back horizontal lines.
+					drawer.addVertex(-1.0f, 0.0f, 0.0f);
+					drawer.addVertex(1.0f, 0.0f, 0.0f);
+					drawer.addVertex(-1.0f, 0.0f, -1.0f);
+					drawer.addVertex(1.0f, 0.0f, -1.0f);
 
-				const auto sqrtHalfTwo = consts<float>::sqrt_half_two;
+					const auto sqrtHalfTwo = consts<float>::sqrt_half_two;
 
-				// add critical diagonal phase lines.
-				drawer.addVertex(0.0f, 0.0f, 0.0f);
-				drawer.addVertex(sqrtHalfTwo, sqrtHalfTwo, 0.0f);
-				drawer.addVertex(0.0f, 0.0f, 0.0f);
-				drawer.addVertex(-sqrtHalfTwo, sqrtHalfTwo, 0.0f);
+					// add critical diagonal phase lines.
+					drawer.addVertex(0.0f, 0.0f, 0.0f);
+					drawer.addVertex(sqrtHalfTwo, sqrtHalfTwo, 0.0f);
+					drawer.addVertex(0.0f, 0.0f, 0.0f);
+					drawer.addVertex(-sqrtHalfTwo, sqrtHalfTwo, 0.0f);
 
-				drawer.addVertex(0.0f, 0.0f, -1.0f);
-				drawer.addVertex(sqrtHalfTwo, sqrtHalfTwo, -1.0f);
-				drawer.addVertex(0.0f, 0.0f, -1.0f);
-				drawer.addVertex(-sqrtHalfTwo, sqrtHalfTwo, -1.0f);
-			}
+					drawer.addVertex(0.0f, 0.0f, -1.0f);
+					drawer.addVertex(sqrtHalfTwo, sqrtHalfTwo, -1.0f);
+					drawer.addVertex(0.0f, 0.0f, -1.0f);
+					drawer.addVertex(-sqrtHalfTwo, sqrtHalfTwo, -1.0f);
+				}
 
-			// Draw basic axis
-			{
-				// TODO: consider whether all rendering should use premultiplied alpha - src compositing or true transparancy
-				drawer.addColour(state.colourAxis);
-				// front x, y axii
-				drawer.addVertex(-1.0f, 0.0f, 0.0f);
-				drawer.addVertex(1.0f, 0.0f, 0.0f);
-				drawer.addVertex(0.0f, 1.0f, 0.0f);
-				drawer.addVertex(0.0f, state.isPolar ? 0.0f : -1.0f, 0.0f);
+				// Draw basic axis
+				{
+					// TODO: consider whether all rendering should use premultiplied alpha - src compositing or true transparancy
+					drawer.addColour(state.colourAxis);
+					// front x, y axii
+					drawer.addVertex(-1.0f, 0.0f, 0.0f);
+					drawer.addVertex(1.0f, 0.0f, 0.0f);
+					drawer.addVertex(0.0f, 1.0f, 0.0f);
+					drawer.addVertex(0.0f, state.isPolar ? 0.0f : -1.0f, 0.0f);
+				}
 			}
+
+			wireFrame.draw(GL_LINES);
 		}
 
 	template<typename ISA, typename ColourArray>
-		void VectorScope::drawRectPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio, std::size_t offset, const ColourArray& colours)
+		void VectorScope::drawRectPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioSnapshot & audio, std::size_t offset, const ColourArray& colours)
 		{
 			cpl::OpenGLRendering::MatrixModification matrixMod;
 			// apply the custom rotation to the waveform
@@ -450,58 +591,53 @@ namespace Signalizer
 			// and apply the gain:
 			const auto gain = static_cast<GLfloat>(processor->envelopeGain * state.userGain);
 			matrixMod.scale(gain, gain, 1);
-			float sampleFade = 1.0f / std::max<int>(1, static_cast<int>(audio.getNumSamples() - 1));
-
-			if (!state.fadeHistory)
-			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
+			float sampleFade = 1.0f / std::max<int>(1, static_cast<int>(audio.numSamples - 1));
+			const AFloat * left = audio.getChannel(offset + 0);
+			const AFloat * right = audio.getChannel(offset + 1);
 
-				drawer.addColour(colours[offset]);
+			auto & batch = geometry.begin(3);
+			GLfloat * vertices = batch.positions(audio.numSamples);
 
-				// TODO: glDrawArrays
-				audio.iterate<2, true>
-				(
-					[&] (std::size_t sampleFrame, AudioStream::DataType left, AudioStream::DataType right)
-					{
-						drawer.addVertex(right, left, sampleFrame * sampleFade - 1);
-					},
-					offset
-				);
+			for (std::size_t n = 0; n < audio.numSamples; ++n)
+			{
+				vertices[n * 3 + 0] = right[n];
+				vertices[n * 3 + 1] = left[n];
+				vertices[n * 3 + 2] = n * sampleFade - 1;
+			}
 
+			if (!state.fadeHistory)
+			{
+				const auto jcolour = colours[offset];
+				glColor4f(jcolour.getFloatRed(), jcolour.getFloatGreen(), jcolour.getFloatBlue(), jcolour.getFloatAlpha());
 			}
 			else
 			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
-
 				auto jcolour = colours[offset];
 				float red = jcolour.getFloatRed(), blue = jcolour.getFloatBlue(),
 				green = jcolour.getFloatGreen(), alpha = jcolour.getFloatGreen();
 
-				float fade = 0;
-
-				// TODO: glDrawArrays
-				audio.iterate<2, true>
-				(
-					[&] (std::size_t sampleFrame, AudioStream::DataType left, AudioStream::DataType right)
-					{
-						fade = sampleFrame * sampleFade;
-						drawer.addColour(fade * red, fade * green, fade * blue, alpha);
-						drawer.addVertex(right, left, fade - 1);
-					},
-					offset
-				);
+				const auto alphaByte = static_cast<GLubyte>(alpha * 255 + 0.5f);
+				GLubyte * vertexColours = batch.colours(audio.numSamples);
 
+				for (std::size_t n = 0; n < audio.numSamples; ++n)
+				{
+					const float fade = n * sampleFade * 255;
+					vertexColours[n * 4 + 0] = static_cast<GLubyte>(fade * red + 0.5f);
+					vertexColours[n * 4 + 1] = static_cast<GLubyte>(fade * green + 0.5f);
+					vertexColours[n * 4 + 2] = static_cast<GLubyte>(fade * blue + 0.5f);
+					vertexColours[n * 4 + 3] = alphaByte;
+				}
 			}
 
+			geometry.draw(state.fillPath ? GL_LINE_STRIP : GL_POINTS);
 
 		}
 
 
 	template<typename ISA, typename ColourArray>
-		void VectorScope::drawPolarPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio, std::size_t offset, const ColourArray& colours)
+		void VectorScope::drawPolarPlot(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioSnapshot & audio, std::size_t offset, const ColourArray& colours)
 		{
 			typedef typename ISA::V V;
-			AudioStream::AudioBufferView views[2] = { audio.getView(0 + offset), audio.getView(1 + offset) };
 
 			using namespace cpl::simd;
 			using cpl::simd::abs;
@@ -510,7 +646,7 @@ namespace Signalizer
 			Conditional01To11HeightTransform m(state.scalePolar);
 
 			const auto gain = static_cast<GLfloat>(processor->envelopeGain * state.userGain);
-			auto const numSamples = views[0].size();
+			auto const numSamples = audio.numSamples;
 			// TODO: handle all cases of potential signed overflow.
 			typedef std::make_signed<std::size_t>::type ssize_t;
 			constexpr ssize_t vectorLength = elements_of<V>::value;
@@ -544,95 +680,89 @@ namespace Signalizer
 
 			if(!state.fadeHistory)
 			{
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
+				auto & drawer = geometry.begin(3);
 				drawer.addColour(red, green, blue);
-				// iterate front of buffer, then back.
-
-				for (ssize_t section = 0; section < static_cast<ssize_t>(AudioStream::bufferIndices); ++section)
-				{
+				// using signed ints to safely jump out of loops with elements_of<V> > sectionSamples
+				ssize_t i = 0;
 
-					// using signed ints to safely jump out of loops with elements_of<V> > sectionSamples
-					ssize_t i = 0;
+				const Ty * left = audio.getChannel(offset + 0);
+				const Ty * right = audio.getChannel(offset + 1);
 
-					const Ty * left = views[0].getItIndex(section);
-					const Ty * right = views[1].getItIndex(section);
+				ssize_t sectionSamples = numSamples;
 
-					ssize_t sectionSamples = views[0].getItRange(section);
-
-					for (; i < (sectionSamples - vectorLength); i += vectorLength)
+				for (; i < (sectionSamples - vectorLength); i += vectorLength)
+				{
+					V vLeft = loadu<V>(left + i);
+					V vRight = loadu<V>(right + i);
+
+					// the length of the hypotenuse of the triangle, we
+					// convert the unit square to.
+					auto const vLength = max(abs(vLeft), abs(vRight));
+
+					// rotate our view manually (to center on Y-axis)
+					V vY = vLeft * vCosine - vRight * vSine;
+					V vX = vLeft * vSine + vRight * vCosine;
+
+					// check for any zero elements.
+					vLeft = (vLeft == vZero);
+					vRight = (vRight == vZero);
+					auto vMask = vnot(vand(vLeft, vRight));
+
+					// get the phase angle. use atan2 if you want to draw the full circle.
+					// x and y are swapped at this point, btw.
+					auto vAngle = atan(vX / vY);
+					// replace nan elements of angle with zero
+					vAngle = vand(vMask, vAngle);
+					// calcuate x,y coordinates for the right triangle
+					sincos(vAngle, &vX, &vY);
+
+					// construct triangle.
+					outX = vX * vLength;
+					outY = vY * vLength;
+
+					outFade = vSampleFade - vOne;
+
+					// draw vertices.
+					for (cpl::ssize_t n = 0; n < vectorLength; ++n)
 					{
-						V vLeft = loadu<V>(left + i);
-						V vRight = loadu<V>(right + i);
-
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const vLength = max(abs(vLeft), abs(vRight));
-
-						// rotate our view manually (to center on Y-axis)
-						V vY = vLeft * vCosine - vRight * vSine;
-						V vX = vLeft * vSine + vRight * vCosine;
-
-						// check for any zero elements.
-						vLeft = (vLeft == vZero);
-						vRight = (vRight == vZero);
-						auto vMask = vnot(vand(vLeft, vRight));
-
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto vAngle = atan(vX / vY);
-						// replace nan elements of angle with zero
-						vAngle = vand(vMask, vAngle);
-						// calcuate x,y coordinates for the right triangle
-						sincos(vAngle, &vX, &vY);
-
-						// construct triangle.
-						outX = vX * vLength;
-						outY = vY * vLength;
-
-						outFade = vSampleFade - vOne;
-
-						// draw vertices.
-						for (cpl::ssize_t n = 0; n < vectorLength; ++n)
-						{
-							drawer.addVertex(outX[n], outY[n], outFade[n]);
-						}
+						drawer.addVertex(outX[n], outY[n], outFade[n]);
+					}
 
-						vSampleFade += vIncrementalFade;
+					vSampleFade += vIncrementalFade;
 
-					}
+				}
 
-					// deal with remainder, scalar route
-					ssize_t remaindingSamples = 0;
-					auto currentSampleFade = outFade[vectorLength - 1];
+				// deal with remainder, scalar route
+				ssize_t remaindingSamples = 0;
+				auto currentSampleFade = outFade[vectorLength - 1];
 
-					for (; i < sectionSamples; i++, remaindingSamples++)
-					{
-						Ty vLeft = left[i];
-						Ty vRight = right[i];
+				for (; i < sectionSamples; i++, remaindingSamples++)
+				{
+					Ty vLeft = left[i];
+					Ty vRight = right[i];
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const length = std::max(std::abs(vLeft), std::abs(vRight));
+					// the length of the hypotenuse of the triangle, we
+					// convert the unit square to.
+					auto const length = std::max(std::abs(vLeft), std::abs(vRight));
 
-						// rotate our view manually (to center on Y-axis)
-						Ty vY = vLeft * cosineRotation - vRight * sineRotation;
-						Ty vX = vLeft * sineRotation + vRight * cosineRotation;
+					// rotate our view manually (to center on Y-axis)
+					Ty vY = vLeft * cosineRotation - vRight * sineRotation;
+					Ty vX = vLeft * sineRotation + vRight * cosineRotation;
 
-						// check for any zero elements.
+					// check for any zero elements.
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto angle = std::atan(vX / vY);
-						// replace nan elements of angle with zero
-						angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
-						// calcuate x,y coordinates for the right triangle
-						sincos(angle, &vX, &vY);
+					// get the phase angle. use atan2 if you want to draw the full circle.
+					// x and y are swapped at this point, btw.
+					auto angle = std::atan(vX / vY);
+					// replace nan elements of angle with zero
+					angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
+					// calcuate x,y coordinates for the right triangle
+					sincos(angle, &vX, &vY);
 
-						drawer.addVertex(vX * length, vY * length, (currentSampleFade - remaindingSamples * fadePerSample));
-					}
-					// fractionally increase sample fade levels
-					vSampleFade += set1<V>(fadePerSample * remaindingSamples);
+					drawer.addVertex(vX * length, vY * length, (currentSampleFade - remaindingSamples * fadePerSample));
 				}
+				// fractionally increase sample fade levels
+				vSampleFade += set1<V>(fadePerSample * remaindingSamples);
 			}
 			else // apply fading
 			{
@@ -643,110 +773,106 @@ namespace Signalizer
 					vBlue = set1<V>(blue);
 
 				suitable_container<V> outRed, outGreen, outBlue;
-				// iterate front of buffer, then back.
-
-				cpl::OpenGLRendering::PrimitiveDrawer<1024> drawer(openGLStack, state.fillPath ? GL_LINE_STRIP : GL_POINTS);
-
-				for (ssize_t section = 0; section < 2; ++section)
-				{
-
-					ssize_t i = 0;
 
-					const Ty * left = views[0].getItIndex(section);
-					const Ty * right = views[1].getItIndex(section);
+				auto & drawer = geometry.begin(3);
 
-					ssize_t sectionSamples = views[0].getItRange(section);
+				ssize_t i = 0;
 
-					for (; i < (sectionSamples - vectorLength); i += vectorLength)
-					{
-						V vLeft = loadu<V>(left + i);
-						V vRight = loadu<V>(right + i);
+				const Ty * left = audio.getChannel(offset + 0);
+				const Ty * right = audio.getChannel(offset + 1);
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const vLength = max(abs(vLeft), abs(vRight));
+				ssize_t sectionSamples = numSamples;
 
-						// rotate our view manually (to center on Y-axis)
-						V vY = vLeft * vCosine - vRight * vSine;
-						V vX = vLeft * vSine + vRight * vCosine;
+				for (; i < (sectionSamples - vectorLength); i += vectorLength)
+				{
+					V vLeft = loadu<V>(left + i);
+					V vRight = loadu<V>(right + i);
 
-						// check for any zero elements.
-						vLeft = (vLeft == vZero);
-						vRight = (vRight == vZero);
-						auto vMask = vnot(vand(vLeft, vRight));
+					// the length of the hypotenuse of the triangle, we
+					// convert the unit square to.
+					auto const vLength = max(abs(vLeft), abs(vRight));
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto vAngle = atan(vX / vY);
-						// replace nan elements of angle with zero
-						vAngle = vand(vMask, vAngle);
-						// calcuate x,y coordinates for the right triangle
-						sincos(vAngle, &vX, &vY);
+					// rotate our view manually (to center on Y-axis)
+					V vY = vLeft * vCosine - vRight * vSine;
+					V vX = vLeft * vSine + vRight * vCosine;
 
-						// construct triangle.
-						outX = vX * vLength;
-						outY = vY * vLength;
+					// check for any zero elements.
+					vLeft = (vLeft == vZero);
+					vRight = (vRight == vZero);
+					auto vMask = vnot(vand(vLeft, vRight));
 
-						outFade = vSampleFade - vOne;
+					// get the phase angle. use atan2 if you want to draw the full circle.
+					// x and y are swapped at this point, btw.
+					auto vAngle = atan(vX / vY);
+					// replace nan elements of angle with zero
+					vAngle = vand(vMask, vAngle);
+					// calcuate x,y coordinates for the right triangle
+					sincos(vAngle, &vX, &vY);
 
-						// set colours
+					// construct triangle.
+					outX = vX * vLength;
+					outY = vY * vLength;
 
-						outRed = vRed * vSampleFade;
-						outBlue = vBlue * vSampleFade;
-						outGreen = vGreen * vSampleFade;
+					outFade = vSampleFade - vOne;
 
-						// draw vertices.
-						for (cpl::ssize_t n = 0; n < vectorLength; ++n)
-						{
-							drawer.addColour(outRed[n], outGreen[n], outBlue[n]);
-							drawer.addVertex(outX[n], outY[n], outFade[n]);
-						}
+					// set colours
 
-						vSampleFade += vIncrementalFade;
+					outRed = vRed * vSampleFade;
+					outBlue = vBlue * vSampleFade;
+					outGreen = vGreen * vSampleFade;
 
+					// draw vertices.
+					for (cpl::ssize_t n = 0; n < vectorLength; ++n)
+					{
+						drawer.addColour(outRed[n], outGreen[n], outBlue[n]);
+						drawer.addVertex(outX[n], outY[n], outFade[n]);
 					}
-					//continue;
-					// deal with remainder, scalar route
-					ssize_t remaindingSamples = 0;
-					auto currentSampleFade = outFade[vectorLength - 1];
 
-					for (; i < sectionSamples; i++, remaindingSamples++)
-					{
-						Ty vLeft = left[i];
-						Ty vRight = right[i];
+					vSampleFade += vIncrementalFade;
 
-						// the length of the hypotenuse of the triangle, we
-						// convert the unit square to.
-						auto const length = std::max(std::abs(vLeft), std::abs(vRight));
+				}
+				//continue;
+				// deal with remainder, scalar route
+				ssize_t remaindingSamples = 0;
+				auto currentSampleFade = outFade[vectorLength - 1];
 
-						// rotate our view manually (to center on Y-axis)
-						Ty vY = vLeft * cosineRotation - vRight * sineRotation;
-						Ty vX = vLeft * sineRotation + vRight * cosineRotation;
+				for (; i < sectionSamples; i++, remaindingSamples++)
+				{
+					Ty vLeft = left[i];
+					Ty vRight = right[i];
 
-						// check for any zero elements.
+					// the length of the hypotenuse of the triangle, we
+					// convert the unit square to.
+					auto const length = std::max(std::abs(vLeft), std::abs(vRight));
 
-						// get the phase angle. use atan2 if you want to draw the full circle.
-						// x and y are swapped at this point, btw.
-						auto angle = std::atan(vX / vY);
-						// replace nan elements of angle with zero
-						angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
-						// calcuate x,y coordinates for the right triangle
-						sincos(angle, &vX, &vY);
+					// rotate our view manually (to center on Y-axis)
+					Ty vY = vLeft * cosineRotation - vRight * sineRotation;
+					Ty vX = vLeft * sineRotation + vRight * cosineRotation;
 
-						auto currentFade = (currentSampleFade - remaindingSamples * fadePerSample);
-						drawer.addColour(red * (currentFade + 1), green * (currentFade + 1), blue * (currentFade + 1));
-						drawer.addVertex(vX * length, vY * length, currentFade);
+					// check for any zero elements.
 
-					}
-					// fractionally increase sample fade levels
-					vSampleFade += set1<V>(fadePerSample * remaindingSamples);
+					// get the phase angle. use atan2 if you want to draw the full circle.
+					// x and y are swapped at this point, btw.
+					auto angle = std::atan(vX / vY);
+					// replace nan elements of angle with zero
+					angle = (vLeft == Ty(0) && vRight == Ty(0)) ? Ty(0) : angle;
+					// calcuate x,y coordinates for the right triangle
+					sincos(angle, &vX, &vY);
+
+					auto currentFade = (currentSampleFade - remaindingSamples * fadePerSample);
+					drawer.addColour(red * (currentFade + 1), green * (currentFade + 1), blue * (currentFade + 1));
+					drawer.addVertex(vX * length, vY * length, currentFade);
 
 				}
+				// fractionally increase sample fade levels
+				vSampleFade += set1<V>(fadePerSample * remaindingSamples);
 			}
+
+			geometry.draw(state.fillPath ? GL_LINE_STRIP : GL_POINTS);
 		}
 
-	template<typename ISA>
-		void VectorScope::drawStereoMeters(cpl::OpenGLRendering::COpenGLStack & openGLStack, const AudioStream::AudioBufferAccess & audio)
+	template<typename ISA, typename ColourArray>
+		void VectorScope::drawStereoMeters(cpl::OpenGLRendering::COpenGLStack & openGLStack, const ColourArray& colours)
 		{
 			if (state.colourMeter.getBrightness() == 0)
 				return;
@@ -763,41 +889,49 @@ namespace Signalizer
 			const float sideSize = 0.05f;
 			const float indicatorSize = 0.05f;
 
-			// remember, y / x
-			auto& filters = processor->filters;
-			float balanceQuick = std::atan(filters.balance[0][1] / filters.balance[0][0]) / (simd::consts<float>::pi * 0.5f);
-			if (!std::isnormal(balanceQuick))
-				balanceQuick = 0.5f;
-			float balanceSlow = std::atan(filters.balance[1][1] / filters.balance[1][0]) / (simd::consts<float>::pi * 0.5f);
-			if (!std::isnormal(balanceSlow))
-				balanceSlow = 0.5f;
-
-			const float stereoQuick = filters.phase[0] * 0.5f + 0.5f;
-			const float stereoSlow = filters.phase[1] * 0.5f + 0.5f;
-
 			// this undoes the squashing due to variable aspect ratios.
 			OpenGLRendering::RectangleDrawer2D<> rect(openGLStack);
 
-			// draw slow balance
-			rect.setColour(state.colourMeter.withMultipliedBrightness(0.75f));
-			rect.setBounds(balanceX + (balanceLength - indicatorSize) * balanceSlow, balanceX, indicatorSize, sideSize);
-			rect.fill();
+			const std::size_t pairs = std::min<std::size_t>(processor->numPairs, snapshot.numChannels / 2);
 
-			// draw quick balance
-			rect.setColour(state.colourMeter);
-			rect.setBounds(balanceX + (balanceLength - indicatorSize * 0.25f) * balanceQuick, balanceX, indicatorSize * 0.25f, sideSize);
-			rect.fill();
-
-
-			// draw slow stereo
-			rect.setColour(state.colourMeter.withMultipliedBrightness(0.75f));
-			rect.setBounds(-balanceX, stereoY + (stereoLength - indicatorSize) * stereoSlow, sideSize * heightToWidthFactor, indicatorSize);
-			rect.fill();
-
-			// draw quick stereo
-			rect.setColour(state.colourMeter);
-			rect.setBounds(-balanceX, stereoY + (stereoLength - indicatorSize * 0.25f) * stereoQuick, sideSize * heightToWidthFactor, indicatorSize * 0.25f);
-			rect.fill();
+			// every pair shares the meters, with their indicators in the pair's colour
+			for (std::size_t p = 0; p < pairs; ++p)
+			{
+				// remember, y / x
+				auto& filters = processor->filters[p];
+				float balanceQuick = std::atan(filters.balance[0][1] / filters.balance[0][0]) / (simd::consts<float>::pi * 0.5f);
+				if (!std::isnormal(balanceQuick))
+					balanceQuick = 0.5f;
+				float balanceSlow = std::atan(filters.balance[1][1] / filters.balance[1][0]) / (simd::consts<float>::pi * 0.5f);
+				if (!std::isnormal(balanceSlow))
+					balanceSlow = 0.5f;
+
+				const float stereoQuick = filters.phase[0] * 0.5f + 0.5f;
+				const float stereoSlow = filters.phase[1] * 0.5f + 0.5f;
+
+				const juce::Colour indicator = pairs > 1 ? colours[p * 2] : state.colourMeter;
+
+				// draw slow balance
+				rect.setColour(indicator.withMultipliedBrightness(0.75f));
+				rect.setBounds(balanceX + (balanceLength - indicatorSize) * balanceSlow, balanceX, indicatorSize, sideSize);
+				rect.fill();
+
+				// draw quick balance
+				rect.setColour(indicator);
+				rect.setBounds(balanceX + (balanceLength - indicatorSize * 0.25f) * balanceQuick, balanceX, indicatorSize * 0.25f, sideSize);
+				rect.fill();
+
+
+				// draw slow stereo
+				rect.setColour(indicator.withMultipliedBrightness(0.75f));
+				rect.setBounds(-balanceX, stereoY + (stereoLength - indicatorSize) * stereoSlow, sideSize * heightToWidthFactor, indicatorSize);
+				rect.fill();
+
+				// draw quick stereo
+				rect.setColour(indicator);
+				rect.setBounds(-balanceX, stereoY + (stereoLength - indicatorSize * 0.25f) * stereoQuick, sideSize * heightToWidthFactor, indicatorSize * 0.25f);
+				rect.fill();
+			}
 
 
 			// draw bounding rectangle of balance meter
@@ -823,17 +957,13 @@ namespace Signalizer
 
 
 	template<typename ISA>
-		void VectorScope::runPeakFilter(const AudioStream::AudioBufferAccess & audio)
+		void VectorScope::runPeakFilter(const AudioSnapshot & audio)
 		{
-			typedef typename ISA::V V;
-
 			double currentEnvelope = 1;
 
-			if (audio.getNumChannels() >= 2)
+			if (audio.numChannels >= 2)
 			{
-				AudioStream::AudioBufferView views[2] = { audio.getView(0), audio.getView(1) };
-
-				std::size_t numSamples = views[0].size();
+				std::size_t numSamples = audio.numSamples;
 
 				// since this runs in every frame, we need to scale the coefficient by how often this function runs
 				// (and the amount of samples)
@@ -841,45 +971,24 @@ namespace Signalizer
 
 				double coeff = std::pow(processor->envelopeCoeff.load(), power);
 
-				// there is a number of optimisations we can do here, mostly that we actually don't care about
-				// timing, we are only interested in the current largest value in the set.
-				using namespace cpl;
-				using namespace cpl::simd;
-				using cpl::simd::load;
-
-				V
-					vLMax = zero<V>(),
-					vRMax = zero<V>(),
-					vSign = consts<V>::sign_mask;
-
-				auto const loopIncrement = elements_of<V>::value;
-
-				auto * leftBuffer = views[0].begin();
-				auto * rightBuffer = views[1].begin();
+				const std::size_t pairs = std::min<std::size_t>(processor->numPairs, audio.numChannels / 2);
+				double highestEnvelope = 0;
 
-				auto stop = numSamples - (numSamples & (loopIncrement - 1));
-				if (stop <= 0)
-					stop = 0;
-
-				for (std::size_t i = 0; i < stop; i += loopIncrement)
+				for (std::size_t p = 0; p < pairs; ++p)
 				{
-					auto const vLInput = loadu<V>(leftBuffer + i);
-					vLMax = max(vand(vLInput, vSign), vLMax);
-					auto const vRInput = loadu<V>(rightBuffer + i);
-					vRMax = max(vand(vRInput, vSign), vRMax);
-				}
-
-				// TODO: remainder?
+					auto& filters = processor->filters[p];
 
-				suitable_container<V> lmax = vLMax, rmax = vRMax;
-
-				double highestLeft = *std::max_element(lmax.begin(), lmax.end());
-				double highestRight = *std::max_element(rmax.begin(), rmax.end());
-
-				processor->filters.envelope[0] = std::max(processor->filters.envelope[0] * coeff, highestLeft  * highestLeft);
-				processor->filters.envelope[1] = std::max(processor->filters.envelope[1] * coeff, highestRight * highestRight);
+					for (std::size_t c = 0; c < 2; ++c)
+					{
+						// the peaks of the history are tracked on the audio thread as it arrives
+						double highest = filters.peak[c];
+						filters.envelope[c] = std::max(filters.envelope[c] * coeff, highest * highest);
+						highestEnvelope = std::max<double>(highestEnvelope, filters.envelope[c]);
+					}
+				}
 
-				currentEnvelope = 1.0 / std::max(std::sqrt(processor->filters.envelope[0]), std::sqrt(processor->filters.envelope[1]));
+				// every pair is drawn with the same gain, so the loudest one decides it
+				currentEnvelope = 1.0 / std::sqrt(highestEnvelope);
 			}
 
 			if (std::isnormal(currentEnvelope))
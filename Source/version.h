@@ -1,7 +1,7 @@
 #define SIGNALIZER_MAJOR 0
 #define SIGNALIZER_MINOR 4
-#define SIGNALIZER_BUILD 3
+#define SIGNALIZER_BUILD 4
 #define SIGNALIZER_BUILD_INFO "  convert-osc-trigger-to-unifft\n  dev\n  embed/unity\n  feature/multi-channel\n  feature/multi-channel-double\n  feature/multi-channel-macos\n  feature/multi-channel-spectrum-upgrade\n  feature/multi-channel-wip\n* master\n  osc/peak-triggers\n  refactor/dependencies\n  release/0.3.2\n  release/0.4.0\n\n3872f55\n"
 
-#define SIGNALIZER_VERSION_STRING "0.4.3"
-#define SIGNALIZER_VST_VERSION_HEX 0x000403
\ No newline at end of file
+#define SIGNALIZER_VERSION_STRING "0.4.4"
+#define SIGNALIZER_VST_VERSION_HEX 0x000404
\ No newline at end of file